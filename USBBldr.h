@@ -37,7 +37,7 @@ typedef struct
 
 
 //! Class-specific USB descriptor types.
-enum
+enum _USB_DESC_TYPE
 {
   USB_DEVICE = 0x01,
   USB_CONFIGURATION = 0x02,
@@ -56,7 +56,7 @@ enum
   UVC_CS_ENDPOINT = 0x25,
   UVC_COMPANION = 0x30,
   USB_DESC_TYPE_LAST
-} _USB_DESC_TYPE;
+};
 typedef unsigned char USB_DESC_TYPE;
 
 //! bmRequest.Dir
@@ -95,6 +95,27 @@ typedef enum _BMREQUEST_RECIPIENT
   BMREQUEST_RECIPIENT_OTHER = 3,
 } BMREQUEST_RECIPIENT;
 
+//! Standard request codes (bRequest). See section 9.4 of the USB 3.0 specification.
+typedef enum _USB_REQUEST_CODE
+{
+  USB_REQUEST_GET_STATUS = 0x00,
+  USB_REQUEST_CLEAR_FEATURE = 0x01,
+  USB_REQUEST_SET_FEATURE = 0x03,
+  USB_REQUEST_SET_ADDRESS = 0x05,
+  USB_REQUEST_GET_DESCRIPTOR = 0x06,
+  USB_REQUEST_SET_DESCRIPTOR = 0x07,
+  USB_REQUEST_GET_CONFIGURATION = 0x08,
+  USB_REQUEST_SET_CONFIGURATION = 0x09,
+  USB_REQUEST_GET_INTERFACE = 0x0A,
+  USB_REQUEST_SET_INTERFACE = 0x0B,
+  USB_REQUEST_SYNCH_FRAME = 0x0C,
+} USB_REQUEST_CODE;
+
+// bmRequestType field extraction
+#define BMREQUEST_GET_DIR(bm)         ((BMREQUEST_DIR) (((bm) >> 7) & 0x01))
+#define BMREQUEST_GET_TYPE(bm)        ((BMREQUEST_TYPE) (((bm) >> 5) & 0x03))
+#define BMREQUEST_GET_RECIPIENT(bm)   ((BMREQUEST_RECIPIENT) (((bm) >> 0) & 0x1f))
+
 //! Standard USB descriptor types. For more information, see section 9-5 of the USB 3.0 specifications.
 enum _USB_DESCRIPTOR_TYPE
 {
@@ -0,0 +1,324 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+// The corpus of realistic device profiles shared by the benchmark
+// programs: each is the maker calls a device's firmware would make,
+// from the short forms its platform reports.
+
+#include <string.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+#define BENCH_MAX_STREAMS     2
+#define BENCH_MAX_FORMATS     4
+
+
+typedef struct {
+  int           frameBased;     // Otherwise uncompressed
+  unsigned int  frames;
+} bench_format_t;
+
+
+// A UVC camera, as the platform might report it
+typedef struct {
+  uint16_t          idProduct;
+  unsigned int      streams;
+  unsigned int      formats;    // Per stream
+  bench_format_t    format[BENCH_MAX_FORMATS];
+} bench_camera_t;
+
+
+typedef struct {
+  const char *             name;
+  usbdescbldr_status_t    (*build)(usbdescbldr_ctx_t *ctx, const void *profile);
+  const void *             profile;
+} bench_profile_t;
+
+
+#define TRY(x)    do { if((rc = (x)) != USBDESCBLDR_OK) return rc; } while(0)
+
+static const usbdescbldr_guid_t bench_yuy2 = {
+  0x32595559, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 }
+};
+
+static const usbdescbldr_guid_t bench_h264 = {
+  0x34363248, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 }
+};
+
+
+static usbdescbldr_status_t
+bench_strings(usbdescbldr_ctx_t *ctx, uint8_t *manufacturer, uint8_t *product, uint8_t *serial)
+{
+  usbdescbldr_item_t * item;
+  usbdescbldr_status_t rc;
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_languageIDs(ctx, item, 0x0409, USBDESCBLDR_LIST_END));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_string_descriptor(ctx, item, manufacturer, "Leap Motion"));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_string_descriptor(ctx, item, product, "Controller"));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_string_descriptor(ctx, item, serial, "LP00000000001"));
+
+  return USBDESCBLDR_OK;
+}
+
+
+// One VideoStreaming interface: the interface, its input header with
+// formats and frames beneath, and its bulk endpoint.
+static usbdescbldr_status_t
+bench_stream(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *config,
+        const bench_camera_t *camera, uint8_t bInterfaceNumber, uint8_t bTerminalLink)
+{
+  usbdescbldr_vs_interface_short_form_t              vs = { bInterfaceNumber, 0, 1, 0 };
+  usbdescbldr_vs_if_input_header_short_form_t        vsh = { 0, 0, 0, 0, 0, 0, 0 };
+  usbdescbldr_uvc_vs_format_uncompressed_short_form_t fu;
+  usbdescbldr_uvc_vs_format_frame_based_short_form_t fb;
+  usbdescbldr_uvc_vs_frame_uncompressed_short_form_t ru;
+  usbdescbldr_uvc_vs_frame_frame_based_short_form_t  rb;
+  usbdescbldr_endpoint_short_form_t                  ep = { 0, 2, 512, 0 };
+  usbdescbldr_item_t *                               ifc, *header, *format, *frame, *endpoint;
+  usbdescbldr_status_t                               rc;
+  unsigned int                                       f, r;
+  uint16_t                                           width, height;
+
+  TRY(usbdescbldr_item_alloc(ctx, &ifc));
+  TRY(usbdescbldr_make_vs_interface_descriptor(ctx, ifc, &vs));
+
+  vsh.bNumFormats = (uint8_t) camera->formats;
+  vsh.bEndpointAddress = (uint8_t) (0x80 | (bInterfaceNumber + 1));
+  vsh.bTerminalLink = bTerminalLink;
+  TRY(usbdescbldr_item_alloc(ctx, &header));
+  TRY(usbdescbldr_make_vs_interface_header(ctx, header, &vsh, 0, USBDESCBLDR_LIST_END));
+
+  for(f = 0; f < camera->formats; f++) {
+    TRY(usbdescbldr_item_alloc(ctx, &format));
+
+    if(camera->format[f].frameBased) {
+      memset(&fb, 0, sizeof(fb));
+      fb.bFormatIndex = (uint8_t) (f + 1);
+      fb.bNumFrameDescriptors = (uint8_t) camera->format[f].frames;
+      fb.guidFormat = bench_h264;
+      fb.bBitsPerPixel = 16;
+      fb.bDefaultFrameIndex = 1;
+      fb.bVariableSize = 1;
+      TRY(usbdescbldr_make_uvc_vs_format_frame(ctx, format, &fb));
+    } else {
+      memset(&fu, 0, sizeof(fu));
+      fu.bFormatIndex = (uint8_t) (f + 1);
+      fu.bNumFrameDescriptors = (uint8_t) camera->format[f].frames;
+      fu.guidFormat = bench_yuy2;
+      fu.bBitsPerPixel = 16;
+      fu.bDefaultFrameIndex = 1;
+      TRY(usbdescbldr_make_uvc_vs_format_uncompressed(ctx, format, &fu));
+    }
+
+    for(r = 0; r < camera->format[f].frames; r++) {
+      // A ladder of resolutions, as sensor modes tend to be
+      width = (uint16_t) (160 + 16 * r);
+      height = (uint16_t) (120 + 12 * r);
+
+      TRY(usbdescbldr_item_alloc(ctx, &frame));
+      if(camera->format[f].frameBased) {
+        memset(&rb, 0, sizeof(rb));
+        rb.bFrameIndex = (uint8_t) (r + 1);
+        rb.wWidth = width;
+        rb.wHeight = height;
+        rb.dwMinBitRate = (uint32_t) width * height * 16 * 5;
+        rb.dwMaxBitRate = (uint32_t) width * height * 16 * 30;
+        rb.dwDefaultFrameInterval = 333333;
+        rb.bFrameIntervalType = 3;
+        TRY(usbdescbldr_make_uvc_vs_frame_frame(ctx, frame, &rb,
+                                                333333, 666666, 2000000, USBDESCBLDR_LIST_END));
+      } else {
+        memset(&ru, 0, sizeof(ru));
+        ru.bFrameIndex = (uint8_t) (r + 1);
+        ru.wWidth = width;
+        ru.wHeight = height;
+        ru.dwMinBitRate = (uint32_t) width * height * 16 * 5;
+        ru.dwMaxBitRate = (uint32_t) width * height * 16 * 30;
+        ru.dwMaxVideoFrameBufferSize = (uint32_t) width * height * 2;
+        ru.dwDefaultFrameInterval = 333333;
+        ru.bFrameIntervalType = 3;
+        TRY(usbdescbldr_make_uvc_vs_frame_uncompressed(ctx, frame, &ru,
+                                                       333333, 666666, 2000000, USBDESCBLDR_LIST_END));
+      }
+      TRY(usbdescbldr_add_children(ctx, format, frame, NULL));
+    }
+
+    TRY(usbdescbldr_add_children(ctx, header, format, NULL));
+  }
+
+  ep.bEndpointAddress = vsh.bEndpointAddress;
+  TRY(usbdescbldr_item_alloc(ctx, &endpoint));
+  TRY(usbdescbldr_make_endpoint_descriptor(ctx, endpoint, &ep));
+
+  return usbdescbldr_add_children(ctx, config, ifc, header, endpoint, NULL);
+}
+
+
+// A UVC camera: one VideoControl interface (camera terminal, processing
+// unit, an output terminal per stream) and its VideoStreaming interfaces.
+static usbdescbldr_status_t
+bench_build_camera(usbdescbldr_ctx_t *ctx, const void *profile)
+{
+  const bench_camera_t *                        camera = (const bench_camera_t *) profile;
+  usbdescbldr_device_descriptor_short_form_t      d = { 0x0200, 0xef, 0x02, 0x01, 0xf182, 0, 0x0100, 0, 0, 0, 1 };
+  usbdescbldr_device_configuration_short_form_t   c = { 0, 1, 0, 0x80, 250 };
+  usbdescbldr_iad_short_form_t                    iad = { 0, 0, 0x0e, 0x03, 0, 0 };
+  usbdescbldr_vc_interface_short_form_t           vc = { 0, 0, 1, 0 };
+  usbdescbldr_camera_terminal_short_form_t        cam = { 1, 0, 0, 0, 0, 0, 0x00000a };
+  usbdescbldr_vc_processor_unit_short_form        pu = { 2, 1, 0, 0x00033f, 0, 0 };
+  usbdescbldr_streaming_out_terminal_short_form_t ot = { 0, 0, 2, 0 };
+  usbdescbldr_endpoint_short_form_t               ep = { 0x8f, 3, 16, 8 };
+  uint8_t                                         streams[BENCH_MAX_STREAMS];
+  usbdescbldr_item_t *                            item, *config, *header;
+  usbdescbldr_status_t                            rc;
+  unsigned int                                    s;
+
+  TRY(bench_strings(ctx, &d.iManufacturer, &d.iProduct, &d.iSerialNumber));
+
+  d.idProduct = camera->idProduct;
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_device_descriptor(ctx, item, &d));
+
+  c.bNumInterfaces = (uint8_t) (1 + camera->streams);
+  TRY(usbdescbldr_item_alloc(ctx, &config));
+  TRY(usbdescbldr_make_device_configuration_descriptor(ctx, config, &c));
+
+  iad.bInterfaceCount = (uint8_t) (1 + camera->streams);
+  iad.iFunction = d.iProduct;
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_interface_association_descriptor(ctx, item, &iad));
+  TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_vc_interface_descriptor(ctx, item, &vc));
+  TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+
+  for(s = 0; s < camera->streams; s++)
+    streams[s] = (uint8_t) (1 + s);
+  TRY(usbdescbldr_item_alloc(ctx, &header));
+  TRY(usbdescbldr_make_vc_interface_header_fixed(ctx, header, 48000000, streams, camera->streams));
+  TRY(usbdescbldr_add_children(ctx, config, header, NULL));
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_camera_terminal_descriptor(ctx, item, &cam));
+  TRY(usbdescbldr_add_children(ctx, header, item, NULL));
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_vc_processor_unit(ctx, item, &pu));
+  TRY(usbdescbldr_add_children(ctx, header, item, NULL));
+
+  for(s = 0; s < camera->streams; s++) {
+    ot.bTerminalID = (uint8_t) (3 + s);
+    TRY(usbdescbldr_item_alloc(ctx, &item));
+    TRY(usbdescbldr_make_streaming_out_terminal_descriptor(ctx, item, &ot));
+    TRY(usbdescbldr_add_children(ctx, header, item, NULL));
+  }
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_endpoint_descriptor(ctx, item, &ep));
+  TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_vc_interrupt_ep(ctx, item, 16));
+  TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+
+  for(s = 0; s < camera->streams; s++)
+    TRY(bench_stream(ctx, config, camera, (uint8_t) (1 + s), (uint8_t) (3 + s)));
+
+  return USBDESCBLDR_OK;
+}
+
+
+// A SuperSpeed vendor device: BOS with USB 2.0 extension, SuperSpeed and
+// container ID capabilities; a bulk pair with companions.
+static usbdescbldr_status_t
+bench_build_superspeed(usbdescbldr_ctx_t *ctx, const void *profile)
+{
+  static const uint8_t usb2Extension[4] = { 0x02, 0x00, 0x00, 0x00 };
+  static const uint8_t superSpeed[7] = { 0x00, 0x0e, 0x00, 0x01, 0x0a, 0xff, 0x07 };
+  static const uint8_t containerID[17] = {
+    0x00, 0x4c, 0x45, 0x41, 0x50, 0x4d, 0x4f, 0x54, 0x49, 0x4f, 0x4e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
+  };
+  usbdescbldr_device_descriptor_short_form_t    d = { 0x0320, 0, 0, 0, 0xf182, 0x0200, 0x0100, 0, 0, 0, 1 };
+  usbdescbldr_device_configuration_short_form_t c = { 1, 1, 0, 0x80, 112 };
+  usbdescbldr_standard_interface_short_form_t   i = { 0, 0, 2, 0xff, 0, 0, 0 };
+  usbdescbldr_endpoint_short_form_t             ep = { 0, 2, 1024, 0 };
+  usbdescbldr_ss_ep_companion_short_form_t      sc = { 15, 0, 0 };
+  usbdescbldr_item_t *                          item, *bos, *config;
+  usbdescbldr_status_t                          rc;
+  unsigned int                                  e;
+
+  (void) profile;
+
+  TRY(bench_strings(ctx, &d.iManufacturer, &d.iProduct, &d.iSerialNumber));
+
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_device_descriptor(ctx, item, &d));
+
+  TRY(usbdescbldr_item_alloc(ctx, &bos));
+  TRY(usbdescbldr_make_bos_descriptor(ctx, bos, 0));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_device_capability_descriptor(ctx, item, 0x02, usb2Extension, sizeof(usb2Extension)));
+  TRY(usbdescbldr_add_children(ctx, bos, item, NULL));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_device_capability_descriptor(ctx, item, 0x03, superSpeed, sizeof(superSpeed)));
+  TRY(usbdescbldr_add_children(ctx, bos, item, NULL));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_device_capability_descriptor(ctx, item, 0x04, containerID, sizeof(containerID)));
+  TRY(usbdescbldr_add_children(ctx, bos, item, NULL));
+
+  TRY(usbdescbldr_item_alloc(ctx, &config));
+  TRY(usbdescbldr_make_device_configuration_descriptor(ctx, config, &c));
+  TRY(usbdescbldr_item_alloc(ctx, &item));
+  TRY(usbdescbldr_make_standard_interface_descriptor(ctx, item, &i));
+  TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+
+  for(e = 0; e < 2; e++) {
+    ep.bEndpointAddress = (uint8_t) (e == 0 ? 0x81 : 0x02);
+    TRY(usbdescbldr_item_alloc(ctx, &item));
+    TRY(usbdescbldr_make_endpoint_descriptor(ctx, item, &ep));
+    TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+
+    TRY(usbdescbldr_item_alloc(ctx, &item));
+    TRY(usbdescbldr_make_ss_ep_companion_descriptor(ctx, item, &sc));
+    TRY(usbdescbldr_add_children(ctx, config, item, NULL));
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+static const bench_camera_t bench_yuy2Camera = {
+  0x0003, 1, 1, { { 0, 3 } }
+};
+
+static const bench_camera_t bench_stereoCamera = {
+  0x0004, 2, 1, { { 0, 4 } }
+};
+
+static const bench_camera_t bench_multiFormatCamera = {
+  0x0005, 1, 3, { { 0, 100 }, { 1, 100 }, { 0, 50 } }
+};
+
+
+static const bench_profile_t bench_profiles[] = {
+  { "yuy2_camera",          bench_build_camera,     &bench_yuy2Camera },
+  { "stereo_camera",        bench_build_camera,     &bench_stereoCamera },
+  { "multiformat_camera",   bench_build_camera,     &bench_multiFormatCamera },
+  { "superspeed_bos",       bench_build_superspeed, NULL },
+};
+
+#define BENCH_PROFILES   (sizeof(bench_profiles) / sizeof(bench_profiles[0]))
@@ -0,0 +1,65 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+// A stack high-water mark, for the benchmark programs which report one.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// How much stack is painted before measuring a call's use of it.
+#define BENCH_STACK_PAINT     16384
+#define BENCH_STACK_PATTERN   0xa5
+// How far below the frame address the paint starts (so, the least a
+// call can be said to use).
+#define BENCH_STACK_SLACK     128
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCH_NOINLINE __declspec(noinline)
+#define BENCH_FRAME    ((volatile uint8_t *) _AddressOfReturnAddress())
+#elif defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#define BENCH_FRAME    ((volatile uint8_t *) __builtin_frame_address(0))
+#else
+#error "The stack high-water mark needs the frame address"
+#endif
+
+
+// Paint the stack below the caller, make the call from that same depth,
+// then see how far down the paint was disturbed. This presumes a stack
+// growing downward, and counts only what the call itself used. Both
+// halves are called from the same frame, so share a frame address; the
+// paint lies a little below it, clear of their own locals, where the
+// call's frames will go.
+
+static BENCH_NOINLINE void
+bench_stack_paint(void)
+{
+  volatile uint8_t *area = BENCH_FRAME - BENCH_STACK_SLACK - BENCH_STACK_PAINT;
+  size_t            i;
+
+  for(i = 0; i < BENCH_STACK_PAINT; i++)
+    area[i] = BENCH_STACK_PATTERN;
+}
+
+
+static BENCH_NOINLINE size_t
+bench_stack_used(void)
+{
+  volatile uint8_t *area = BENCH_FRAME - BENCH_STACK_SLACK - BENCH_STACK_PAINT;
+  size_t            untouched = 0;
+
+  while(untouched < BENCH_STACK_PAINT && area[untouched] == BENCH_STACK_PATTERN)
+    untouched++;
+
+  // The slack above the paint is taken to have been used, too
+  return BENCH_STACK_SLACK + BENCH_STACK_PAINT - untouched;
+}
@@ -0,0 +1,577 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+// Microbenchmarks for the maker calls and usbdescbldr_add_children().
+//
+// For each call this reports the time per call, the bytes made per second,
+// and the stack used by one call. Results go to stdout as a table and,
+// with --json, to a file for comparing one build against another.
+//
+//   usbdescbldr_bench [--samples N] [--only NAME] [--json FILE]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+#include "benchutil.h"
+#include "benchstack.h"
+
+// Calls per timed sample; a single call is too quick to time alone.
+#define BENCH_BATCH           64
+
+// Items per call: a parent and up to eight children, for add_children().
+#define BENCH_GROUP           9
+
+// Room for every descriptor of a sample (prepared ones included).
+#define BENCH_BUFFER_SIZE     (BENCH_BATCH * BENCH_GROUP * 64)
+
+#define BENCH_DEFAULT_SAMPLES 2000
+
+
+typedef struct {
+  const char *          name;
+  // Optional: make what the call needs, outside the timed region.
+  usbdescbldr_status_t (*prepare)(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group);
+  // The call being measured.
+  usbdescbldr_status_t (*run)(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group);
+  // Calls per sample, if fewer than BENCH_BATCH may be made in one session.
+  unsigned int          calls;
+} bench_case_t;
+
+
+typedef struct {
+  double nsPerCall;
+  double bytesPerCall;
+  double bytesPerSecond;
+  size_t stackBytes;
+} bench_result_t;
+
+
+static unsigned char      _buffer[BENCH_BUFFER_SIZE];
+static usbdescbldr_item_t _items[BENCH_BATCH * BENCH_GROUP];
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// The calls
+
+static const usbdescbldr_device_descriptor_short_form_t _device = {
+  0x0200, 0xef, 0x02, 0x01, 0xf182, 0x0003, 0x0100, 1, 2, 3, 1
+};
+
+static const usbdescbldr_device_qualifier_short_form_t _qualifier = {
+  0x0200, 0xef, 0x02, 0x01, 64, 1
+};
+
+static const usbdescbldr_device_configuration_short_form_t _configuration = {
+  2, 1, 0, 0x80, 250
+};
+
+static const usbdescbldr_standard_interface_short_form_t _interface = {
+  0, 0, 1, 0xff, 0, 0, 0
+};
+
+static const usbdescbldr_vc_interface_short_form_t _vcInterface = { 0, 0, 1, 0 };
+static const usbdescbldr_vs_interface_short_form_t _vsInterface = { 1, 0, 1, 0 };
+static const usbdescbldr_endpoint_short_form_t     _endpoint = { 0x81, 2, 512, 0 };
+static const usbdescbldr_ss_ep_companion_short_form_t _companion = { 0, 0, 1024 };
+static const usbdescbldr_iad_short_form_t          _iad = { 0, 2, 0x0e, 0x03, 0, 0 };
+
+static const usbdescbldr_camera_terminal_short_form_t _camera = { 1, 0, 0, 0, 0, 0, 0x000002 };
+static const usbdescbldr_streaming_out_terminal_short_form_t _outTerminal = { 3, 0, 2, 0 };
+static const usbdescbldr_vc_processor_unit_short_form _processor = { 2, 1, 0, 0x0003, 0, 0 };
+
+static uint8_t _xuControls[2] = { 0xff, 0x03 };
+static const usbdescbldr_vc_extension_unit_short_form_t _extension = {
+  4, { 0x12345678, 0x9abc, 0xdef0, { 1, 2, 3, 4, 5, 6, 7, 8 } }, 10, 2, _xuControls, 0
+};
+
+static const usbdescbldr_vs_if_input_header_short_form_t  _inputHeader = { 1, 0x81, 0, 3, 0, 0, 0 };
+static const usbdescbldr_vs_if_output_header_short_form_t _outputHeader = { 1, 0x02, 0, 3, 0, 0, 0 };
+
+static const usbdescbldr_uvc_vs_format_uncompressed_short_form_t _formatUncompressed = {
+  1, 3, { 0x32595559, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } },
+  16, 1, 0, 0, 0, 0
+};
+
+static const usbdescbldr_uvc_vs_format_frame_based_short_form_t _formatFrame = {
+  1, 3, { 0x34363248, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } },
+  16, 1, 0, 0, 0, 0, 1
+};
+
+static const usbdescbldr_uvc_vs_frame_uncompressed_short_form_t _frameUncompressed = {
+  1, 0, 640, 480, 1000, 2000, 640 * 480 * 2, 333333, 3
+};
+
+static const usbdescbldr_uvc_vs_frame_frame_based_short_form_t _frameFrame = {
+  1, 0, 640, 480, 1000, 2000, 333333, 3, 0
+};
+
+static const uint8_t  _oneByte[1] = { 1 };
+static const uint8_t  _capability[4] = { 0x02, 0x00, 0x00, 0x00 };
+static const uint32_t _intervals[3] = { 333333, 666666, 1000000 };
+
+
+static usbdescbldr_status_t
+_languageIDs(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_languageIDs(ctx, group, 0x0409, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_device_descriptor(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_device_descriptor(ctx, group, &_device);
+}
+
+static usbdescbldr_status_t
+_device_qualifier(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_device_qualifier_descriptor(ctx, group, &_qualifier);
+}
+
+static usbdescbldr_status_t
+_string(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_string_descriptor(ctx, group, NULL, "Leap Motion Controller");
+}
+
+static usbdescbldr_status_t
+_bos(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_bos_descriptor(ctx, group, 1);
+}
+
+static usbdescbldr_status_t
+_device_capability(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_device_capability_descriptor(ctx, group, 0x02, _capability, sizeof(_capability));
+}
+
+static usbdescbldr_status_t
+_configuration_descriptor(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_device_configuration_descriptor(ctx, group, &_configuration);
+}
+
+static usbdescbldr_status_t
+_standard_interface(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_standard_interface_descriptor(ctx, group, &_interface);
+}
+
+static usbdescbldr_status_t
+_vc_interface(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_interface_descriptor(ctx, group, &_vcInterface);
+}
+
+static usbdescbldr_status_t
+_vs_interface(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vs_interface_descriptor(ctx, group, &_vsInterface);
+}
+
+static usbdescbldr_status_t
+_endpoint_descriptor(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_endpoint_descriptor(ctx, group, &_endpoint);
+}
+
+static usbdescbldr_status_t
+_ss_ep_companion(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_ss_ep_companion_descriptor(ctx, group, &_companion);
+}
+
+static usbdescbldr_status_t
+_interface_association(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_interface_association_descriptor(ctx, group, &_iad);
+}
+
+static usbdescbldr_status_t
+_vc_header(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_interface_header(ctx, group, 48000000, 1, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_vc_header_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_interface_header_fixed(ctx, group, 48000000, _oneByte, sizeof(_oneByte));
+}
+
+static usbdescbldr_status_t
+_camera_terminal(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_camera_terminal_descriptor(ctx, group, &_camera);
+}
+
+static usbdescbldr_status_t
+_streaming_out_terminal(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_streaming_out_terminal_descriptor(ctx, group, &_outTerminal);
+}
+
+static usbdescbldr_status_t
+_selector_unit(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_selector_unit(ctx, group, 0, 5, 1, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_selector_unit_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_selector_unit_fixed(ctx, group, 0, 5, _oneByte, sizeof(_oneByte));
+}
+
+static usbdescbldr_status_t
+_processor_unit(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_processor_unit(ctx, group, &_processor);
+}
+
+static usbdescbldr_status_t
+_extension_unit(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_extension_unit_descriptor(ctx, group, &_extension, 1, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_extension_unit_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_extension_unit_descriptor_fixed(ctx, group, &_extension, _oneByte, sizeof(_oneByte));
+}
+
+static usbdescbldr_status_t
+_vc_interrupt_ep(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vc_interrupt_ep(ctx, group, 16);
+}
+
+static usbdescbldr_status_t
+_vs_input_header(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vs_interface_header(ctx, group, &_inputHeader, 0, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_vs_input_header_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_vs_interface_header_fixed(ctx, group, &_inputHeader, _oneByte, sizeof(_oneByte));
+}
+
+static usbdescbldr_status_t
+_vs_output_header(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_if_output_header(ctx, group, &_outputHeader, 0, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_vs_output_header_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_if_output_header_fixed(ctx, group, &_outputHeader, _oneByte, sizeof(_oneByte));
+}
+
+static usbdescbldr_status_t
+_format_frame(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_format_frame(ctx, group, &_formatFrame);
+}
+
+static usbdescbldr_status_t
+_frame_frame(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_frame_frame(ctx, group, &_frameFrame,
+                                             333333, 666666, 1000000, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_frame_frame_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_frame_frame_fixed(ctx, group, &_frameFrame, _intervals, 3);
+}
+
+static usbdescbldr_status_t
+_format_uncompressed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_format_uncompressed(ctx, group, &_formatUncompressed);
+}
+
+static usbdescbldr_status_t
+_frame_uncompressed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_frame_uncompressed(ctx, group, &_frameUncompressed,
+                                                    333333, 666666, 1000000, USBDESCBLDR_LIST_END);
+}
+
+static usbdescbldr_status_t
+_frame_uncompressed_fixed(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_make_uvc_vs_frame_uncompressed_fixed(ctx, group, &_frameUncompressed, _intervals, 3);
+}
+
+
+// add_children(): an interface and eight endpoints are made beforehand;
+// only the linking is timed.
+static usbdescbldr_status_t
+_children_prepare(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  usbdescbldr_status_t rc;
+  unsigned int         i;
+
+  if((rc = usbdescbldr_make_standard_interface_descriptor(ctx, &group[0], &_interface)) != USBDESCBLDR_OK)
+    return rc;
+
+  for(i = 1; i < BENCH_GROUP; i++)
+    if((rc = usbdescbldr_make_endpoint_descriptor(ctx, &group[i], &_endpoint)) != USBDESCBLDR_OK)
+      return rc;
+
+  return USBDESCBLDR_OK;
+}
+
+static usbdescbldr_status_t
+_add_children(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *group)
+{
+  return usbdescbldr_add_children(ctx, &group[0], &group[1], &group[2], &group[3], &group[4],
+                                  &group[5], &group[6], &group[7], &group[8], NULL);
+}
+
+
+static const bench_case_t _cases[] = {
+  { "make_languageIDs",                       NULL, _languageIDs,               1 },   // Once per session
+  { "make_device_descriptor",                 NULL, _device_descriptor,         0 },
+  { "make_device_qualifier_descriptor",       NULL, _device_qualifier,          0 },
+  { "make_string_descriptor",                 NULL, _string,                    0 },
+  { "make_bos_descriptor",                    NULL, _bos,                       0 },
+  { "make_device_capability_descriptor",      NULL, _device_capability,         0 },
+  { "make_device_configuration_descriptor",   NULL, _configuration_descriptor,  0 },
+  { "make_standard_interface_descriptor",     NULL, _standard_interface,        0 },
+  { "make_vc_interface_descriptor",           NULL, _vc_interface,              0 },
+  { "make_vs_interface_descriptor",           NULL, _vs_interface,              0 },
+  { "make_endpoint_descriptor",               NULL, _endpoint_descriptor,       0 },
+  { "make_ss_ep_companion_descriptor",        NULL, _ss_ep_companion,           0 },
+  { "make_interface_association_descriptor",  NULL, _interface_association,     0 },
+  { "make_vc_interface_header",               NULL, _vc_header,                 0 },
+  { "make_vc_interface_header_fixed",         NULL, _vc_header_fixed,           0 },
+  { "make_camera_terminal_descriptor",        NULL, _camera_terminal,           0 },
+  { "make_streaming_out_terminal_descriptor", NULL, _streaming_out_terminal,    0 },
+  { "make_vc_selector_unit",                  NULL, _selector_unit,             0 },
+  { "make_vc_selector_unit_fixed",            NULL, _selector_unit_fixed,       0 },
+  { "make_vc_processor_unit",                 NULL, _processor_unit,            0 },
+  { "make_extension_unit_descriptor",         NULL, _extension_unit,            0 },
+  { "make_extension_unit_descriptor_fixed",   NULL, _extension_unit_fixed,      0 },
+  { "make_vc_interrupt_ep",                   NULL, _vc_interrupt_ep,           0 },
+  { "make_vs_interface_header",               NULL, _vs_input_header,           0 },
+  { "make_vs_interface_header_fixed",         NULL, _vs_input_header_fixed,     0 },
+  { "make_uvc_vs_if_output_header",           NULL, _vs_output_header,          0 },
+  { "make_uvc_vs_if_output_header_fixed",     NULL, _vs_output_header_fixed,    0 },
+  { "make_uvc_vs_format_frame",               NULL, _format_frame,              0 },
+  { "make_uvc_vs_frame_frame",                NULL, _frame_frame,               0 },
+  { "make_uvc_vs_frame_frame_fixed",          NULL, _frame_frame_fixed,         0 },
+  { "make_uvc_vs_format_uncompressed",        NULL, _format_uncompressed,       0 },
+  { "make_uvc_vs_frame_uncompressed",         NULL, _frame_uncompressed,        0 },
+  { "make_uvc_vs_frame_uncompressed_fixed",   NULL, _frame_uncompressed_fixed,  0 },
+  { "add_children",                           _children_prepare, _add_children, 0 },
+};
+
+#define BENCH_CASES   (sizeof(_cases) / sizeof(_cases[0]))
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Measurement
+
+static unsigned int
+_calls(const bench_case_t *bc)
+{
+  return bc->calls != 0 ? bc->calls : BENCH_BATCH;
+}
+
+
+// A fresh session, with whatever the batch needs already made.
+static usbdescbldr_status_t
+_setup(const bench_case_t *bc, usbdescbldr_ctx_t *ctx, size_t *prepared)
+{
+  usbdescbldr_status_t rc;
+  unsigned int         k;
+
+  if((rc = usbdescbldr_init(ctx, _buffer, sizeof(_buffer))) != USBDESCBLDR_OK)
+    return rc;
+
+  if(bc->prepare != NULL) {
+    for(k = 0; k < _calls(bc); k++)
+      if((rc = bc->prepare(ctx, &_items[k * BENCH_GROUP])) != USBDESCBLDR_OK)
+        return rc;
+  }
+
+  *prepared = ctx->length;
+  return USBDESCBLDR_OK;
+}
+
+
+static BENCH_NOINLINE usbdescbldr_status_t
+_measure_stack(const bench_case_t *bc, size_t *stackBytes)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+  size_t               prepared;
+
+  // Once unmeasured, so that lazy binding and cold caches aren't counted
+  // as the call's own stack; then again, in a fresh session.
+  if((rc = _setup(bc, &ctx, &prepared)) != USBDESCBLDR_OK ||
+     (rc = bc->run(&ctx, &_items[0])) != USBDESCBLDR_OK)
+    return rc;
+
+  if((rc = _setup(bc, &ctx, &prepared)) != USBDESCBLDR_OK)
+    return rc;
+
+  bench_stack_paint();
+  rc = bc->run(&ctx, &_items[0]);
+  *stackBytes = bench_stack_used();
+
+  return rc;
+}
+
+
+static usbdescbldr_status_t
+_measure(const bench_case_t *bc, unsigned int samples, bench_result_t *result)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+  size_t               prepared;
+  uint64_t             elapsed = 0, start;
+  double               bytes = 0;
+  unsigned int         s, k;
+
+  memset(result, 0, sizeof(*result));
+
+  if((rc = _measure_stack(bc, &result->stackBytes)) != USBDESCBLDR_OK)
+    return rc;
+
+  for(s = 0; s < samples; s++) {
+    if((rc = _setup(bc, &ctx, &prepared)) != USBDESCBLDR_OK)
+      return rc;
+
+    start = bench_now_ns();
+    for(k = 0; k < _calls(bc) && rc == USBDESCBLDR_OK; k++)
+      rc = bc->run(&ctx, &_items[k * BENCH_GROUP]);
+    elapsed += bench_now_ns() - start;
+
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+
+    bytes += (double) (ctx.length - prepared);
+  }
+
+  if(elapsed == 0)
+    elapsed = 1;
+
+  result->nsPerCall = (double) elapsed / ((double) samples * _calls(bc));
+  result->bytesPerCall = bytes / ((double) samples * _calls(bc));
+  result->bytesPerSecond = bytes * 1e9 / (double) elapsed;
+
+  return USBDESCBLDR_OK;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Reporting
+
+static void
+_json_write(FILE *fp, unsigned int samples, const bench_result_t *results, const int *ran)
+{
+  unsigned int i;
+  int          first = 1;
+
+  fprintf(fp, "{\n  \"benchmark\": \"usbdescbldr_bench\",\n");
+  fprintf(fp, "  \"samples\": %u,\n  \"batch\": %u,\n  \"results\": [", samples, BENCH_BATCH);
+
+  for(i = 0; i < BENCH_CASES; i++) {
+    if(!ran[i])
+      continue;
+    fprintf(fp, "%s\n    { \"name\": \"%s\", \"ns_per_call\": %.2f, \"bytes_per_call\": %.1f,"
+                " \"bytes_per_sec\": %.0f, \"stack_bytes\": %lu }",
+            first ? "" : ",", _cases[i].name, results[i].nsPerCall, results[i].bytesPerCall,
+            results[i].bytesPerSecond, (unsigned long) results[i].stackBytes);
+    first = 0;
+  }
+
+  fprintf(fp, "\n  ]\n}\n");
+}
+
+
+static void
+_usage(const char *argv0)
+{
+  fprintf(stderr, "usage: %s [--samples N] [--only NAME] [--json FILE]\n", argv0);
+}
+
+
+int
+main(int argc, char **argv)
+{
+  static bench_result_t results[BENCH_CASES];
+  static int            ran[BENCH_CASES];
+  unsigned int          samples = BENCH_DEFAULT_SAMPLES;
+  const char *          only = NULL;
+  const char *          jsonPath = NULL;
+  usbdescbldr_status_t  rc;
+  unsigned int          i;
+  int                   a;
+  FILE *                fp;
+
+  for(a = 1; a < argc; a++) {
+    if(strcmp(argv[a], "--samples") == 0 && a + 1 < argc) {
+      samples = (unsigned int) strtoul(argv[++a], NULL, 0);
+    } else if(strcmp(argv[a], "--only") == 0 && a + 1 < argc) {
+      only = argv[++a];
+    } else if(strcmp(argv[a], "--json") == 0 && a + 1 < argc) {
+      jsonPath = argv[++a];
+    } else {
+      _usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if(samples == 0)
+    samples = 1;
+
+  printf("%-40s %10s %8s %12s %8s\n", "call", "ns/call", "bytes", "MB/s", "stack");
+
+  for(i = 0; i < BENCH_CASES; i++) {
+    if(only != NULL && strstr(_cases[i].name, only) == NULL)
+      continue;
+
+    if((rc = _measure(&_cases[i], samples, &results[i])) != USBDESCBLDR_OK) {
+      fprintf(stderr, "%s: failed (status %d)\n", _cases[i].name, (int) rc);
+      return 1;
+    }
+    ran[i] = 1;
+
+    printf("%-40s %10.1f %8.1f %12.1f %8lu\n", _cases[i].name, results[i].nsPerCall,
+           results[i].bytesPerCall, results[i].bytesPerSecond / 1e6,
+           (unsigned long) results[i].stackBytes);
+  }
+
+  if(jsonPath != NULL) {
+    if((fp = fopen(jsonPath, "w")) == NULL) {
+      perror(jsonPath);
+      return 1;
+    }
+    _json_write(fp, samples, results, ran);
+    fclose(fp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,623 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+// Enumeration simulator: the GET_DESCRIPTOR sequences that Linux, Windows
+// and macOS hosts issue when a device is plugged in, replayed against the
+// descriptors of each benchmark profile, as answered by the EP0 engine
+// (usbdescep0.h). No hardware is involved: the "bus" is a pair of calls,
+// one per SETUP and one per IN packet taken.
+//
+// The host scripts are approximations, from bus traces, of what each
+// host asks for and in what order: device, the first 9 bytes of the
+// configuration then all of it, the strings (in each language, where
+// the host does that), and the BOS. Every reply is checked.
+//
+// For each host, profile and phase, this reports control transfers
+// (round trips), data-stage packets, bytes, and the device's CPU time.
+// Given a baseline written by an earlier run (--json), it fails when any
+// count has grown, or a phase's median time by more than the threshold.
+//
+// The link is taken to be high speed: EP0 packets are of 64 bytes.
+//
+//   usbdescbldr_enum_sim [--samples N] [--json FILE]
+//                        [--baseline FILE] [--threshold PERCENT]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "USBBldr.h"
+#include "usbdescbuilder.h"
+#include "usbdescendian.h"
+#include "usbdescep0.h"
+#include "benchutil.h"
+#include "benchprofiles.h"
+
+#define SIM_DEFAULT_SAMPLES     1000
+#define SIM_DEFAULT_THRESHOLD   10.0    // Percent
+
+#define SIM_BUFFER_SIZE         65536
+#define SIM_MAX_ITEMS           1024
+#define SIM_MAX_PACKET          64
+
+#define SIM_MAX_STEPS           16
+#define SIM_MAX_LANGS           8
+#define SIM_MAX_STRINGS         8
+
+// wLength of a step: what the last reply said the whole is (wTotalLength,
+// or for a string, bLength)
+#define SIM_LENGTH_WHOLE        0
+
+
+typedef enum {
+  SIM_PHASE_DEVICE,
+  SIM_PHASE_CONFIG,
+  SIM_PHASE_STRINGS,
+  SIM_PHASE_BOS,
+  SIM_PHASE_OTHER,          // Qualifier, OS-specific probes
+  SIM_PHASES
+} sim_phase_t;
+
+static const char *_phaseNames[SIM_PHASES] = { "device", "config", "strings", "bos", "other" };
+
+
+// Step flags
+#define SIM_STEP_STRINGS        0x01    // Every string the device names (index, type ignored)
+#define SIM_STEP_IF_BOS         0x02    // Only for a device of bcdUSB 2.01 or later
+#define SIM_STEP_IF_USB2        0x04    // Only for a device of bcdUSB 2.00 (the qualifier)
+
+
+typedef struct {
+  uint8_t   phase;
+  uint8_t   type;
+  uint8_t   index;
+  uint16_t  wLength;            // Or SIM_LENGTH_WHOLE
+  unsigned  flags;
+} sim_step_t;
+
+
+typedef struct {
+  const char * name;
+  sim_step_t   steps[SIM_MAX_STEPS];
+  unsigned int stepCount;
+  uint16_t     stringProbe;     // Read this much of each string first (0: no probe)
+  uint16_t     stringLength;    // .. else read this much
+  int          allLanguages;    // Strings in every language, or only the first
+} sim_host_t;
+
+
+// Linux (hub.c, then the usb core): 64 bytes of device descriptor before
+// the address is set, all of it after; the configuration in two reads;
+// the BOS the same way; strings at 255 in the first language.
+static const sim_host_t _linux = {
+  "linux",
+  {
+    { SIM_PHASE_DEVICE,  USB_DESCRIPTOR_TYPE_DEVICE,         0, 64,               0 },
+    { SIM_PHASE_DEVICE,  USB_DESCRIPTOR_TYPE_DEVICE,         0, 18,               0 },
+    { SIM_PHASE_BOS,     USB_DESCRIPTOR_TYPE_BOS,            0, 5,                SIM_STEP_IF_BOS },
+    { SIM_PHASE_BOS,     USB_DESCRIPTOR_TYPE_BOS,            0, SIM_LENGTH_WHOLE, SIM_STEP_IF_BOS },
+    { SIM_PHASE_CONFIG,  USB_DESCRIPTOR_TYPE_CONFIGURATION,  0, 9,                0 },
+    { SIM_PHASE_CONFIG,  USB_DESCRIPTOR_TYPE_CONFIGURATION,  0, SIM_LENGTH_WHOLE, 0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,         0, 255,              0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,         0, 0,                SIM_STEP_STRINGS },
+  },
+  8, 0, 255, 0
+};
+
+// Windows (usbhub3): as Linux for the device; then the qualifier, the
+// BOS, the MS OS string (which most devices STALL), the languages and
+// the configuration; strings at 255, in every language.
+static const sim_host_t _windows = {
+  "windows",
+  {
+    { SIM_PHASE_DEVICE,  USB_DESCRIPTOR_TYPE_DEVICE,           0,    64,               0 },
+    { SIM_PHASE_DEVICE,  USB_DESCRIPTOR_TYPE_DEVICE,           0,    18,               0 },
+    { SIM_PHASE_OTHER,   USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER, 0,    10,               SIM_STEP_IF_USB2 },
+    { SIM_PHASE_BOS,     USB_DESCRIPTOR_TYPE_BOS,              0,    5,                SIM_STEP_IF_BOS },
+    { SIM_PHASE_BOS,     USB_DESCRIPTOR_TYPE_BOS,              0,    SIM_LENGTH_WHOLE, SIM_STEP_IF_BOS },
+    { SIM_PHASE_OTHER,   USB_DESCRIPTOR_TYPE_STRING,           0xee, 18,               0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,           0,    255,              0 },
+    { SIM_PHASE_CONFIG,  USB_DESCRIPTOR_TYPE_CONFIGURATION,    0,    9,                0 },
+    { SIM_PHASE_CONFIG,  USB_DESCRIPTOR_TYPE_CONFIGURATION,    0,    SIM_LENGTH_WHOLE, 0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,           0,    0,                SIM_STEP_STRINGS },
+  },
+  10, 0, 255, 1
+};
+
+// macOS: 8 bytes of device descriptor first, then all of it; the
+// configuration in two reads; each string read for its length, then
+// read whole, in every language.
+static const sim_host_t _macos = {
+  "macos",
+  {
+    { SIM_PHASE_DEVICE,  USB_DESCRIPTOR_TYPE_DEVICE,         0, 8,                0 },
+    { SIM_PHASE_DEVICE,  USB_DESCRIPTOR_TYPE_DEVICE,         0, 18,               0 },
+    { SIM_PHASE_CONFIG,  USB_DESCRIPTOR_TYPE_CONFIGURATION,  0, 9,                0 },
+    { SIM_PHASE_CONFIG,  USB_DESCRIPTOR_TYPE_CONFIGURATION,  0, SIM_LENGTH_WHOLE, 0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,         0, 2,                0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,         0, SIM_LENGTH_WHOLE, 0 },
+    { SIM_PHASE_STRINGS, USB_DESCRIPTOR_TYPE_STRING,         0, 0,                SIM_STEP_STRINGS },
+    { SIM_PHASE_BOS,     USB_DESCRIPTOR_TYPE_BOS,            0, 5,                SIM_STEP_IF_BOS },
+    { SIM_PHASE_BOS,     USB_DESCRIPTOR_TYPE_BOS,            0, SIM_LENGTH_WHOLE, SIM_STEP_IF_BOS },
+  },
+  9, 2, 0, 1
+};
+
+static const sim_host_t *_hosts[] = { &_linux, &_windows, &_macos };
+
+#define SIM_HOSTS   (sizeof(_hosts) / sizeof(_hosts[0]))
+
+
+// Per phase, from one enumeration
+typedef struct {
+  unsigned int transfers;
+  unsigned int packets;
+  unsigned int stalls;
+  size_t       bytes;
+} sim_counts_t;
+
+
+typedef struct {
+  sim_counts_t counts[SIM_PHASES];
+  uint64_t     p50[SIM_PHASES];       // ns
+} sim_result_t;
+
+
+// The host's side of the bus
+typedef struct {
+  usbdescbldr_ep0_t ep0;
+  uint8_t           reply[SIM_BUFFER_SIZE];
+  size_t            replyLength;
+  uint16_t          wLength;
+  sim_counts_t *    counts;           // Of the phase under way
+  int               overrun;          // More came than was asked for
+  int               bad;              // A reply failed its checks
+
+  // Learned along the way
+  uint8_t           device[18];
+  uint16_t          langID[SIM_MAX_LANGS];
+  unsigned int      langs;
+  uint8_t           strings[SIM_MAX_STRINGS];
+  unsigned int      stringCount;
+} sim_bus_t;
+
+
+static unsigned char      _buffer[SIM_BUFFER_SIZE];
+static usbdescbldr_item_t _arena[SIM_MAX_ITEMS];
+static sim_bus_t          _bus;
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// The bus
+
+static usbdescbldr_status_t
+_transmit(void *user, const uint8_t *packet, size_t length)
+{
+  sim_bus_t *bus = (sim_bus_t *) user;
+
+  bus->counts->packets++;
+  if(bus->replyLength + length > bus->wLength || length > SIM_MAX_PACKET) {
+    bus->overrun = 1;
+    return USBDESCBLDR_INVALID;
+  }
+
+  memcpy(bus->reply + bus->replyLength, packet, length);
+  bus->replyLength += length;
+  return USBDESCBLDR_OK;
+}
+
+
+static usbdescbldr_status_t
+_stall(void *user)
+{
+  sim_bus_t *bus = (sim_bus_t *) user;
+
+  bus->counts->stalls++;
+  return USBDESCBLDR_OK;
+}
+
+
+// One control transfer: SETUP, every IN packet of the data stage, and
+// the status stage (which costs the device nothing here). Returns
+// USBDESCBLDR_NOT_FOUND for a STALL.
+static usbdescbldr_status_t
+_control(sim_bus_t *bus, uint8_t type, uint8_t index, uint16_t wIndex, uint16_t wLength)
+{
+  uint8_t              setup[8];
+  usbdescbldr_status_t rc;
+
+  setup[0] = 0x80;
+  setup[1] = USB_REQUEST_GET_DESCRIPTOR;
+  setup[2] = index;
+  setup[3] = type;
+  usbdescbldr_put_le16(setup + 4, wIndex);
+  usbdescbldr_put_le16(setup + 6, wLength);
+
+  bus->counts->transfers++;
+  bus->replyLength = 0;
+  bus->wLength = wLength;
+
+  rc = usbdescbldr_ep0_setup(&bus->ep0, setup);
+  while(rc == USBDESCBLDR_OK && bus->ep0.active)
+    rc = usbdescbldr_ep0_in_complete(&bus->ep0);
+
+  bus->counts->bytes += bus->replyLength;
+  return rc;
+}
+
+
+// What a host would check of a reply: its type, and that it is no longer
+// than it says. Returns the length of the whole, as the reply gives it.
+static size_t
+_check(sim_bus_t *bus, uint8_t type)
+{
+  size_t whole;
+
+  if(bus->replyLength < 2 || bus->reply[1] != type || bus->reply[0] < 2) {
+    bus->bad = 1;
+    return 0;
+  }
+
+  whole = bus->reply[0];
+  if((type == USB_DESCRIPTOR_TYPE_CONFIGURATION || type == USB_DESCRIPTOR_TYPE_BOS) &&
+     bus->replyLength >= 4)
+    whole = usbdescbldr_get_le16(bus->reply + 2);
+
+  if(bus->replyLength > whole)
+    bus->bad = 1;
+
+  return whole;
+}
+
+
+// Note the string indices a descriptor names.
+static void
+_note_string(sim_bus_t *bus, uint8_t index)
+{
+  unsigned int s;
+
+  if(index == 0)
+    return;
+  for(s = 0; s < bus->stringCount; s++)
+    if(bus->strings[s] == index)
+      return;
+  if(bus->stringCount < SIM_MAX_STRINGS)
+    bus->strings[bus->stringCount++] = index;
+}
+
+
+// Read every string the device named, as the host does.
+static void
+_strings(sim_bus_t *bus, const sim_host_t *host)
+{
+  unsigned int l, s, langs;
+  size_t       whole;
+
+  langs = host->allLanguages ? bus->langs : (bus->langs != 0);
+
+  for(l = 0; l < langs; l++) {
+    for(s = 0; s < bus->stringCount; s++) {
+      if(host->stringProbe != 0) {
+        if(_control(bus, USB_DESCRIPTOR_TYPE_STRING, bus->strings[s], bus->langID[l],
+                    host->stringProbe) != USBDESCBLDR_OK)
+          continue;
+        whole = _check(bus, USB_DESCRIPTOR_TYPE_STRING);
+        _control(bus, USB_DESCRIPTOR_TYPE_STRING, bus->strings[s], bus->langID[l], (uint16_t) whole);
+      } else {
+        _control(bus, USB_DESCRIPTOR_TYPE_STRING, bus->strings[s], bus->langID[l], host->stringLength);
+      }
+      if(bus->replyLength != 0)
+        _check(bus, USB_DESCRIPTOR_TYPE_STRING);
+    }
+  }
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Enumeration
+
+// One enumeration, by one host. Times are per phase, in ns.
+static void
+_enumerate(sim_bus_t *bus, const sim_host_t *host, sim_counts_t *counts, uint64_t *times)
+{
+  const sim_step_t *step;
+  uint16_t          bcdUSB = 0, wLength, wIndex;
+  size_t            whole = 0;
+  uint64_t          start;
+  unsigned int      i, l;
+
+  memset(counts, 0, SIM_PHASES * sizeof(*counts));
+  memset(times, 0, SIM_PHASES * sizeof(*times));
+  bus->langs = 0;
+  bus->stringCount = 0;
+
+  for(i = 0; i < host->stepCount; i++) {
+    step = &host->steps[i];
+    bus->counts = &counts[step->phase];
+
+    if(((step->flags & SIM_STEP_IF_BOS) && bcdUSB < 0x0201) ||
+       ((step->flags & SIM_STEP_IF_USB2) && bcdUSB != 0x0200))
+      continue;
+
+    start = bench_now_ns();
+
+    if(step->flags & SIM_STEP_STRINGS) {
+      _strings(bus, host);
+      times[step->phase] += bench_now_ns() - start;
+      continue;
+    }
+
+    // (Strings other than the languages are asked for in a language.)
+    wLength = step->wLength != SIM_LENGTH_WHOLE ? step->wLength : (uint16_t) whole;
+    wIndex = step->type == USB_DESCRIPTOR_TYPE_STRING && step->index != 0 && bus->langs != 0 ? bus->langID[0] : 0;
+    if(_control(bus, step->type, step->index, wIndex, wLength) != USBDESCBLDR_OK) {
+      times[step->phase] += bench_now_ns() - start;
+      continue;
+    }
+    times[step->phase] += bench_now_ns() - start;
+
+    whole = _check(bus, step->type);
+
+    // What the host learns from what it has read
+    if(step->type == USB_DESCRIPTOR_TYPE_DEVICE && bus->replyLength >= 18) {
+      memcpy(bus->device, bus->reply, 18);
+      bcdUSB = usbdescbldr_get_le16(bus->device + offsetof(USB_DEVICE_DESCRIPTOR, bcdUSB));
+      _note_string(bus, bus->device[offsetof(USB_DEVICE_DESCRIPTOR, iManufacturer)]);
+      _note_string(bus, bus->device[offsetof(USB_DEVICE_DESCRIPTOR, iProduct)]);
+      _note_string(bus, bus->device[offsetof(USB_DEVICE_DESCRIPTOR, iSerialNumber)]);
+    } else if(step->type == USB_DESCRIPTOR_TYPE_CONFIGURATION && bus->replyLength >= 9) {
+      _note_string(bus, bus->reply[6]);     // iConfiguration
+    } else if(step->type == USB_DESCRIPTOR_TYPE_STRING && step->index == 0 &&
+              bus->replyLength == whole) {
+      for(l = 0; l < (whole - 2) / 2 && l < SIM_MAX_LANGS; l++)
+        bus->langID[l] = usbdescbldr_get_le16(bus->reply + 2 + 2 * l);
+      bus->langs = l;
+    }
+  }
+}
+
+
+static usbdescbldr_status_t
+_build(const bench_profile_t *profile, usbdescbldr_ctx_t *ctx)
+{
+  usbdescbldr_status_t rc;
+
+  TRY(usbdescbldr_init(ctx, _buffer, sizeof(_buffer)));
+  TRY(usbdescbldr_set_item_arena(ctx, _arena, sizeof(_arena)));
+  TRY(profile->build(ctx, profile->profile));
+  return usbdescbldr_close(ctx);
+}
+
+
+static int
+_compare_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+
+static usbdescbldr_status_t
+_measure(const sim_host_t *host, const bench_profile_t *profile, unsigned int samples,
+         uint64_t *times, sim_result_t *result)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+  uint64_t             phaseTimes[SIM_PHASES];
+  unsigned int         s, p;
+
+  memset(result, 0, sizeof(*result));
+
+  TRY(_build(profile, &ctx));
+  TRY(usbdescbldr_ep0_init(&_bus.ep0, &ctx, SIM_MAX_PACKET, _transmit, _stall, &_bus));
+
+  for(s = 0; s < samples; s++) {
+    _bus.overrun = 0;
+    _bus.bad = 0;
+    _enumerate(&_bus, host, result->counts, phaseTimes);
+    if(_bus.overrun || _bus.bad)
+      return USBDESCBLDR_INVALID;
+
+    for(p = 0; p < SIM_PHASES; p++)
+      times[p * samples + s] = phaseTimes[p];
+  }
+
+  for(p = 0; p < SIM_PHASES; p++) {
+    qsort(times + p * samples, samples, sizeof(*times), _compare_u64);
+    result->p50[p] = times[p * samples + samples / 2];
+  }
+
+  return usbdescbldr_end(&ctx);
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Reporting and regression checks
+
+// One host, profile and phase per line, so that a baseline can be read
+// back without a JSON parser.
+static void
+_json_write(FILE *fp, unsigned int samples, const sim_result_t *results)
+{
+  const sim_counts_t *c;
+  unsigned int        h, i, p, n = 0, total = SIM_HOSTS * BENCH_PROFILES * SIM_PHASES;
+
+  fprintf(fp, "{\n  \"benchmark\": \"usbdescbldr_enum_sim\",\n");
+  fprintf(fp, "  \"samples\": %u,\n  \"phases\": [\n", samples);
+
+  for(h = 0; h < SIM_HOSTS; h++) {
+    for(i = 0; i < BENCH_PROFILES; i++) {
+      for(p = 0; p < SIM_PHASES; p++) {
+        c = &results[h * BENCH_PROFILES + i].counts[p];
+        fprintf(fp, "    { \"name\": \"%s/%s/%s\", \"transfers\": %u, \"packets\": %u,"
+                    " \"stalls\": %u, \"bytes\": %lu, \"p50_ns\": %llu }%s\n",
+                _hosts[h]->name, bench_profiles[i].name, _phaseNames[p],
+                c->transfers, c->packets, c->stalls, (unsigned long) c->bytes,
+                (unsigned long long) results[h * BENCH_PROFILES + i].p50[p],
+                ++n < total ? "," : "");
+      }
+    }
+  }
+
+  fprintf(fp, "  ]\n}\n");
+}
+
+
+// Compare against a baseline from _json_write(). Returns the number of
+// regressions found, or -1 if the baseline cannot be read.
+static int
+_check_baseline(const char *path, double threshold, const sim_result_t *results)
+{
+  char                line[512];
+  char                name[128];
+  char                here[128];
+  unsigned int        transfers, packets;
+  unsigned long       bytes;
+  unsigned long long  p50;
+  const char *        at;
+  const sim_counts_t *c;
+  double              limit = 1.0 + threshold / 100.0;
+  int                 regressions = 0;
+  unsigned int        h, i, p;
+  FILE *              fp;
+
+  if((fp = fopen(path, "r")) == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  while(fgets(line, sizeof(line), fp) != NULL) {
+    if((at = strstr(line, "\"name\": \"")) == NULL ||
+       sscanf(at, "\"name\": \"%127[^\"]\"", name) != 1)
+      continue;
+    if((at = strstr(line, "\"transfers\": ")) == NULL ||
+       sscanf(at, "\"transfers\": %u, \"packets\": %u", &transfers, &packets) != 2)
+      continue;
+    if((at = strstr(line, "\"bytes\": ")) == NULL || sscanf(at, "\"bytes\": %lu", &bytes) != 1)
+      continue;
+    if((at = strstr(line, "\"p50_ns\": ")) == NULL || sscanf(at, "\"p50_ns\": %llu", &p50) != 1)
+      continue;
+
+    for(h = 0; h < SIM_HOSTS; h++) {
+      for(i = 0; i < BENCH_PROFILES; i++) {
+        for(p = 0; p < SIM_PHASES; p++) {
+          snprintf(here, sizeof(here), "%s/%s/%s", _hosts[h]->name, bench_profiles[i].name, _phaseNames[p]);
+          if(strcmp(name, here) != 0)
+            continue;
+
+          c = &results[h * BENCH_PROFILES + i].counts[p];
+          if(c->transfers > transfers || c->packets > packets || c->bytes > bytes) {
+            fprintf(stderr, "REGRESSION %s: %u transfers, %u packets, %lu bytes; baseline %u, %u, %lu\n",
+                    name, c->transfers, c->packets, (unsigned long) c->bytes, transfers, packets, bytes);
+            regressions++;
+          }
+          if(p50 != 0 && (double) results[h * BENCH_PROFILES + i].p50[p] > (double) p50 * limit) {
+            fprintf(stderr, "REGRESSION %s: p50 %llu ns, baseline %llu ns\n", name,
+                    (unsigned long long) results[h * BENCH_PROFILES + i].p50[p], p50);
+            regressions++;
+          }
+        }
+      }
+    }
+  }
+
+  fclose(fp);
+  return regressions;
+}
+
+
+static void
+_usage(const char *argv0)
+{
+  fprintf(stderr, "usage: %s [--samples N] [--json FILE] [--baseline FILE] [--threshold PERCENT]\n", argv0);
+}
+
+
+int
+main(int argc, char **argv)
+{
+  static sim_result_t  results[SIM_HOSTS * BENCH_PROFILES];
+  unsigned int         samples = SIM_DEFAULT_SAMPLES;
+  double               threshold = SIM_DEFAULT_THRESHOLD;
+  const char *         jsonPath = NULL;
+  const char *         baselinePath = NULL;
+  sim_result_t *       r;
+  uint64_t *           times;
+  usbdescbldr_status_t rc;
+  unsigned int         h, i, p;
+  int                  a, regressions;
+  FILE *               fp;
+
+  for(a = 1; a < argc; a++) {
+    if(strcmp(argv[a], "--samples") == 0 && a + 1 < argc) {
+      samples = (unsigned int) strtoul(argv[++a], NULL, 0);
+    } else if(strcmp(argv[a], "--json") == 0 && a + 1 < argc) {
+      jsonPath = argv[++a];
+    } else if(strcmp(argv[a], "--baseline") == 0 && a + 1 < argc) {
+      baselinePath = argv[++a];
+    } else if(strcmp(argv[a], "--threshold") == 0 && a + 1 < argc) {
+      threshold = strtod(argv[++a], NULL);
+    } else {
+      _usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if(samples == 0)
+    samples = 1;
+
+  if((times = (uint64_t *) malloc(SIM_PHASES * samples * sizeof(*times))) == NULL)
+    return 1;
+
+  printf("%-8s %-20s %-8s %9s %8s %7s %8s %10s\n",
+         "host", "profile", "phase", "transfers", "packets", "stalls", "bytes", "p50 us");
+
+  for(h = 0; h < SIM_HOSTS; h++) {
+    for(i = 0; i < BENCH_PROFILES; i++) {
+      r = &results[h * BENCH_PROFILES + i];
+      if((rc = _measure(_hosts[h], &bench_profiles[i], samples, times, r)) != USBDESCBLDR_OK) {
+        fprintf(stderr, "%s/%s: failed (status %d)\n", _hosts[h]->name, bench_profiles[i].name, (int) rc);
+        free(times);
+        return 1;
+      }
+
+      for(p = 0; p < SIM_PHASES; p++) {
+        if(r->counts[p].transfers == 0)
+          continue;
+        printf("%-8s %-20s %-8s %9u %8u %7u %8lu %10.2f\n", _hosts[h]->name, bench_profiles[i].name,
+               _phaseNames[p], r->counts[p].transfers, r->counts[p].packets, r->counts[p].stalls,
+               (unsigned long) r->counts[p].bytes, r->p50[p] / 1e3);
+      }
+    }
+  }
+
+  free(times);
+
+  if(jsonPath != NULL) {
+    if((fp = fopen(jsonPath, "w")) == NULL) {
+      perror(jsonPath);
+      return 1;
+    }
+    _json_write(fp, samples, results);
+    fclose(fp);
+  }
+
+  if(baselinePath != NULL) {
+    regressions = _check_baseline(baselinePath, threshold, results);
+    if(regressions != 0)
+      return 1;
+  }
+
+  return 0;
+}
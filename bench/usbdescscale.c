@@ -0,0 +1,134 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+// Batch scaling benchmark: one batch of device variants, drawn in turn
+// from the profile corpus, run on 1, 2, 4, ... threads up to the number
+// asked for (by default, one per online processor). For each it reports
+// the best wall time of the samples, jobs per second, and the speedup and
+// efficiency against one thread. Scaling is linear when the speedup keeps
+// pace with the threads, up to the number of cores.
+//
+//   usbdescbldr_batch_bench [--jobs N] [--samples N] [--threads N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "usbdescbuilder.h"
+#include "usbdescbatch.h"
+#include "benchutil.h"
+#include "benchprofiles.h"
+
+#define SCALE_DEFAULT_JOBS      4096
+#define SCALE_DEFAULT_SAMPLES   5
+
+
+// The best of some runs of the batch on a number of threads.
+static usbdescbldr_status_t
+_measure(usbdescbldr_batch_job_t *jobs, size_t count, unsigned int threads,
+         unsigned int samples, uint64_t *best)
+{
+  usbdescbldr_status_t rc;
+  uint64_t             start, elapsed;
+  unsigned int         s;
+
+  *best = UINT64_MAX;
+
+  for(s = 0; s < samples; s++) {
+    start = bench_now_ns();
+    rc = usbdescbldr_batch_run(jobs, count, threads, &usbdescbldr_heap_allocator, 0);
+    elapsed = bench_now_ns() - start;
+
+    usbdescbldr_batch_release(jobs, count, &usbdescbldr_heap_allocator);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+
+    if(elapsed < *best)
+      *best = elapsed;
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+static void
+_usage(const char *argv0)
+{
+  fprintf(stderr, "usage: %s [--jobs N] [--samples N] [--threads N]\n", argv0);
+}
+
+
+int
+main(int argc, char **argv)
+{
+  usbdescbldr_batch_job_t *jobs;
+  size_t                   count = SCALE_DEFAULT_JOBS;
+  unsigned int             samples = SCALE_DEFAULT_SAMPLES;
+  unsigned int             most = 0;
+  unsigned int             threads;
+  uint64_t                 best, single = 0;
+  usbdescbldr_status_t     rc;
+  size_t                   j;
+  long                     online;
+  int                      a;
+
+  for(a = 1; a < argc; a++) {
+    if(strcmp(argv[a], "--jobs") == 0 && a + 1 < argc) {
+      count = (size_t) strtoul(argv[++a], NULL, 0);
+    } else if(strcmp(argv[a], "--samples") == 0 && a + 1 < argc) {
+      samples = (unsigned int) strtoul(argv[++a], NULL, 0);
+    } else if(strcmp(argv[a], "--threads") == 0 && a + 1 < argc) {
+      most = (unsigned int) strtoul(argv[++a], NULL, 0);
+    } else {
+      _usage(argv[0]);
+      return 2;
+    }
+  }
+
+  online = sysconf(_SC_NPROCESSORS_ONLN);
+  if(most == 0)
+    most = online > 0 ? (unsigned int) online : 1;
+  if(samples == 0)
+    samples = 1;
+  if(count == 0)
+    count = 1;
+
+  if((jobs = (usbdescbldr_batch_job_t *) calloc(count, sizeof(*jobs))) == NULL)
+    return 1;
+
+  for(j = 0; j < count; j++) {
+    jobs[j].build = bench_profiles[j % BENCH_PROFILES].build;
+    jobs[j].forms = bench_profiles[j % BENCH_PROFILES].profile;
+  }
+
+  printf("%lu jobs, %ld processors online\n", (unsigned long) count, online);
+  printf("%8s %12s %12s %9s %11s\n", "threads", "best ms", "jobs/s", "speedup", "efficiency");
+
+  // 1, 2, 4, ... and the most asked for
+  for(threads = 1; ; threads = threads * 2 < most ? threads * 2 : most) {
+    if((rc = _measure(jobs, count, threads, samples, &best)) != USBDESCBLDR_OK) {
+      fprintf(stderr, "%u threads: failed (status %d)\n", threads, (int) rc);
+      free(jobs);
+      return 1;
+    }
+    if(threads == 1)
+      single = best;
+
+    printf("%8u %12.2f %12.0f %9.2f %10.0f%%\n", threads, best / 1e6, count * 1e9 / best,
+           (double) single / best, 100.0 * single / best / threads);
+
+    if(threads == most)
+      break;
+  }
+
+  free(jobs);
+  return 0;
+}
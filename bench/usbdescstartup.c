@@ -0,0 +1,312 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+// Startup benchmark: the whole path from a detected platform configuration
+// (short forms) to a finished, enumeration-ready buffer, for a corpus of
+// realistic device profiles. Each build is a dry run to size the buffer,
+// then the real build into a buffer of exactly that size, and the close.
+//
+// For each profile this reports build latency percentiles and the peak
+// memory of one build (buffer, items and stack). Given a baseline written
+// by an earlier run (--json), it fails when a profile's median latency or
+// peak memory has grown by more than the threshold.
+//
+//   usbdescbldr_startup_bench [--samples N] [--json FILE]
+//                             [--baseline FILE] [--threshold PERCENT]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+#include "benchutil.h"
+#include "benchstack.h"
+#include "benchprofiles.h"
+
+#define STARTUP_DEFAULT_SAMPLES     1000
+#define STARTUP_DEFAULT_THRESHOLD   10.0    // Percent
+
+// Enough for the largest profile, and its items
+#define STARTUP_BUFFER_SIZE         65536
+#define STARTUP_MAX_ITEMS           1024
+
+
+typedef struct {
+  size_t   bytes;               // Descriptors made
+  uint64_t p50, p90, p99, max;  // ns
+  size_t   bufferBytes;
+  size_t   itemBytes;
+  size_t   stackBytes;
+} startup_result_t;
+
+
+static unsigned char      _buffer[STARTUP_BUFFER_SIZE];
+static usbdescbldr_item_t _arena[STARTUP_MAX_ITEMS];
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Measurement
+
+// One pass of a profile into the given buffer (NULL: dry run).
+static usbdescbldr_status_t
+_pass(const bench_profile_t *sc, unsigned char *buffer, size_t bufferSize,
+      usbdescbldr_ctx_t *ctx)
+{
+  usbdescbldr_status_t rc;
+
+  TRY(usbdescbldr_init(ctx, buffer, bufferSize));
+  TRY(usbdescbldr_set_item_arena(ctx, _arena, sizeof(_arena)));
+  TRY(sc->build(ctx, sc->profile));
+  return usbdescbldr_close(ctx);
+}
+
+
+// The full startup path: size it, then build it.
+static BENCH_NOINLINE usbdescbldr_status_t
+_startup(const bench_profile_t *sc, size_t *bytes, size_t *itemBytes)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+  size_t               size;
+
+  TRY(_pass(sc, NULL, 0, &ctx));
+  TRY(usbdescbldr_get_size(&ctx, &size));
+  if(size > sizeof(_buffer))
+    return USBDESCBLDR_NO_SPACE;
+
+  TRY(_pass(sc, _buffer, size, &ctx));
+  *bytes = ctx.length;
+  *itemBytes = ctx.itemArenaUsed;
+
+  return usbdescbldr_end(&ctx);
+}
+
+
+static int
+_compare_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+
+static uint64_t
+_percentile(const uint64_t *sorted, unsigned int samples, unsigned int percent)
+{
+  unsigned int i = (unsigned int) (((uint64_t) samples * percent + 99) / 100);
+
+  return sorted[i > 0 ? i - 1 : 0];
+}
+
+
+static usbdescbldr_status_t
+_measure(const bench_profile_t *sc, unsigned int samples, uint64_t *times,
+         startup_result_t *result)
+{
+  usbdescbldr_status_t rc;
+  uint64_t             start;
+  unsigned int         s;
+
+  memset(result, 0, sizeof(*result));
+
+  // Memory, from one build
+  bench_stack_paint();
+  rc = _startup(sc, &result->bytes, &result->itemBytes);
+  result->stackBytes = bench_stack_used();
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+  result->bufferBytes = result->bytes;
+
+  for(s = 0; s < samples; s++) {
+    start = bench_now_ns();
+    rc = _startup(sc, &result->bytes, &result->itemBytes);
+    times[s] = bench_now_ns() - start;
+
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+  }
+
+  qsort(times, samples, sizeof(*times), _compare_u64);
+  result->p50 = _percentile(times, samples, 50);
+  result->p90 = _percentile(times, samples, 90);
+  result->p99 = _percentile(times, samples, 99);
+  result->max = times[samples - 1];
+
+  return USBDESCBLDR_OK;
+}
+
+
+static size_t
+_peak(const startup_result_t *result)
+{
+  return result->bufferBytes + result->itemBytes + result->stackBytes;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Reporting and regression checks
+
+// One profile per line, so that a baseline can be read back without a JSON parser.
+static void
+_json_write(FILE *fp, unsigned int samples, const startup_result_t *results)
+{
+  unsigned int i;
+
+  fprintf(fp, "{\n  \"benchmark\": \"usbdescbldr_startup_bench\",\n");
+  fprintf(fp, "  \"samples\": %u,\n  \"profiles\": [\n", samples);
+
+  for(i = 0; i < BENCH_PROFILES; i++) {
+    fprintf(fp, "    { \"name\": \"%s\", \"bytes\": %lu, \"p50_ns\": %llu, \"p90_ns\": %llu,"
+                " \"p99_ns\": %llu, \"max_ns\": %llu, \"peak_bytes\": %lu, \"buffer_bytes\": %lu,"
+                " \"item_bytes\": %lu, \"stack_bytes\": %lu }%s\n",
+            bench_profiles[i].name, (unsigned long) results[i].bytes,
+            (unsigned long long) results[i].p50, (unsigned long long) results[i].p90,
+            (unsigned long long) results[i].p99, (unsigned long long) results[i].max,
+            (unsigned long) _peak(&results[i]), (unsigned long) results[i].bufferBytes,
+            (unsigned long) results[i].itemBytes, (unsigned long) results[i].stackBytes,
+            i + 1 < BENCH_PROFILES ? "," : "");
+  }
+
+  fprintf(fp, "  ]\n}\n");
+}
+
+
+// Compare against a baseline from _json_write(). Returns the number of
+// regressions found, or -1 if the baseline cannot be read.
+static int
+_check_baseline(const char *path, double threshold, const startup_result_t *results)
+{
+  char               line[512];
+  char               name[64];
+  unsigned long long p50;
+  unsigned long      peak;
+  const char *       at;
+  double             limit = 1.0 + threshold / 100.0;
+  int                regressions = 0;
+  unsigned int       i;
+  FILE *             fp;
+
+  if((fp = fopen(path, "r")) == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  while(fgets(line, sizeof(line), fp) != NULL) {
+    if((at = strstr(line, "\"name\": \"")) == NULL ||
+       sscanf(at, "\"name\": \"%63[^\"]\"", name) != 1)
+      continue;
+    if((at = strstr(line, "\"p50_ns\": ")) == NULL || sscanf(at, "\"p50_ns\": %llu", &p50) != 1)
+      continue;
+    if((at = strstr(line, "\"peak_bytes\": ")) == NULL || sscanf(at, "\"peak_bytes\": %lu", &peak) != 1)
+      continue;
+
+    for(i = 0; i < BENCH_PROFILES; i++) {
+      if(strcmp(name, bench_profiles[i].name) != 0)
+        continue;
+
+      if((double) results[i].p50 > (double) p50 * limit) {
+        fprintf(stderr, "REGRESSION %s: p50 %llu ns, baseline %llu ns (+%.1f%%)\n",
+                name, (unsigned long long) results[i].p50, p50,
+                100.0 * ((double) results[i].p50 / (double) p50 - 1.0));
+        regressions++;
+      }
+      if((double) _peak(&results[i]) > (double) peak * limit) {
+        fprintf(stderr, "REGRESSION %s: peak %lu bytes, baseline %lu bytes\n",
+                name, (unsigned long) _peak(&results[i]), peak);
+        regressions++;
+      }
+    }
+  }
+
+  fclose(fp);
+  return regressions;
+}
+
+
+static void
+_usage(const char *argv0)
+{
+  fprintf(stderr, "usage: %s [--samples N] [--json FILE] [--baseline FILE] [--threshold PERCENT]\n", argv0);
+}
+
+
+int
+main(int argc, char **argv)
+{
+  static startup_result_t results[BENCH_PROFILES];
+  unsigned int            samples = STARTUP_DEFAULT_SAMPLES;
+  double                  threshold = STARTUP_DEFAULT_THRESHOLD;
+  const char *            jsonPath = NULL;
+  const char *            baselinePath = NULL;
+  uint64_t *              times;
+  usbdescbldr_status_t    rc;
+  unsigned int            i;
+  int                     a, regressions;
+  FILE *                  fp;
+
+  for(a = 1; a < argc; a++) {
+    if(strcmp(argv[a], "--samples") == 0 && a + 1 < argc) {
+      samples = (unsigned int) strtoul(argv[++a], NULL, 0);
+    } else if(strcmp(argv[a], "--json") == 0 && a + 1 < argc) {
+      jsonPath = argv[++a];
+    } else if(strcmp(argv[a], "--baseline") == 0 && a + 1 < argc) {
+      baselinePath = argv[++a];
+    } else if(strcmp(argv[a], "--threshold") == 0 && a + 1 < argc) {
+      threshold = strtod(argv[++a], NULL);
+    } else {
+      _usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if(samples == 0)
+    samples = 1;
+
+  if((times = (uint64_t *) malloc(samples * sizeof(*times))) == NULL)
+    return 1;
+
+  printf("%-20s %7s %10s %10s %10s %10s %8s %8s %8s\n",
+         "profile", "bytes", "p50 us", "p90 us", "p99 us", "max us", "buffer", "items", "stack");
+
+  for(i = 0; i < BENCH_PROFILES; i++) {
+    if((rc = _measure(&bench_profiles[i], samples, times, &results[i])) != USBDESCBLDR_OK) {
+      fprintf(stderr, "%s: failed (status %d)\n", bench_profiles[i].name, (int) rc);
+      free(times);
+      return 1;
+    }
+
+    printf("%-20s %7lu %10.2f %10.2f %10.2f %10.2f %8lu %8lu %8lu\n", bench_profiles[i].name,
+           (unsigned long) results[i].bytes, results[i].p50 / 1e3, results[i].p90 / 1e3,
+           results[i].p99 / 1e3, results[i].max / 1e3, (unsigned long) results[i].bufferBytes,
+           (unsigned long) results[i].itemBytes, (unsigned long) results[i].stackBytes);
+  }
+
+  free(times);
+
+  if(jsonPath != NULL) {
+    if((fp = fopen(jsonPath, "w")) == NULL) {
+      perror(jsonPath);
+      return 1;
+    }
+    _json_write(fp, samples, results);
+    fclose(fp);
+  }
+
+  if(baselinePath != NULL) {
+    regressions = _check_baseline(baselinePath, threshold, results);
+    if(regressions != 0)
+      return 1;
+  }
+
+  return 0;
+}
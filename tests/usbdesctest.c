@@ -0,0 +1,588 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+// Checks of the ways of making, keeping and serving descriptors against
+// the plain way: each benchmark profile is built directly, into a flat
+// buffer, and every other path must come to the same bytes.
+//
+//   template     specializing a field, or a string slot, against a build
+//                made with the new value from the start
+//   recipe       record, then replay
+//   image        write, load and verify, then answer as a responder does
+//   stream       reads of any window, and sends of any packet size
+//   segments     the pieces, end to end
+//   minimize     every pass, then close: the totals agree with the tree
+//   cache        hits, misses and evictions, and that a hit makes nothing
+//   add_children misuse is refused, and changes nothing
+//
+// Prints each failure, and exits non-zero if there were any.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescbuilder.h"
+#include "usbdesccache.h"
+#include "usbdescendian.h"
+#include "usbdescimage.h"
+#include "usbdescminimize.h"
+#include "usbdescparse.h"
+#include "usbdescrecipe.h"
+#include "usbdescresponder.h"
+#include "usbdescstream.h"
+#include "usbdesctemplate.h"
+#include "bench/benchprofiles.h"
+
+#define TEST_BUFFER_SIZE        32768
+#define TEST_MAX_ITEMS          1024
+#define TEST_MAX_FIXUPS         256
+#define TEST_MAX_SEGMENTS       256
+#define TEST_MAX_PATCHES        4
+
+#define TEST_ID_PRODUCT         0x7777
+
+static const char * _name = "";
+static unsigned int _failures;
+
+#define CHECK(cond)                                                             \
+  do {                                                                          \
+    if(!(cond)) {                                                               \
+      printf("%s:%d: %s: %s\n", __FILE__, __LINE__, _name, #cond);              \
+      _failures++;                                                              \
+    }                                                                           \
+  } while(0)
+
+// The direct build of the profile under test
+static uint8_t            _flat[TEST_BUFFER_SIZE];
+static size_t             _flatLength;
+
+static uint8_t            _buffer[TEST_BUFFER_SIZE];
+static usbdescbldr_item_t _items[TEST_MAX_ITEMS];
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Helpers
+
+// Build a profile into a buffer of the caller's, and close the session.
+static usbdescbldr_status_t
+_build(usbdescbldr_ctx_t *ctx, const bench_profile_t *profile, uint8_t *buffer, size_t size)
+{
+  usbdescbldr_status_t rc;
+
+  if((rc = usbdescbldr_init(ctx, buffer, size)) != USBDESCBLDR_OK ||
+     (rc = usbdescbldr_set_item_arena(ctx, _items, sizeof(_items))) != USBDESCBLDR_OK ||
+     (rc = profile->build(ctx, profile->profile)) != USBDESCBLDR_OK)
+    return rc;
+
+  return usbdescbldr_close(ctx);
+}
+
+
+static int
+_same(const uint8_t *bytes, size_t length)
+{
+  return length == _flatLength && memcmp(bytes, _flat, length) == 0;
+}
+
+
+static usbdescbldr_item_t *
+_find_kind(const usbdescbldr_ctx_t *ctx, uint8_t kind)
+{
+  usbdescbldr_item_t *ip;
+
+  for(ip = ctx->made; ip != NULL; ip = ip->made) {
+    if(ip->kind == kind)
+      return ip;
+  }
+
+  return NULL;
+}
+
+
+// For the cache and streams: the profile as user data.
+static unsigned int _builds;
+
+static usbdescbldr_status_t
+_build_profile(usbdescbldr_ctx_t *ctx, void *user)
+{
+  const bench_profile_t *profile = (const bench_profile_t *) user;
+
+  _builds++;
+  return profile->build(ctx, profile->profile);
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Checks
+
+static void
+_test_template(const bench_profile_t *profile)
+{
+  usbdescbldr_ctx_t         ctx;
+  usbdescbldr_template_t    tmpl;
+  usbdescbldr_patch_t       patches[TEST_MAX_PATCHES];
+  usbdescbldr_patch_value_t value = { "idProduct", TEST_ID_PRODUCT, NULL };
+  usbdescbldr_item_t *      device;
+  bench_camera_t            camera;
+  bench_profile_t           changed = *profile;
+
+  // Only the cameras say what their idProduct is.
+  if(profile->build != bench_build_camera)
+    return;
+
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_item_arena(&ctx, _items, sizeof(_items)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_template_init(&tmpl, &ctx, patches, TEST_MAX_PATCHES) == USBDESCBLDR_OK);
+  CHECK(profile->build(&ctx, profile->profile) == USBDESCBLDR_OK);
+  device = _find_kind(&ctx, USBDESCBLDR_KIND_DEVICE);
+  CHECK(device != NULL);
+  if(device == NULL)
+    return;
+  CHECK(usbdescbldr_template_mark(&tmpl, "idProduct", device, offsetof(USB_DEVICE_DESCRIPTOR, idProduct),
+                                  sizeof(uint16_t)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_close(&ctx) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_template_specialize(&tmpl, &value, 1) == USBDESCBLDR_OK);
+
+  camera = *(const bench_camera_t *) profile->profile;
+  camera.idProduct = TEST_ID_PRODUCT;
+  changed.profile = &camera;
+  CHECK(_build(&ctx, &changed, _flat, sizeof(_flat)) == USBDESCBLDR_OK);
+  _flatLength = ctx.length;
+  CHECK(_same(_buffer, ctx.length));
+
+  CHECK(_build(&ctx, profile, _flat, sizeof(_flat)) == USBDESCBLDR_OK);
+  _flatLength = ctx.length;
+}
+
+
+// A string slot, grown: the descriptors after it move, and the totals
+// are worked out again.
+static usbdescbldr_status_t
+_slot_device(usbdescbldr_ctx_t *ctx, usbdescbldr_template_t *tmpl, const char *serial)
+{
+  usbdescbldr_device_descriptor_short_form_t    d = { 0x0200, 0, 0, 0, 0xf182, 0x0001, 0x0100, 0, 0, 0, 1 };
+  usbdescbldr_device_configuration_short_form_t c = { 1, 1, 0, 0x80, 250 };
+  usbdescbldr_standard_interface_short_form_t   i = { 0, 0, 1, 0xff, 0, 0, 0 };
+  usbdescbldr_endpoint_short_form_t             e = { 0x81, 2, 512, 0 };
+  usbdescbldr_item_t *                          it = _items;
+  usbdescbldr_status_t                          rc;
+
+  TRY(usbdescbldr_make_languageIDs(ctx, &it[0], 0x0409, USBDESCBLDR_LIST_END));
+  if(tmpl != NULL)
+    TRY(usbdescbldr_template_make_string_slot(tmpl, "serial", &it[1], &d.iSerialNumber, serial, 32));
+  else
+    TRY(usbdescbldr_make_string_descriptor(ctx, &it[1], &d.iSerialNumber, serial));
+  TRY(usbdescbldr_make_device_descriptor(ctx, &it[2], &d));
+  TRY(usbdescbldr_make_device_configuration_descriptor(ctx, &it[3], &c));
+  TRY(usbdescbldr_make_standard_interface_descriptor(ctx, &it[4], &i));
+  TRY(usbdescbldr_make_endpoint_descriptor(ctx, &it[5], &e));
+  TRY(usbdescbldr_add_children(ctx, &it[4], &it[5], NULL));
+  TRY(usbdescbldr_add_children(ctx, &it[3], &it[4], NULL));
+  return usbdescbldr_close(ctx);
+}
+
+
+static void
+_test_string_slot(void)
+{
+  usbdescbldr_ctx_t         ctx;
+  usbdescbldr_template_t    tmpl;
+  usbdescbldr_patch_t       patches[TEST_MAX_PATCHES];
+  usbdescbldr_patch_value_t value = { "serial", 0, "LP00000000001-\xc3\xa9" };
+  size_t                    length;
+
+  _name = "string slot";
+
+  CHECK(usbdescbldr_init(&ctx, _flat, sizeof(_flat)) == USBDESCBLDR_OK);
+  CHECK(_slot_device(&ctx, NULL, value.string) == USBDESCBLDR_OK);
+  _flatLength = ctx.length;
+
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_template_init(&tmpl, &ctx, patches, TEST_MAX_PATCHES) == USBDESCBLDR_OK);
+  CHECK(_slot_device(&ctx, &tmpl, "0") == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_template_specialize(&tmpl, &value, 1) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_get_size(&ctx, &length) == USBDESCBLDR_OK);
+  CHECK(_same(_buffer, length));
+}
+
+
+static void
+_test_recipe(const bench_profile_t *profile)
+{
+  static uint8_t         recipe[TEST_BUFFER_SIZE];
+  usbdescbldr_ctx_t      ctx;
+  usbdescbldr_recorder_t recorder;
+  size_t                 length, counted;
+
+  // Counted, then written: the same length.
+  CHECK(usbdescbldr_init(&ctx, NULL, 0) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_item_arena(&ctx, _items, sizeof(_items)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_record(&ctx, &recorder, NULL, 0) == USBDESCBLDR_OK);
+  CHECK(profile->build(&ctx, profile->profile) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_finish(&recorder, &counted) == USBDESCBLDR_OK);
+
+  CHECK(usbdescbldr_init(&ctx, NULL, 0) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_item_arena(&ctx, _items, sizeof(_items)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_record(&ctx, &recorder, recipe, sizeof(recipe)) == USBDESCBLDR_OK);
+  CHECK(profile->build(&ctx, profile->profile) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_finish(&recorder, &length) == USBDESCBLDR_OK);
+  CHECK(length == counted);
+  CHECK(length < _flatLength);
+
+  memset(_buffer, 0, sizeof(_buffer));
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_replay(&ctx, recipe, length, _items, TEST_MAX_ITEMS, NULL, 0) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_close(&ctx) == USBDESCBLDR_OK);
+  CHECK(_same(_buffer, ctx.length));
+
+  // Cut short anywhere, it is refused.
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_replay(&ctx, recipe, length - 1, _items, TEST_MAX_ITEMS, NULL, 0) != USBDESCBLDR_OK);
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_replay(&ctx, recipe, length / 2, _items, TEST_MAX_ITEMS, NULL, 0) != USBDESCBLDR_OK);
+}
+
+
+// The same reply, from the image's responder and from one of the flat
+// buffer's.
+static void
+_check_reply(const usbdescbldr_responder_t *image, const usbdescbldr_responder_t *flat,
+             uint8_t type, uint8_t index, uint16_t language)
+{
+  usbdescbldr_setup_t  setup = { 0x80, 6, 0, 0, 0xffff };
+  const uint8_t *      imageData, *flatData;
+  size_t               imageLength, flatLength;
+  usbdescbldr_status_t imageRc, flatRc;
+
+  setup.wValue = (uint16_t) (type << 8 | index);
+  setup.wIndex = language;
+
+  imageRc = usbdescbldr_responder_get_descriptor(image, &setup, &imageData, &imageLength);
+  flatRc = usbdescbldr_responder_get_descriptor(flat, &setup, &flatData, &flatLength);
+  CHECK(imageRc == flatRc);
+  if(imageRc == USBDESCBLDR_OK && flatRc == USBDESCBLDR_OK)
+    CHECK(imageLength == flatLength && memcmp(imageData, flatData, flatLength) == 0);
+}
+
+
+static void
+_test_image(void)
+{
+  static uint8_t          bytes[TEST_BUFFER_SIZE + 4096];
+  usbdescbldr_image_t     image;
+  usbdescbldr_responder_t imageResp, flatResp;
+  const uint8_t *         desc;
+  size_t                  written, needed, length;
+  unsigned int            s;
+
+  CHECK(usbdescbldr_image_write(_flat, _flatLength, NULL, 0, &needed) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_image_write(_flat, _flatLength, bytes, sizeof(bytes), &written) == USBDESCBLDR_OK);
+  CHECK(written == needed);
+  CHECK(usbdescbldr_image_load(&image, bytes, written) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_image_verify(&image) == USBDESCBLDR_OK);
+  CHECK(image.dataLength == _flatLength && memcmp(image.data, _flat, _flatLength) == 0);
+
+  CHECK(usbdescbldr_image_find(&image, USB_DESCRIPTOR_TYPE_DEVICE, 0, 0, &desc, &length) == USBDESCBLDR_OK);
+
+  CHECK(usbdescbldr_image_responder(&imageResp, &image) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_responder_init_buffer(&flatResp, _flat, _flatLength) == USBDESCBLDR_OK);
+  _check_reply(&imageResp, &flatResp, USB_DESCRIPTOR_TYPE_DEVICE, 0, 0);
+  _check_reply(&imageResp, &flatResp, USB_DESCRIPTOR_TYPE_CONFIGURATION, 0, 0);
+  _check_reply(&imageResp, &flatResp, USB_DESCRIPTOR_TYPE_CONFIGURATION, 1, 0);
+  _check_reply(&imageResp, &flatResp, USB_DESCRIPTOR_TYPE_BOS, 0, 0);
+  _check_reply(&imageResp, &flatResp, USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER, 0, 0);
+  for(s = 0; s < 6; s++)
+    _check_reply(&imageResp, &flatResp, USB_DESCRIPTOR_TYPE_STRING, (uint8_t) s, 0x0409);
+
+  // A flipped byte is found.
+  bytes[written - 1] ^= 0x01;
+  CHECK(usbdescbldr_image_load(&image, bytes, written) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_image_verify(&image) != USBDESCBLDR_OK);
+}
+
+
+static uint8_t _sent[TEST_BUFFER_SIZE];
+static size_t  _sentLength, _packets;
+
+static usbdescbldr_status_t
+_send(void *user, const uint8_t *packet, size_t length)
+{
+  (void) user;
+
+  if(length > sizeof(_sent) - _sentLength)
+    return USBDESCBLDR_NO_SPACE;
+  memcpy(_sent + _sentLength, packet, length);
+  _sentLength += length;
+  _packets++;
+  return USBDESCBLDR_OK;
+}
+
+
+static void
+_test_stream(const bench_profile_t *profile)
+{
+  static const size_t  packetSizes[] = { 8, 64, 512 };
+  static uint8_t       recipe[TEST_BUFFER_SIZE];
+  usbdescbldr_fixup_t  fixups[TEST_MAX_FIXUPS];
+  usbdescbldr_stream_t stream;
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_recorder_t recorder;
+  uint8_t              window[700], packet[512];
+  size_t               offset, length, made, want, p;
+
+  _builds = 0;
+  CHECK(usbdescbldr_stream_init(&stream, _build_profile, (void *) profile, _items, sizeof(_items),
+                                fixups, TEST_MAX_FIXUPS) == USBDESCBLDR_OK);
+  CHECK(stream.length == _flatLength);
+
+  // Any window, one pass each
+  for(offset = 0; offset < _flatLength + 2; offset += 1 + _flatLength / 16) {
+    for(length = 1; length < sizeof(window); length += 233) {
+      memset(window, 0xcc, sizeof(window));
+      CHECK(usbdescbldr_stream_read(&stream, offset, window, length, &made) == USBDESCBLDR_OK);
+      want = offset >= _flatLength ? 0 : _flatLength - offset < length ? _flatLength - offset : length;
+      CHECK(made == want && memcmp(window, _flat + offset, made) == 0 && window[made] == 0xcc);
+    }
+  }
+
+  // A whole transfer in one pass, a packet at a time
+  for(p = 0; p < sizeof(packetSizes) / sizeof(packetSizes[0]); p++) {
+    _builds = _sentLength = _packets = 0;
+    CHECK(usbdescbldr_stream_send(&stream, 0, _flatLength, packet, packetSizes[p], _send, NULL) == USBDESCBLDR_OK);
+    CHECK(_builds == 1);
+    CHECK(_packets == (_flatLength + packetSizes[p] - 1) / packetSizes[p]);
+    CHECK(_same(_sent, _sentLength));
+  }
+
+  // .. and of a recipe
+  CHECK(usbdescbldr_init(&ctx, NULL, 0) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_item_arena(&ctx, _items, sizeof(_items)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_record(&ctx, &recorder, recipe, sizeof(recipe)) == USBDESCBLDR_OK);
+  CHECK(profile->build(&ctx, profile->profile) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_recipe_finish(&recorder, &length) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_stream_init_recipe(&stream, recipe, length, _items, TEST_MAX_ITEMS, NULL, 0,
+                                       fixups, TEST_MAX_FIXUPS) == USBDESCBLDR_OK);
+  _sentLength = _packets = 0;
+  CHECK(usbdescbldr_stream_send(&stream, 0, _flatLength, packet, 64, _send, NULL) == USBDESCBLDR_OK);
+  CHECK(_same(_sent, _sentLength));
+}
+
+
+static void
+_test_segments(const bench_profile_t *profile)
+{
+  usbdescbldr_segment_t         segments[TEST_MAX_SEGMENTS];
+  const usbdescbldr_segment_t * list;
+  usbdescbldr_ctx_t             ctx;
+  size_t                        count, s, length = 0;
+
+  memset(_sent, 0, sizeof(_sent));
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_segments(&ctx, segments, TEST_MAX_SEGMENTS) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_item_arena(&ctx, _items, sizeof(_items)) == USBDESCBLDR_OK);
+  CHECK(profile->build(&ctx, profile->profile) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_close(&ctx) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_get_segments(&ctx, &list, &count) == USBDESCBLDR_OK);
+
+  for(s = 0; s < count && length + list[s].length <= sizeof(_sent); s++) {
+    memcpy(_sent + length, list[s].data, list[s].length);
+    length += list[s].length;
+  }
+  CHECK(s == count);
+  CHECK(_same(_sent, length));
+}
+
+
+// Each item's total is its own size and its subordinates' totals, and
+// they follow it, in order.
+static size_t
+_check_tree(const usbdescbldr_item_t *item, const uint8_t *buffer)
+{
+  const usbdescbldr_item_t *ip;
+  size_t                    total = item->size;
+
+  CHECK(buffer[item->offset] == item->size);
+  for(ip = item->first; ip != NULL; ip = ip->next) {
+    CHECK(ip->offset == item->offset + total);
+    total += _check_tree(ip, buffer);
+  }
+
+  CHECK(item->total == total);
+  return total;
+}
+
+
+static void
+_test_minimize(const bench_profile_t *profile)
+{
+  usbdescbldr_ctx_t          ctx;
+  usbdescbldr_iter_t         iter;
+  usbdescbldr_item_t *       ip;
+  const USB_CONFIGURATION_DESCRIPTOR *config;
+  size_t                     saved, walked = 0;
+
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_set_item_arena(&ctx, _items, sizeof(_items)) == USBDESCBLDR_OK);
+  CHECK(profile->build(&ctx, profile->profile) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_minimize(&ctx, USBDESCBLDR_MINIMIZE_ALL, &saved) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_close(&ctx) == USBDESCBLDR_OK);
+  CHECK(ctx.length + saved == _flatLength);
+
+  for(ip = ctx.made; ip != NULL; ip = ip->made) {
+    if(ip->parent == NULL)
+      _check_tree(ip, _buffer);
+  }
+
+  // The stored totals are the tree's
+  ip = _find_kind(&ctx, USBDESCBLDR_KIND_CONFIGURATION);
+  if(ip != NULL) {
+    config = (const USB_CONFIGURATION_DESCRIPTOR *) (_buffer + ip->offset);
+    CHECK(usbdescbldr_get_le16((const uint8_t *) &config->wTotalLength) == ip->total);
+  }
+
+  // .. and the descriptors still lie end to end.
+  CHECK(usbdescbldr_iter_init(&iter, _buffer, ctx.length) == USBDESCBLDR_OK);
+  while(usbdescbldr_iter_next(&iter) == USBDESCBLDR_OK)
+    walked += iter.length;
+  CHECK(walked == ctx.length);
+}
+
+
+// A cache of two: the third key drops the least recently used.
+static void
+_test_cache(void)
+{
+  static uint8_t                    scratch[sizeof(_items)];
+  usbdescbldr_cache_entry_t         entries[2];
+  usbdescbldr_cache_t               cache;
+  const usbdescbldr_cache_entry_t * entry;
+  usbdescbldr_ctx_t                 ctx;
+  const bench_profile_t *           profile = &bench_profiles[0];
+  size_t                            keys[3] = { 0, 1, 2 };
+
+  _name = "cache";
+
+  CHECK(_build(&ctx, profile, _flat, sizeof(_flat)) == USBDESCBLDR_OK);
+  _flatLength = ctx.length;
+
+  CHECK(usbdescbldr_cache_init(&cache, entries, 2, TEST_BUFFER_SIZE * 4, &usbdescbldr_heap_allocator,
+                               scratch, sizeof(scratch)) == USBDESCBLDR_OK);
+
+  // A miss: a dry run, and a build
+  _builds = 0;
+  CHECK(usbdescbldr_cache_build(&cache, &keys[0], sizeof(keys[0]), _build_profile, (void *) profile,
+                                &entry) == USBDESCBLDR_OK);
+  CHECK(cache.misses == 1 && cache.hits == 0 && _builds == 2);
+  CHECK(_same(entry->buffer, entry->length));
+
+  // A hit makes nothing
+  _builds = 0;
+  CHECK(usbdescbldr_cache_build(&cache, &keys[0], sizeof(keys[0]), _build_profile, (void *) profile,
+                                &entry) == USBDESCBLDR_OK);
+  CHECK(cache.misses == 1 && cache.hits == 1 && _builds == 0);
+  CHECK(_same(entry->buffer, entry->length));
+
+  CHECK(usbdescbldr_cache_build(&cache, &keys[1], sizeof(keys[1]), _build_profile, (void *) profile,
+                                &entry) == USBDESCBLDR_OK);
+  CHECK(cache.misses == 2 && cache.evictions == 0);
+
+  // Key 0 was used last before key 1: key 2 takes its place.
+  CHECK(usbdescbldr_cache_build(&cache, &keys[2], sizeof(keys[2]), _build_profile, (void *) profile,
+                                &entry) == USBDESCBLDR_OK);
+  CHECK(cache.misses == 3 && cache.evictions == 1);
+
+  _builds = 0;
+  CHECK(usbdescbldr_cache_build(&cache, &keys[1], sizeof(keys[1]), _build_profile, (void *) profile,
+                                &entry) == USBDESCBLDR_OK);
+  CHECK(cache.hits == 2 && _builds == 0);
+  CHECK(usbdescbldr_cache_build(&cache, &keys[0], sizeof(keys[0]), _build_profile, (void *) profile,
+                                &entry) == USBDESCBLDR_OK);
+  CHECK(cache.misses == 4 && cache.evictions == 2 && _builds == 2);
+  CHECK(_same(entry->buffer, entry->length));
+
+  CHECK(usbdescbldr_cache_end(&cache) == USBDESCBLDR_OK);
+}
+
+
+// Each misuse is refused before anything is linked.
+static void
+_test_add_children(void)
+{
+  usbdescbldr_ctx_t                             ctx;
+  usbdescbldr_device_configuration_short_form_t c = { 1, 1, 0, 0x80, 250 };
+  usbdescbldr_standard_interface_short_form_t   i = { 0, 0, 0, 0xff, 0, 0, 0 };
+  usbdescbldr_item_t *                          it = _items;
+  size_t                                        length;
+
+  _name = "add_children";
+
+  memset(_items, 0, 4 * sizeof(_items[0]));
+  CHECK(usbdescbldr_init(&ctx, _buffer, sizeof(_buffer)) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_make_device_configuration_descriptor(&ctx, &it[0], &c) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_make_standard_interface_descriptor(&ctx, &it[1], &i) == USBDESCBLDR_OK);
+  i.bAlternateSetting = 1;
+  CHECK(usbdescbldr_make_standard_interface_descriptor(&ctx, &it[2], &i) == USBDESCBLDR_OK);
+  i.bInterfaceNumber = 1;
+  CHECK(usbdescbldr_make_standard_interface_descriptor(&ctx, &it[3], &i) == USBDESCBLDR_OK);
+
+  CHECK(usbdescbldr_add_children(&ctx, &it[0], &it[1], NULL) == USBDESCBLDR_OK);
+
+  // Already a child
+  CHECK(usbdescbldr_add_children(&ctx, &it[0], &it[2], &it[1], NULL) == USBDESCBLDR_INVALID);
+  // Twice in the one call
+  CHECK(usbdescbldr_add_children(&ctx, &it[0], &it[2], &it[2], NULL) == USBDESCBLDR_INVALID);
+  // Its own ancestor
+  CHECK(usbdescbldr_add_children(&ctx, &it[1], &it[0], NULL) == USBDESCBLDR_INVALID);
+  // Itself
+  CHECK(usbdescbldr_add_children(&ctx, &it[2], &it[3], &it[2], NULL) == USBDESCBLDR_INVALID);
+
+  CHECK(it[0].first == &it[1] && it[0].last == &it[1] && it[1].next == NULL);
+  CHECK(it[2].parent == NULL && it[3].parent == NULL && it[2].first == NULL);
+
+  CHECK(usbdescbldr_add_children(&ctx, &it[0], &it[2], &it[3], NULL) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_close(&ctx) == USBDESCBLDR_OK);
+  CHECK(usbdescbldr_get_size(&ctx, &length) == USBDESCBLDR_OK);
+  CHECK(it[0].total == length && it[0].total == it[0].size + 3 * it[1].size);
+}
+
+
+int
+main(void)
+{
+  usbdescbldr_ctx_t ctx;
+  size_t            p;
+
+  for(p = 0; p < BENCH_PROFILES; p++) {
+    _name = bench_profiles[p].name;
+    CHECK(_build(&ctx, &bench_profiles[p], _flat, sizeof(_flat)) == USBDESCBLDR_OK);
+    _flatLength = ctx.length;
+
+    _test_template(&bench_profiles[p]);
+    _test_recipe(&bench_profiles[p]);
+    _test_image();
+    _test_stream(&bench_profiles[p]);
+    _test_segments(&bench_profiles[p]);
+    _test_minimize(&bench_profiles[p]);
+  }
+
+  _test_string_slot();
+  _test_cache();
+  _test_add_children();
+
+  if(_failures != 0) {
+    printf("%u failed\n", _failures);
+    return 1;
+  }
+
+  printf("All passed\n");
+  return 0;
+}
@@ -0,0 +1,206 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "usbdescbatch.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// The most threads a batch will start.
+#define USBDESCBLDR_BATCH_MAX_THREADS   64
+
+// Jobs are taken a few at a time, so that the shared count's cache line
+// moves between cores seldom even when jobs are small.
+#define USBDESCBLDR_BATCH_CHUNK         4
+
+
+typedef struct {
+  usbdescbldr_batch_job_t *       jobs;
+  size_t                          count;
+  const usbdescbldr_allocator_t * allocator;
+  size_t                          arenaSize;
+
+  atomic_size_t                   next;       // First job not yet taken
+} _batch_t;
+
+
+typedef struct {
+  _batch_t *  batch;
+  void *      arena;
+} _worker_t;
+
+
+static void
+_job_run(_batch_t *batch, usbdescbldr_batch_job_t *job, void *arena)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+
+  job->buffer = NULL;
+  job->length = 0;
+
+  if(job->build == NULL) {
+    job->status = USBDESCBLDR_INVALID;
+    return;
+  }
+
+  rc = usbdescbldr_init_growable(&ctx, batch->allocator, 0);
+  if(rc == USBDESCBLDR_OK)
+    rc = usbdescbldr_set_item_arena(&ctx, arena, batch->arenaSize);
+  if(rc == USBDESCBLDR_OK)
+    rc = job->build(&ctx, job->forms);
+  if(rc == USBDESCBLDR_OK)
+    rc = usbdescbldr_close(&ctx);
+  if(rc == USBDESCBLDR_OK)
+    rc = usbdescbldr_take_buffer(&ctx, &job->buffer, &job->length);
+
+  usbdescbldr_end(&ctx);
+  job->status = rc;
+}
+
+
+static void *
+_worker(void *arg)
+{
+  _worker_t *worker = (_worker_t *) arg;
+  _batch_t * batch = worker->batch;
+  size_t     first, last;
+
+  // Claimed without a lock; the jobs' results are seen by way of the join
+  for(;;) {
+    first = atomic_fetch_add_explicit(&batch->next, USBDESCBLDR_BATCH_CHUNK,
+                                      memory_order_relaxed);
+    if(first >= batch->count)
+      break;
+    last = first + USBDESCBLDR_BATCH_CHUNK;
+    if(last > batch->count)
+      last = batch->count;
+
+    for(; first < last; first++)
+      _job_run(batch, &batch->jobs[first], worker->arena);
+  }
+
+  return NULL;
+}
+
+
+static unsigned int
+_processors(void)
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return n > 0 ? (unsigned int) n : 1;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+// The caller's thread is one of the workers. Should a thread fail to
+// start, the batch goes on with those that did.
+
+usbdescbldr_status_t
+usbdescbldr_batch_run(usbdescbldr_batch_job_t *       jobs,
+                      size_t                          count,
+                      unsigned int                    threads,
+                      const usbdescbldr_allocator_t * allocator,
+                      size_t                          arenaItems)
+{
+  _batch_t             batch;
+  _worker_t            worker[USBDESCBLDR_BATCH_MAX_THREADS];
+  pthread_t            thread[USBDESCBLDR_BATCH_MAX_THREADS];
+  unsigned int         started, t;
+  usbdescbldr_status_t rc = USBDESCBLDR_OK;
+  size_t               j;
+
+  if((jobs == NULL && count != 0) || allocator == NULL ||
+     allocator->allocate == NULL || allocator->grow == NULL || allocator->release == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(threads == 0)
+    threads = _processors();
+  if(threads > USBDESCBLDR_BATCH_MAX_THREADS)
+    threads = USBDESCBLDR_BATCH_MAX_THREADS;
+  if(threads > (count + USBDESCBLDR_BATCH_CHUNK - 1) / USBDESCBLDR_BATCH_CHUNK)
+    threads = (unsigned int) ((count + USBDESCBLDR_BATCH_CHUNK - 1) / USBDESCBLDR_BATCH_CHUNK);
+  if(threads == 0)
+    return USBDESCBLDR_OK;
+
+  if(arenaItems == 0)
+    arenaItems = USBDESCBLDR_BATCH_DEFAULT_ITEMS;
+
+  memset(&batch, 0, sizeof(batch));
+  batch.jobs = jobs;
+  batch.count = count;
+  batch.allocator = allocator;
+  batch.arenaSize = arenaItems * sizeof(usbdescbldr_item_t);
+  atomic_init(&batch.next, 0);
+
+  // An arena for each thread
+  for(t = 0; t < threads; t++) {
+    worker[t].batch = &batch;
+    worker[t].arena = allocator->allocate(allocator->user, batch.arenaSize);
+    if(worker[t].arena == NULL)
+      break;
+  }
+  threads = t;
+  if(threads == 0)
+    return USBDESCBLDR_NO_SPACE;
+
+  for(started = 1; started < threads; started++) {
+    if(pthread_create(&thread[started], NULL, _worker, &worker[started]) != 0)
+      break;
+  }
+
+  _worker(&worker[0]);
+
+  for(t = 1; t < started; t++)
+    pthread_join(thread[t], NULL);
+
+  for(t = 0; t < threads; t++)
+    allocator->release(allocator->user, worker[t].arena);
+
+  for(j = 0; j < count; j++) {
+    if(jobs[j].status != USBDESCBLDR_OK) {
+      rc = jobs[j].status;
+      break;
+    }
+  }
+
+  return rc;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_batch_release(usbdescbldr_batch_job_t *       jobs,
+                          size_t                          count,
+                          const usbdescbldr_allocator_t * allocator)
+{
+  size_t j;
+
+  if((jobs == NULL && count != 0) || allocator == NULL || allocator->release == NULL)
+    return USBDESCBLDR_INVALID;
+
+  for(j = 0; j < count; j++) {
+    if(jobs[j].buffer != NULL)
+      allocator->release(allocator->user, jobs[j].buffer);
+    jobs[j].buffer = NULL;
+    jobs[j].length = 0;
+  }
+
+  return USBDESCBLDR_OK;
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Batch
+  //
+  // Builds many descriptor sets -- one per device variant -- on a number
+  // of threads. Each thread has a session and an item arena of its own,
+  // and the threads share nothing but the count of jobs taken, so the
+  // work spreads across cores with nothing to wait on. Each job's results
+  // are left in the job itself, so they come back in the order given.
+  //
+  // Unlike the rest of the library, this needs threads (POSIX) and a heap.
+
+  /// A job's maker calls. The function is given a session which is
+  /// initialized with a growable buffer and an item arena, and the job's
+  /// short forms; it makes and links the items, and does not close the session.
+  /// It runs on any thread, alongside others; it must touch nothing
+  /// of the other jobs'.
+  typedef usbdescbldr_status_t (*usbdescbldr_batch_build_t)(usbdescbldr_ctx_t *ctx, const void *forms);
+
+  /// One build: what to make, and (afterwards) what came of it.
+  typedef struct {
+    usbdescbldr_batch_build_t build;
+    const void *              forms;      ///< The job's short forms, passed to build
+
+    usbdescbldr_status_t      status;     ///< Set by the batch
+    unsigned char *           buffer;     ///< The descriptors, from the allocator; the caller releases it
+    size_t                    length;     ///< Bytes of descriptors
+  } usbdescbldr_batch_job_t;
+
+  /// Items in each thread's arena when the caller has no better idea.
+#define USBDESCBLDR_BATCH_DEFAULT_ITEMS   512
+
+  /// Run a batch of jobs to completion. Returns USBDESCBLDR_OK if every
+  /// job succeeded; otherwise the status of the first job (in order) that did not.
+  ///\param [in,out] jobs The jobs.
+  ///\param [in] count The number of jobs.
+  ///\param [in] threads The number of threads to use, counting the caller's (0: one per online processor).
+  ///\param [in] allocator The source of buffers and arenas; it must be safe to call from any thread.
+  ///\param [in] arenaItems The number of items in each thread's arena (0 for a default).
+  usbdescbldr_status_t
+    usbdescbldr_batch_run(usbdescbldr_batch_job_t *       jobs,
+                          size_t                          count,
+                          unsigned int                    threads,
+                          const usbdescbldr_allocator_t * allocator,
+                          size_t                          arenaItems);
+
+  /// Release the buffers of a batch's jobs.
+  ///\param [in,out] jobs The jobs.
+  ///\param [in] count The number of jobs.
+  ///\param [in] allocator The allocator the batch was run with.
+  usbdescbldr_status_t
+    usbdescbldr_batch_release(usbdescbldr_batch_job_t *       jobs,
+                              size_t                          count,
+                              const usbdescbldr_allocator_t * allocator);
+
+#ifdef __cplusplus
+}
+#endif
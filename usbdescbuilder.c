@@ -12,13 +12,12 @@
 
 #include "USBBldr.h"
 #include "usbdescbuilder.h"
+#include "usbdescendian.h"
+#include "usbdescutf8.h"
 
-// The varadic builder calls cannot anticipate an arbitrary number
-// of parameters without a heap. Here lies the maximum number
-// of varadics that any given call might accept; at the time of
-// this writing the largest length list is seven, found in the
-// Cypress frame format descriptor.
-#define USBDESCBLDR_PARAM_MAX                   10
+// A list from a variadic maker call goes to a recorder in pieces of
+// (at most) this many.
+#define USBDESCBLDR_LIST_CHUNK                  16
 
 
 // Ongoing: this is a library. The API must be documented (fairly well)
@@ -28,19 +27,23 @@
 // //////////////////////////////////////////////////////////////////
 // Internals
 
+// Multi-byte fields are stored with the usbdescbldr_put_le..() primitives
+// (usbdescendian.h); what memcpy() remains is for GUID bytes and arrays.
+
 // On Cypress, I saw two cases in which memcpy() to the fields of the
 // descriptor being built wound up at the wrong offsets within the structure.
 // A full day of poking around with differing forms of packing and
 // structuring did not resolve this. Overriding whatever memcpy() I am
 // resolving against on Cypress immediately resolved the issue. Until this
-// can be proved out, I'm keeping a local memcpy(). This is
-// used only for 2-4 bytes moves and GUID assignments, and so performance is
-// not a concern.
+// can be proved out, the local memcpy() is kept for such targets; build
+// with USBDESCBLDR_SAFE_MEMCPY to use it. It is used only for short moves,
+// and so performance is not a concern.
 
 // For posterity: the failing cases were in
 //   usbdescbldr_make_vc_interface_header() (now: .._fixed() )
 //   usbdescbldr_make_vc_interrupt_ep() (now: ..._fixed() )
 
+#ifdef USBDESCBLDR_SAFE_MEMCPY
 static void *
 udb_memcpy(void *dest, const void * src, size_t l)
 {
@@ -55,6 +58,7 @@ udb_memcpy(void *dest, const void * src, size_t l)
   return dest;
 }
 #define memcpy(d,s,l) udb_memcpy((d),(s),(l))
+#endif
 
 
 static size_t
@@ -66,6 +70,371 @@ _bufferAvailable(usbdescbldr_ctx_t *ctx)
 }
 
 
+// Make sure there is room for the next descriptor. Fixed buffers either
+// have it or don't; a buffer from an allocator is grown (at least doubled,
+// to keep the number of moves down) until it fits.
+static int
+_reserve(usbdescbldr_ctx_t *ctx, size_t needs)
+{
+  unsigned char *      grown;
+  size_t               size;
+  usbdescbldr_item_t * ip;
+
+  // A descriptor adds at most two pieces to a segment list
+  if(ctx->segments != NULL && ctx->segmentCapacity - ctx->segmentCount < 2)
+    return 0;
+
+  if(needs <= _bufferAvailable(ctx))
+    return 1;
+
+  if(ctx->allocator.grow == NULL)
+    return 0;
+
+  size = ctx->bufferSize;
+  while(size - ctx->length < needs) {
+    if(size > ((size_t) -1) / 2)
+      return 0;
+    size *= 2;
+  }
+
+  grown = (unsigned char *) ctx->allocator.grow(ctx->allocator.user, ctx->buffer,
+                                                ctx->bufferSize, size);
+  if(grown == NULL)
+    return 0;
+
+  ctx->buffer = grown;
+  ctx->bufferSize = size;
+  ctx->append = grown + ctx->length;
+
+  // Items with addresses follow the buffer
+  if(!(ctx->options & USBDESCBLDR_OPTION_RELOCATABLE)) {
+    for(ip = ctx->made; ip != NULL; ip = ip->made)
+      ip->address = grown + ip->offset;
+  }
+
+  return 1;
+}
+
+
+// Fingerprints are 64-bit FNV-1a.
+#define USBDESCBLDR_FNV_OFFSET    0xcbf29ce484222325ULL
+#define USBDESCBLDR_FNV_PRIME     0x00000100000001b3ULL
+
+static void
+_fingerprint(usbdescbldr_ctx_t *ctx, const void *data, size_t size)
+{
+  const uint8_t *bp = (const uint8_t *) data;
+  uint64_t       hash = ctx->fingerprint;
+
+  while(size--) {
+    hash ^= *bp++;
+    hash *= USBDESCBLDR_FNV_PRIME;
+  }
+
+  ctx->fingerprint = hash;
+}
+
+
+static void
+_fingerprint_u32(usbdescbldr_ctx_t *ctx, uint32_t value)
+{
+  uint8_t bytes[4];
+
+  usbdescbldr_put_le32(bytes, value);
+  _fingerprint(ctx, bytes, sizeof(bytes));
+}
+
+
+// Copy whatever part of the bytes at 'offset' (in the whole) lies
+// within a window session's window.
+static void
+_window_copy(usbdescbldr_ctx_t *ctx, size_t offset, const uint8_t *bytes, size_t size)
+{
+  size_t start = offset, end = offset + size;
+
+  if(start < ctx->windowOffset)
+    start = ctx->windowOffset;
+  if(end > ctx->windowOffset + ctx->windowLength)
+    end = ctx->windowOffset + ctx->windowLength;
+
+  if(start < end)
+    memcpy(ctx->window + (start - ctx->windowOffset), bytes + (start - offset), end - start);
+}
+
+
+// Hand on a flushing window session's window, once full (or at the end),
+// and move it on.
+static void
+_window_flush(usbdescbldr_ctx_t *ctx, size_t length)
+{
+  if(ctx->windowStatus == USBDESCBLDR_OK)
+    ctx->windowStatus = ctx->windowFlush(ctx->windowUser, ctx->window, ctx->windowOffset, length);
+
+  ctx->windowOffset += length;
+  if(ctx->windowLength > ctx->windowEnd - ctx->windowOffset)
+    ctx->windowLength = ctx->windowEnd - ctx->windowOffset;
+}
+
+
+// Copy bytes into a flushing window session's window. They come in order,
+// so each window is flushed as soon as its last byte is in.
+static void
+_window_pour(usbdescbldr_ctx_t *ctx, size_t offset, const uint8_t *bytes, size_t size)
+{
+  size_t end = offset + size;
+
+  while(ctx->windowLength > 0 && end > ctx->windowOffset) {
+    _window_copy(ctx, offset, bytes, size);
+    if(end < ctx->windowOffset + ctx->windowLength)
+      break;
+    _window_flush(ctx, ctx->windowLength);
+  }
+}
+
+
+// Add bytes to a segment list: onto the end of the last piece, if they
+// follow on from it.
+static void
+_segment_add(usbdescbldr_ctx_t *ctx, const uint8_t *data, size_t length)
+{
+  usbdescbldr_segment_t *last;
+
+  if(length == 0)
+    return;
+
+  if(ctx->segmentCount > 0) {
+    last = &ctx->segments[ctx->segmentCount - 1];
+    if(last->data + last->length == data) {
+      last->length += length;
+      return;
+    }
+  }
+
+  ctx->segments[ctx->segmentCount].data = data;
+  ctx->segments[ctx->segmentCount].length = length;
+  ctx->segmentCount++;
+}
+
+
+// Account for a newly made descriptor, and note in its item where it
+// went. In a dry run there is no buffer to advance through, but the byte
+// count (and so the offsets) are kept all the same. A fingerprinting
+// session hashes the descriptor, and makes the next one over it; so does
+// a window session, keeping what falls in its window.
+static void
+_advance(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *item, size_t needs)
+{
+  item->offset = (uint32_t) ctx->length;
+  if(ctx->buffer != NULL && !(ctx->options & USBDESCBLDR_OPTION_RELOCATABLE))
+    item->address = ctx->append;
+
+  ctx->length += needs;
+
+  if(ctx->options & USBDESCBLDR_OPTION_FINGERPRINT) {
+    _fingerprint_u32(ctx, item->kind);
+    _fingerprint(ctx, ctx->append, needs);
+    item->address = NULL;
+    return;
+  }
+
+  if(ctx->window != NULL) {
+    if(ctx->windowFlush != NULL)
+      _window_pour(ctx, item->offset, ctx->append, needs);
+    else
+      _window_copy(ctx, item->offset, ctx->append, needs);
+    item->address = NULL;
+    return;
+  }
+
+  if(ctx->segments != NULL)
+    _segment_add(ctx, ctx->append, needs);
+
+  if(ctx->buffer != NULL)
+    ctx->append += needs;
+}
+
+
+// Account for a newly made descriptor whose last bytes are the caller's,
+// and are referenced rather than copied (see usbdescbldr_set_segments()):
+// only the rest of it is in the buffer. Without a segment list, the
+// maker will have copied them, as usual.
+static void
+_advance_tail(usbdescbldr_ctx_t *ctx, usbdescbldr_item_t *item, size_t needs,
+              const uint8_t *tail, size_t tailSize)
+{
+  if(ctx->segments == NULL || tailSize == 0) {
+    _advance(ctx, item, needs);
+    return;
+  }
+
+  item->offset = (uint32_t) ctx->length;
+  item->address = ctx->append;
+  ctx->length += needs;
+
+  _segment_add(ctx, ctx->append, needs - tailSize);
+  _segment_add(ctx, tail, tailSize);
+  ctx->append += needs - tailSize;
+}
+
+
+// Tell a recording session's recorder of a maker call just made.
+static void
+_record(usbdescbldr_ctx_t *        ctx,
+        const usbdescbldr_item_t * item,
+        const void *               form,
+        const void *               list,
+        size_t                     listLength)
+{
+  if(ctx->record != NULL)
+    ctx->record(ctx->recorder, item->kind, item, form, list, listLength);
+}
+
+
+// The list at the end of a descriptor, taken an element at a time: from
+// an array (for the .._fixed() makers), or from the variadic arguments, up
+// to USBDESCBLDR_LIST_END. Each is stored as it is taken, so the variadic
+// makers need nowhere to collect their arguments first, and take as many
+// as fit in the descriptor.
+typedef struct {
+  const void * array;   // The elements, from an array
+  va_list *    va;      // .. or from the arguments
+  va_list *    again;   // .. and a copy of them, for a recorder
+  size_t       width;   // Bytes of each, in the descriptor (1, 2 or 4)
+  size_t       length;  // How many (for arguments, known once all are taken)
+  size_t       taken;
+} _list_t;
+
+
+static void
+_list_array(_list_t *list, const void *array, size_t length, size_t width)
+{
+  memset(list, 0, sizeof(*list));
+  list->array = array;
+  list->width = width;
+  list->length = length;
+}
+
+
+static void
+_list_args(_list_t *list, va_list *va, va_list *again, size_t width)
+{
+  memset(list, 0, sizeof(*list));
+  list->va = va;
+  list->again = again;
+  list->width = width;
+  list->length = (size_t) -1;
+}
+
+
+// Take the next element, if there is one. Arguments are passed (promoted)
+// as 32-bit values, whatever their width in the descriptor.
+static int
+_list_next(_list_t *list, uint32_t *value)
+{
+  if(list->taken >= list->length)
+    return 0;
+
+  if(list->va != NULL) {
+    *value = va_arg(*list->va, uint32_t);
+    if(*value == USBDESCBLDR_LIST_END) {
+      list->length = list->taken;
+      return 0;
+    }
+  } else if(list->width == sizeof(uint8_t)) {
+    *value = ((const uint8_t *) list->array)[list->taken];
+  } else if(list->width == sizeof(uint16_t)) {
+    *value = ((const uint16_t *) list->array)[list->taken];
+  } else {
+    *value = ((const uint32_t *) list->array)[list->taken];
+  }
+
+  list->taken++;
+  return 1;
+}
+
+
+// Store a list in the descriptor being made, from 'at' on, and work out
+// the descriptor's size: the list, and 'after' bytes of fields after it.
+// Once this succeeds the whole descriptor has room; in a dry run, the
+// elements are only counted.
+static usbdescbldr_status_t
+_list_put(usbdescbldr_ctx_t *ctx, _list_t *list, size_t at, size_t after, size_t *needs)
+{
+  uint32_t value;
+
+  while(_list_next(list, &value)) {
+    if(at + list->width + after > 0xff)
+      return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+
+    if(ctx->buffer != NULL) {
+      if(!_reserve(ctx, at + list->width))
+        return USBDESCBLDR_NO_SPACE;
+
+      if(list->width == sizeof(uint8_t))
+        ctx->append[at] = (uint8_t) value;
+      else if(list->width == sizeof(uint16_t))
+        usbdescbldr_put_le16(ctx->append + at, (uint16_t) value);
+      else
+        usbdescbldr_put_le32(ctx->append + at, value);
+    }
+    at += list->width;
+  }
+
+  *needs = at + after;
+  if(*needs > 0xff)
+    return USBDESCBLDR_OVERSIZED;
+
+  if(ctx->buffer != NULL && !_reserve(ctx, *needs))
+    return USBDESCBLDR_NO_SPACE;
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Tell a recorder of a maker call with a list. A list from the arguments
+// is walked once more, from the copy, and handed over in pieces: the
+// first with the call, the rest as USBDESCBLDR_RECORD_MORE. Only a
+// session being recorded walks them twice.
+static void
+_record_list(usbdescbldr_ctx_t *        ctx,
+             const usbdescbldr_item_t * item,
+             const void *               form,
+             _list_t *                  list)
+{
+  union {
+    uint8_t  u8[USBDESCBLDR_LIST_CHUNK];
+    uint16_t u16[USBDESCBLDR_LIST_CHUNK];
+    uint32_t u32[USBDESCBLDR_LIST_CHUNK];
+  } chunk;
+  uint8_t  op = item->kind;
+  uint32_t value;
+  size_t   n, taken = 0;
+
+  if(ctx->record == NULL)
+    return;
+
+  if(list->va == NULL) {
+    ctx->record(ctx->recorder, op, item, form, list->array, list->length);
+    return;
+  }
+
+  do {
+    for(n = 0; n < USBDESCBLDR_LIST_CHUNK && taken < list->length; n++, taken++) {
+      value = va_arg(*list->again, uint32_t);
+      if(list->width == sizeof(uint8_t))
+        chunk.u8[n] = (uint8_t) value;
+      else if(list->width == sizeof(uint16_t))
+        chunk.u16[n] = (uint16_t) value;
+      else
+        chunk.u32[n] = value;
+    }
+
+    ctx->record(ctx->recorder, op, item, form, &chunk, n);
+    op = USBDESCBLDR_RECORD_MORE;
+  } while(taken < list->length);
+}
+
+
 // In case we have no ntohs() et alia:
 
 static uint16_t
@@ -110,74 +479,245 @@ _endianIntSwap(unsigned int s)
 // //////////////////////////////////////////////////////////////////
 // Item actions
 
+// Where, within each kind of descriptor, the layering fields live.
+// Containers carry a wTotalLength for themselves and their subordinates,
+// and some also carry a count of a particular kind of subordinate.
+// Offsets of zero mean 'no such field'.
+typedef struct {
+  uint8_t totalOffset;      // wTotalLength
+  uint8_t countOffset;      // bNumInterfaces, bNumFormats, ...
+} _layout_t;
+
+static const _layout_t _layouts[USBDESCBLDR_KIND_COUNT] = {
+  [USBDESCBLDR_KIND_CONFIGURATION]          = { 2, 4 },   // wTotalLength, bNumInterfaces
+  [USBDESCBLDR_KIND_BOS]                    = { 2, 4 },   // wTotalLength, bNumDeviceCaps
+  [USBDESCBLDR_KIND_VC_HEADER]              = { 5, 0 },   // wTotalLength
+  [USBDESCBLDR_KIND_VS_INPUT_HEADER]        = { 4, 3 },   // wTotalLength, bNumFormats
+  [USBDESCBLDR_KIND_VS_OUTPUT_HEADER]       = { 4, 3 },   // wTotalLength, bNumFormats
+  [USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED]  = { 0, 4 },   // bNumFrameDescriptors
+  [USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED] = { 0, 4 },   // bNumFrameDescriptors
+};
+
+
+// Running counts for the subordinates of one counting container.
+typedef struct {
+  uint8_t      kind;            // The container doing the counting
+  uint8_t      interfaces[32];  // Interface numbers seen (alternate settings count once)
+  unsigned int count;
+} _tally_t;
+
+
 static void 
-_item_init(usbdescbldr_item_t * item)
+_item_init(usbdescbldr_ctx_t * ctx, usbdescbldr_item_t * item, usbdescbldr_kind_t kind)
 {
   memset(item, 0, sizeof(*item));
+  item->kind = kind;
+
+  // Remember every item made, for the layering pass at close (which a
+  // flushing window session doesn't make; its one item is made over).
+  if(ctx->windowFlush != NULL)
+    return;
+  item->made = ctx->made;
+  ctx->made = item;
+}
+
+
+// Does the given container count the given subordinate?
+static int
+_tally_counts(const _tally_t * tally, const usbdescbldr_item_t * item)
+{
+  switch(tally->kind) {
+  case USBDESCBLDR_KIND_CONFIGURATION:
+    return item->kind == USBDESCBLDR_KIND_INTERFACE;
+  case USBDESCBLDR_KIND_BOS:
+    return item->kind == USBDESCBLDR_KIND_DEVICE_CAPABILITY;
+  case USBDESCBLDR_KIND_VS_INPUT_HEADER:
+  case USBDESCBLDR_KIND_VS_OUTPUT_HEADER:
+    return (item->kind == USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED ||
+            item->kind == USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED);
+  case USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED:
+  case USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED:
+    return (item->kind == USBDESCBLDR_KIND_VS_FRAME_FRAME_BASED ||
+            item->kind == USBDESCBLDR_KIND_VS_FRAME_UNCOMPRESSED);
+  default:
+    return 0;
+  }
+}
+
+
+// Store a field of an item worked out at close: in the buffer, or for a
+// window session, in the window. With a segment list, offsets in the
+// buffer are not those in the whole, but the item knows where it went.
+static void
+_store(usbdescbldr_ctx_t *ctx, const usbdescbldr_item_t *item, size_t field,
+       const uint8_t *bytes, size_t size)
+{
+  if(ctx->window != NULL)
+    _window_copy(ctx, item->offset + field, bytes, size);
+  else if(ctx->segments != NULL)
+    memcpy((uint8_t *) item->address + field, bytes, size);
+  else
+    memcpy(ctx->buffer + item->offset + field, bytes, size);
+}
+
+
+// Note a field worked out at close in the session's list of them, if it
+// keeps one. Zero if the list is full.
+static int
+_fixup(usbdescbldr_ctx_t *ctx, const usbdescbldr_item_t *item, size_t field,
+       uint16_t value, size_t size)
+{
+  usbdescbldr_fixup_t *fp;
+
+  if(ctx->fixups == NULL)
+    return 1;
+  if(ctx->fixupCount >= ctx->fixupCapacity)
+    return 0;
+
+  fp = &ctx->fixups[ctx->fixupCount++];
+  fp->offset = (uint32_t) (item->offset + field);
+  fp->value = value;
+  fp->size = (uint8_t) size;
+  return 1;
+}
+
+
+// Layer one item: total up its subordinates (after they have been layered
+// themselves), and record the results in the item and in its descriptor.
+// The item is then counted by the nearest enclosing container, if that
+// container counts such things.
+
+static usbdescbldr_status_t
+_item_finalize(usbdescbldr_ctx_t *  ctx,
+               usbdescbldr_item_t * item,
+               _tally_t *           enclosing)
+{
+  const _layout_t *    layout = &_layouts[item->kind];
+  _tally_t             tally;
+  _tally_t *           tp = enclosing;
+  usbdescbldr_item_t * child;
+  uint32_t             total;
+  uint8_t              field[2];
+  usbdescbldr_status_t rc;
+
+  // A counting container starts a fresh tally for its subordinates.
+  if(layout->countOffset != 0) {
+    memset(&tally, 0, sizeof(tally));
+    tally.kind = item->kind;
+    tp = &tally;
+  }
+
+  total = item->size;
+  for(child = item->first; child != NULL; child = child->next) {
+    rc = _item_finalize(ctx, child, tp);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+    total += child->total;
+  }
+
+  if(total > 0xffff)
+    return USBDESCBLDR_OVERSIZED;
+  item->total = (uint16_t) total;
+
+  if(layout->totalOffset != 0) {
+    usbdescbldr_put_le16(field, item->total);
+    if(!_fixup(ctx, item, layout->totalOffset, item->total, sizeof(uint16_t)))
+      return USBDESCBLDR_NO_SPACE;
+    if(ctx->buffer != NULL && !(ctx->options & USBDESCBLDR_OPTION_FINGERPRINT))
+      _store(ctx, item, layout->totalOffset, field, sizeof(uint16_t));
+  }
+
+  // Only replace the caller's count if subordinates were given to count.
+  if(tp == &tally && tally.count != 0) {
+    field[0] = (uint8_t) tally.count;
+    if(!_fixup(ctx, item, layout->countOffset, tally.count, sizeof(uint8_t)))
+      return USBDESCBLDR_NO_SPACE;
+    if(ctx->buffer != NULL && !(ctx->options & USBDESCBLDR_OPTION_FINGERPRINT))
+      _store(ctx, item, layout->countOffset, field, sizeof(uint8_t));
+  }
+
+  if(enclosing != NULL && _tally_counts(enclosing, item)) {
+    if(item->kind == USBDESCBLDR_KIND_INTERFACE) {
+      if(enclosing->interfaces[(item->index >> 3) & 0x1f] & (1 << (item->index & 7)))
+        return USBDESCBLDR_OK;
+      enclosing->interfaces[(item->index >> 3) & 0x1f] |= 1 << (item->index & 7);
+    }
+    enclosing->count++;
+  }
+
+  return USBDESCBLDR_OK;
 }
 
 
 // Make a set of items subordinate to one parent item. This
 // is used to allow the parent item to account for their accumulated lengths.
 // Pass the context, a result item, and the subordinate items.
+// Only the hierarchy is recorded here; lengths and counts are
+// worked out once, by usbdescbldr_close().
 
 usbdescbldr_status_t
 usbdescbldr_add_children(usbdescbldr_ctx_t *  ctx,
                          usbdescbldr_item_t * parent,
                          ...) // Item pointers, then NULL
 {
-  va_list              va, va_count;
+  va_list              va, va_count, va_seen;
   usbdescbldr_item_t * ip;
-  uint32_t             n;
-  uint16_t             p16, s16;    // temps for Parent, Subordinate
+  usbdescbldr_item_t * up;
+  size_t               n, k;
+  int                  bad;
 
   if(parent == NULL)
     return USBDESCBLDR_INVALID;
 
-  // Everything should include itself.
-  p16 = parent->size;
-  if(parent->totalSize != NULL) {
-    memcpy(&p16, parent->totalSize, sizeof(p16));
-    p16 = ctx->fLittleShortToHost(p16);
-  }
-  if(p16 == 0)
-    p16 = parent->size;
+  // A flushing window session keeps no hierarchy (and its items are made
+  // over, so this one may well be its parent).
+  if(ctx != NULL && ctx->windowFlush != NULL)
+    return USBDESCBLDR_OK;
 
   va_start(va, parent);
   va_copy(va_count, va);
 
-  // Count the new subordinates
-  for(n = 0; (ip = va_arg(va_count, usbdescbldr_item_t *)) != NULL; n++)
-    ;
-  va_end(va_count);
-
-  if(parent->items + n > USBDESCBLDR_MAX_CHILDREN) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
-
-  for(; n > 0; n--) {
-    ip = va_arg(va, usbdescbldr_item_t *);
-    // (Repeating myself:) Everything should include itself.
-    // This time, it's mostly just a little convenience for the API-level code (below).
-    s16 = ip->size;
-    if(ip->totalSize != NULL) {
-      memcpy(&s16, ip->totalSize, sizeof(s16));
-      s16 = ctx->fLittleShortToHost(s16);
+  // Vet the new subordinates before changing anything.
+  for(n = 0; (ip = va_arg(va_count, usbdescbldr_item_t *)) != NULL; n++) {
+    // Each item has only one parent, and can't be its own (or its
+    // parent's, and so on up) ...
+    bad = ip->parent != NULL;
+    for(up = parent; up != NULL && !bad; up = up->parent)
+      bad = up == ip;
+
+    // ... nor be given twice.
+    va_copy(va_seen, va);
+    for(k = 0; k < n && !bad; k++)
+      bad = va_arg(va_seen, usbdescbldr_item_t *) == ip;
+    va_end(va_seen);
+
+    if(bad) {
+      va_end(va_count);
+      va_end(va);
+      return USBDESCBLDR_INVALID;
     }
-    if(s16 == 0) s16 = ip->size;
-    p16 += s16;
-
-    // Just in case for future: maintain the hierarchy
-    parent->item[parent->items++] = ip;
   }
-  va_end(va);
+  va_end(va_count);
 
-  // Save the result back into the descriptor
-  if(parent->totalSize != NULL) {
-    p16 = ctx->fHostToLittleShort(p16);
-    memcpy(parent->totalSize, &p16, sizeof(p16));
+  if(ctx != NULL && (ctx->options & USBDESCBLDR_OPTION_FINGERPRINT))
+    _fingerprint_u32(ctx, parent->offset);
+
+  // Append them, in order, to the parent's list.
+  while((ip = va_arg(va, usbdescbldr_item_t *)) != NULL) {
+    if(ctx != NULL && (ctx->options & USBDESCBLDR_OPTION_FINGERPRINT))
+      _fingerprint_u32(ctx, ip->offset);
+    ip->parent = parent;
+    ip->next = NULL;
+    if(parent->last != NULL)
+      parent->last->next = ip;
+    else
+      parent->first = ip;
+    parent->last = ip;
+    parent->items++;
+    if(ctx != NULL && ctx->record != NULL)
+      ctx->record(ctx->recorder, USBDESCBLDR_RECORD_LINK, ip, parent, NULL, 0);
   }
+  va_end(va);
 
   return USBDESCBLDR_OK;
 }
@@ -194,7 +734,9 @@ usbdescbldr_add_children(usbdescbldr_ctx_t *  ctx,
 // Reset internal state and begin a new descriptor.
 // Passing NULL for the buffer indicates a 'dry run' --
 // go through all the motions, checks, and size computations
-// but do not actually create a descriptor.
+// but do not actually create a descriptor. Afterwards,
+// usbdescbldr_get_size() tells how large a buffer the real
+// thing will need.
 
 usbdescbldr_status_t
 usbdescbldr_init(usbdescbldr_ctx_t *    ctx,
@@ -235,12 +777,466 @@ usbdescbldr_init(usbdescbldr_ctx_t *    ctx,
 }
 
 
+// Begin a new descriptor in a buffer which the session obtains, and grows
+// as needed, by way of the caller's allocator.
+usbdescbldr_status_t
+usbdescbldr_init_growable(usbdescbldr_ctx_t *             ctx,
+                          const usbdescbldr_allocator_t * allocator,
+                          size_t                          initialSize)
+{
+  unsigned char *      buffer;
+  usbdescbldr_status_t rc;
+
+  if(ctx == NULL || allocator == NULL ||
+     allocator->allocate == NULL || allocator->grow == NULL || allocator->release == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(initialSize == 0)
+    initialSize = USBDESCBLDR_GROWABLE_INITIAL_SIZE;
+
+  buffer = (unsigned char *) allocator->allocate(allocator->user, initialSize);
+  if(buffer == NULL)
+    return USBDESCBLDR_NO_SPACE;
+
+  rc = usbdescbldr_init(ctx, buffer, initialSize);
+  if(rc != USBDESCBLDR_OK) {
+    allocator->release(allocator->user, buffer);
+    return rc;
+  }
+
+  ctx->allocator = *allocator;
+  return USBDESCBLDR_OK;
+}
+
+
 // Commit (complete/finish) the descriptor in progress.
-// Collections, interfaces, etc left open will be tidied up
-// (if possible..?)
+// Here the layering happens: every item's total length, and the counts
+// derived from its subordinates, are worked out in one post-order pass
+// over the hierarchies given by usbdescbldr_add_children(), no matter in
+// what order the items were made or linked.
 usbdescbldr_status_t
 usbdescbldr_close(usbdescbldr_ctx_t *  ctx)
 {
+  usbdescbldr_item_t * ip;
+  usbdescbldr_status_t rc;
+
+  if(ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  // Start from each root; the walk down reaches everything else.
+  for(ip = ctx->made; ip != NULL; ip = ip->made) {
+    if(ip->parent != NULL)
+      continue;
+    rc = _item_finalize(ctx, ip, NULL);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+  }
+
+  // Hand on what a flushing window session has left in its window.
+  if(ctx->windowFlush != NULL) {
+    if(ctx->windowLength > 0 && ctx->length > ctx->windowOffset)
+      _window_flush(ctx, ctx->length - ctx->windowOffset < ctx->windowLength ?
+                         ctx->length - ctx->windowOffset : ctx->windowLength);
+    return (usbdescbldr_status_t) ctx->windowStatus;
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Choose how the session behaves. Options can't change once
+// anything has been made.
+usbdescbldr_status_t
+usbdescbldr_set_options(usbdescbldr_ctx_t * ctx,
+                        unsigned int        options)
+{
+  if(ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->made != NULL)
+    return USBDESCBLDR_INVALID;
+
+  // A fingerprint is made in a window of the caller's, one descriptor at a time.
+  if(options & USBDESCBLDR_OPTION_FINGERPRINT) {
+    if(ctx->buffer == NULL || ctx->bufferSize < USBDESCBLDR_FINGERPRINT_WINDOW ||
+       ctx->allocator.release != NULL || ctx->window != NULL)
+      return USBDESCBLDR_INVALID;
+    ctx->fingerprint = USBDESCBLDR_FNV_OFFSET;
+  }
+
+  // A segment list points at the descriptors where they were made.
+  if(ctx->segments != NULL &&
+     (options & (USBDESCBLDR_OPTION_FINGERPRINT | USBDESCBLDR_OPTION_RELOCATABLE)))
+    return USBDESCBLDR_INVALID;
+
+  ctx->options = options;
+  return USBDESCBLDR_OK;
+}
+
+
+// Move the session to another buffer, which already holds a copy of
+// everything made so far. Relocatable items need nothing more; others
+// have their addresses updated.
+usbdescbldr_status_t
+usbdescbldr_rebase(usbdescbldr_ctx_t * ctx,
+                   unsigned char *     buffer,
+                   size_t              bufferSize)
+{
+  usbdescbldr_item_t * ip;
+
+  if(ctx == NULL || buffer == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  // Can't rebase a dry run (there's nothing there to move)
+  if(ctx->buffer == NULL)
+    return USBDESCBLDR_DRY_RUN;
+
+  // .. nor a buffer the session owns; that moves only by growing;
+  // nor a fingerprint's or window session's scratch, nor what a
+  // segment list points at.
+  if(ctx->allocator.release != NULL || (ctx->options & USBDESCBLDR_OPTION_FINGERPRINT) ||
+     ctx->window != NULL || ctx->segments != NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(bufferSize < ctx->length)
+    return USBDESCBLDR_NO_SPACE;
+
+  ctx->buffer = buffer;
+  ctx->bufferSize = bufferSize;
+  ctx->append = buffer + ctx->length;
+
+  if(!(ctx->options & USBDESCBLDR_OPTION_RELOCATABLE)) {
+    for(ip = ctx->made; ip != NULL; ip = ip->made)
+      ip->address = buffer + ip->offset;
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Keep only a window of the descriptors. Like a fingerprint, this is
+// made one descriptor at a time in a buffer of the caller's.
+usbdescbldr_status_t
+usbdescbldr_set_window(usbdescbldr_ctx_t * ctx,
+                       unsigned char *     window,
+                       size_t              offset,
+                       size_t              length)
+{
+  if(ctx == NULL || (window == NULL && length != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->made != NULL || ctx->buffer == NULL || ctx->bufferSize < USBDESCBLDR_FINGERPRINT_WINDOW ||
+     ctx->allocator.release != NULL || (ctx->options & USBDESCBLDR_OPTION_FINGERPRINT) ||
+     ctx->segments != NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(length > ((size_t) -1) - offset)
+    return USBDESCBLDR_INVALID;
+
+  // (A window of nothing is still a window session.)
+  ctx->window = window != NULL ? window : ctx->buffer;
+  ctx->windowOffset = offset;
+  ctx->windowLength = length;
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Move a window session's window on as it fills, so that the descriptors
+// are made in one pass however many windows they take.
+usbdescbldr_status_t
+usbdescbldr_set_window_flush(usbdescbldr_ctx_t * ctx,
+                             usbdescbldr_flush_t flush,
+                             void *              user,
+                             size_t              end)
+{
+  if(ctx == NULL || flush == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->made != NULL || ctx->window == NULL || ctx->windowLength == 0 ||
+     end < ctx->windowOffset)
+    return USBDESCBLDR_INVALID;
+
+  ctx->windowFlush = flush;
+  ctx->windowUser = user;
+  ctx->windowEnd = end;
+  ctx->windowStatus = USBDESCBLDR_OK;
+  if(ctx->windowLength > end - ctx->windowOffset)
+    ctx->windowLength = end - ctx->windowOffset;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_set_fixups(usbdescbldr_ctx_t *   ctx,
+                       usbdescbldr_fixup_t * fixups,
+                       size_t                fixupCapacity)
+{
+  if(ctx == NULL || (fixups == NULL && fixupCapacity != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  ctx->fixups = fixups;
+  ctx->fixupCapacity = fixupCapacity;
+  ctx->fixupCount = 0;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_get_fixups(const usbdescbldr_ctx_t *    ctx,
+                       const usbdescbldr_fixup_t ** fixups,
+                       size_t *                     count)
+{
+  if(ctx == NULL || fixups == NULL || count == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  *fixups = ctx->fixups;
+  *count = ctx->fixupCount;
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Keep a list of the pieces of the descriptors, so that payloads of the
+// caller's can be referenced where they lie. The buffer must stay put,
+// and so must be the caller's.
+usbdescbldr_status_t
+usbdescbldr_set_segments(usbdescbldr_ctx_t *     ctx,
+                         usbdescbldr_segment_t * segments,
+                         size_t                  segmentCapacity)
+{
+  if(ctx == NULL || segments == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->made != NULL || ctx->buffer == NULL || ctx->allocator.release != NULL ||
+     (ctx->options & (USBDESCBLDR_OPTION_FINGERPRINT | USBDESCBLDR_OPTION_RELOCATABLE)) ||
+     ctx->window != NULL)
+    return USBDESCBLDR_INVALID;
+
+  ctx->segments = segments;
+  ctx->segmentCapacity = segmentCapacity;
+  ctx->segmentCount = 0;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_get_segments(const usbdescbldr_ctx_t *      ctx,
+                         const usbdescbldr_segment_t ** segments,
+                         size_t *                       count)
+{
+  if(ctx == NULL || segments == NULL || count == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->segments == NULL)
+    return USBDESCBLDR_INVALID;
+
+  *segments = ctx->segments;
+  *count = ctx->segmentCount;
+  return USBDESCBLDR_OK;
+}
+
+
+// Skip the pieces before the run, then take pieces until it is done.
+usbdescbldr_status_t
+usbdescbldr_slice_segments(const usbdescbldr_segment_t * segments,
+                           size_t                        count,
+                           size_t                        offset,
+                           size_t                        length,
+                           usbdescbldr_segment_t *       slice,
+                           size_t                        sliceCapacity,
+                           size_t *                      sliceCount)
+{
+  size_t s, take;
+
+  if((segments == NULL && count != 0) || (slice == NULL && sliceCapacity != 0) ||
+     sliceCount == NULL)
+    return USBDESCBLDR_INVALID;
+
+  *sliceCount = 0;
+  for(s = 0; s < count && length > 0; s++) {
+    if(offset >= segments[s].length) {
+      offset -= segments[s].length;
+      continue;
+    }
+
+    if(*sliceCount >= sliceCapacity)
+      return USBDESCBLDR_NO_SPACE;
+
+    take = segments[s].length - offset;
+    if(take > length)
+      take = length;
+
+    slice[*sliceCount].data = segments[s].data + offset;
+    slice[*sliceCount].length = take;
+    (*sliceCount)++;
+
+    offset = 0;
+    length -= take;
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Where an item's descriptor is, in the session's current buffer.
+void *
+usbdescbldr_item_address(const usbdescbldr_ctx_t *  ctx,
+                         const usbdescbldr_item_t * item)
+{
+  if(ctx == NULL || item == NULL || ctx->buffer == NULL ||
+     (ctx->options & USBDESCBLDR_OPTION_FINGERPRINT) || ctx->window != NULL)
+    return NULL;
+
+  // (Only the part made in the buffer, with a segment list.)
+  if(ctx->segments != NULL)
+    return item->address;
+
+  return ctx->buffer + item->offset;
+}
+
+
+// Give the session somewhere to keep items. Items are handed out
+// front to back, and are not returned until the next _init().
+usbdescbldr_status_t
+usbdescbldr_set_item_arena(usbdescbldr_ctx_t * ctx,
+                           void *              arena,
+                           size_t              arenaSize)
+{
+  if(ctx == NULL || (arena == NULL && arenaSize != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  ctx->itemArena = (unsigned char *) arena;
+  ctx->itemArenaSize = arenaSize;
+  ctx->itemArenaUsed = 0;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_item_alloc(usbdescbldr_ctx_t *   ctx,
+                       usbdescbldr_item_t ** item)
+{
+  size_t start;
+
+  if(ctx == NULL || item == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(ctx->itemArena == NULL)
+    return USBDESCBLDR_UNSUPPORTED;
+
+  // A flushing window session is done with each item once it is made.
+  if(ctx->windowFlush != NULL)
+    ctx->itemArenaUsed = 0;
+
+  // Keep each item aligned as the compiler would for an array of them.
+  start = ctx->itemArenaUsed;
+  start += (sizeof(void *) - ((uintptr_t) (ctx->itemArena + start) % sizeof(void *))) % sizeof(void *);
+
+  if(start > ctx->itemArenaSize || sizeof(**item) > ctx->itemArenaSize - start)
+    return USBDESCBLDR_NO_SPACE;
+
+  *item = (usbdescbldr_item_t *) (ctx->itemArena + start);
+  memset(*item, 0, sizeof(**item));
+  ctx->itemArenaUsed = start + sizeof(**item);
+
+  return USBDESCBLDR_OK;
+}
+
+
+// How many bytes have been made so far. In a dry run, this is the
+// size of the buffer needed to make them for real.
+usbdescbldr_status_t
+usbdescbldr_get_size(const usbdescbldr_ctx_t * ctx,
+                     size_t *                  size)
+{
+  if(ctx == NULL || size == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  *size = ctx->length;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_get_fingerprint(const usbdescbldr_ctx_t * ctx,
+                            uint64_t *                fingerprint)
+{
+  if(ctx == NULL || fingerprint == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(!(ctx->options & USBDESCBLDR_OPTION_FINGERPRINT))
+    return USBDESCBLDR_INVALID;
+
+  *fingerprint = ctx->fingerprint;
+  return USBDESCBLDR_OK;
+}
+
+
+// Hand a growable session's buffer over to the caller, who becomes
+// responsible for releasing it. The session is left with no buffer.
+usbdescbldr_status_t
+usbdescbldr_take_buffer(usbdescbldr_ctx_t * ctx,
+                        unsigned char **    buffer,
+                        size_t *            length)
+{
+  if(ctx == NULL || buffer == NULL || length == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->allocator.release == NULL || ctx->buffer == NULL)
+    return USBDESCBLDR_INVALID;
+
+  *buffer = ctx->buffer;
+  *length = ctx->length;
+
+  ctx->buffer = NULL;
+  ctx->bufferSize = 0;
+  ctx->append = NULL;
+  memset(&ctx->allocator, 0, sizeof(ctx->allocator));
+
   return USBDESCBLDR_OK;
 }
 
@@ -251,6 +1247,14 @@ usbdescbldr_close(usbdescbldr_ctx_t *  ctx)
 usbdescbldr_status_t
 usbdescbldr_end(usbdescbldr_ctx_t *  ctx)
 {
+  if(ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  // A buffer we allocated is ours to release.
+  if(ctx->allocator.release != NULL && ctx->buffer != NULL)
+    ctx->allocator.release(ctx->allocator.user, ctx->buffer);
+
+  memset(ctx, 0, sizeof(*ctx));
   return USBDESCBLDR_OK;
 }
 
@@ -266,14 +1270,13 @@ usbdescbldr_make_device_descriptor(usbdescbldr_ctx_t *ctx,
                                    const usbdescbldr_device_descriptor_short_form_t *form)
 {
   USB_DEVICE_DESCRIPTOR *dest;
-  uint16_t tShort;
 
   if(form == NULL || ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
 
   // This item has a fixed length; check for 'fit'
   if(ctx->buffer != NULL) {
-    if(sizeof(*dest) >= _bufferAvailable(ctx))
+    if(!_reserve(ctx, sizeof(*dest)))
       return USBDESCBLDR_NO_SPACE;
   }
 
@@ -286,8 +1289,7 @@ usbdescbldr_make_device_descriptor(usbdescbldr_ctx_t *ctx,
     dest->header.bLength = sizeof(*dest);
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_DEVICE;
 
-    tShort = ctx->fHostToLittleShort(form->bcdUSB);
-    memcpy(&dest->bcdUSB, &tShort, sizeof(dest->bcdUSB));
+    usbdescbldr_put_le16(&dest->bcdUSB, form->bcdUSB);
 
     dest->bDeviceClass = form->bDeviceClass;
     dest->bDeviceSubClass = form->bDeviceSubClass;
@@ -300,14 +1302,11 @@ usbdescbldr_make_device_descriptor(usbdescbldr_ctx_t *ctx,
     else
       dest->bMaxPacketSize0 = 9; // 2^9 == 512
 
-    tShort = ctx->fHostToLittleShort(form->idVendor);
-    memcpy(&dest->idVendor, &tShort, sizeof(dest->idVendor));
+    usbdescbldr_put_le16(&dest->idVendor, form->idVendor);
 
-    tShort = ctx->fHostToLittleShort(form->idProduct);
-    memcpy(&dest->idProduct, &tShort, sizeof(dest->idProduct));
+    usbdescbldr_put_le16(&dest->idProduct, form->idProduct);
 
-    tShort = ctx->fHostToLittleShort(form->bcdDevice);
-    memcpy(&dest->bcdDevice, &tShort, sizeof(dest->bcdDevice));
+    usbdescbldr_put_le16(&dest->bcdDevice, form->bcdDevice);
 
     dest->iManufacturer = form->iManufacturer;
     dest->iProduct = form->iProduct;
@@ -316,11 +1315,12 @@ usbdescbldr_make_device_descriptor(usbdescbldr_ctx_t *ctx,
   } // filling in buffer
 
   // Build the output item
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_DEVICE);
   item->size = sizeof(*dest);
-  item->address = ctx->append;
 
-  ctx->append += sizeof(*dest);
+  _advance(ctx, item, sizeof(*dest));
+
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -333,14 +1333,13 @@ usbdescbldr_make_device_qualifier_descriptor(usbdescbldr_ctx_t *  ctx,
                                              const usbdescbldr_device_qualifier_short_form_t * form)
 {
   USB_DEVICE_QUALIFIER_DESCRIPTOR *dest;
-  uint16_t tShort;
 
   if(form == NULL || ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
 
   // This item has a fixed length; check for 'fit'
   if (ctx->buffer != NULL) {
-    if (sizeof(*dest) > _bufferAvailable(ctx))
+    if(!_reserve(ctx, sizeof(*dest)))
       return USBDESCBLDR_NO_SPACE;
   }
 
@@ -353,8 +1352,7 @@ usbdescbldr_make_device_qualifier_descriptor(usbdescbldr_ctx_t *  ctx,
 
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER;
 
-    tShort = ctx->fHostToLittleShort(form->bcdUSB);
-    memcpy(&dest->bcdUSB, &tShort, sizeof(dest->bcdUSB));
+    usbdescbldr_put_le16(&dest->bcdUSB, form->bcdUSB);
 
     dest->bDeviceClass = form->bDeviceClass;
     dest->bDeviceSubClass = form->bDeviceSubClass;
@@ -371,12 +1369,12 @@ usbdescbldr_make_device_qualifier_descriptor(usbdescbldr_ctx_t *  ctx,
   } // filling in buffer
 
   // Build result
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_DEVICE_QUALIFIER);
   item->size = sizeof(*dest);
-  item->address = ctx->append;
 
   // Consume buffer
-    ctx->append += sizeof(*dest);
+  _advance(ctx, item, sizeof(*dest));
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -396,7 +1394,7 @@ usbdescbldr_make_device_configuration_descriptor(usbdescbldr_ctx_t *  ctx,
 
   // This item has a fixed length; check for 'fit'
   if(ctx->buffer != NULL) {
-    if(sizeof(*dest) > _bufferAvailable(ctx))
+    if(!_reserve(ctx, sizeof(*dest)))
       return USBDESCBLDR_NO_SPACE;
   }
 
@@ -417,13 +1415,12 @@ usbdescbldr_make_device_configuration_descriptor(usbdescbldr_ctx_t *  ctx,
   } // filling in buffer
 
   // Build result
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_CONFIGURATION);
   item->size = sizeof(*dest);
-  item->address = ctx->append;
-  item->totalSize = (uint8_t *) &dest->wTotalLength;
 
   // Consume buffer
-  ctx->append += sizeof(*dest);
+  _advance(ctx, item, sizeof(*dest));
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -431,17 +1428,14 @@ usbdescbldr_make_device_configuration_descriptor(usbdescbldr_ctx_t *  ctx,
 
 // Create the language descriptor (actually string, index 0).
 
-usbdescbldr_status_t
-usbdescbldr_make_languageIDs(usbdescbldr_ctx_t *  ctx,
-                             usbdescbldr_item_t * item,
-                             ...)
+static usbdescbldr_status_t
+_make_languageIDs(usbdescbldr_ctx_t *  ctx,
+                  usbdescbldr_item_t * item,
+                  _list_t *            langIDs)
 {
-  va_list             va_count, va_do;
-  unsigned int        langs;
-  uint16_t            lang;
-  size_t              needs;
-  unsigned char *     drop;
-  USB_STRING_DESCRIPTOR *dest = (USB_STRING_DESCRIPTOR *)ctx->append;
+  USB_STRING_DESCRIPTOR *dest;
+  size_t               needs;
+  usbdescbldr_status_t rc;
 
   if(ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -450,53 +1444,26 @@ usbdescbldr_make_languageIDs(usbdescbldr_ctx_t *  ctx,
   if(ctx->i_string != 0)
     return USBDESCBLDR_TOO_MANY;
 
-  va_start(va_do, item);      // One copy for work
-  va_copy(va_count, va_do);   // .. one copy just to count
-
-  // Count args until the terminator
-  for(langs = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; langs++)
-    ;
-  va_end(va_count);
-
-  // Now we know our length
-  needs = sizeof(*dest) + langs * sizeof(lang);
-
-  // Bounds check
-  if(needs > 0xff) {
-    va_end(va_do);
-    return USBDESCBLDR_OVERSIZED;
-  }
-
-  // If not dry-run, be sure we can write
-  if(ctx->buffer != NULL && _bufferAvailable(ctx) < needs) {
-    va_end(va_do);
-    return USBDESCBLDR_NO_SPACE;
-  }
+  // In Strings, the string unichars immediately follow the header
+  rc = _list_put(ctx, langIDs, sizeof(*dest), 0, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // Continue construction
   if(ctx->buffer != NULL) {
+    dest = (USB_STRING_DESCRIPTOR *) ctx->append;
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_STRING;
-
-    // In Strings, the string unichars immediately follow the header
-    drop = ((unsigned char *) dest) + sizeof(USB_DESCRIPTOR_HEADER);
-    for(; langs > 0; langs--) {
-      lang = (uint16_t) va_arg(va_do, unsigned int);
-      lang = ctx->fHostToLittleShort(lang);
-      memcpy(drop, &lang, sizeof(lang));
-      drop += sizeof(lang);
-    }
   }
-  va_end(va_do);
 
   // Build the item for the caller
-  _item_init(item);
-  item->address = ctx->append;
+  _item_init(ctx, item, USBDESCBLDR_KIND_LANGUAGES);
   item->size = needs;
   item->index = ctx->i_string;
 
   // Advance the buffer
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, NULL, langIDs);
 
   // This counts as string index 0
   ctx->i_string++;
@@ -505,7 +1472,45 @@ usbdescbldr_make_languageIDs(usbdescbldr_ctx_t *  ctx,
 }
 
 
+usbdescbldr_status_t
+usbdescbldr_make_languageIDs_fixed(usbdescbldr_ctx_t *  ctx,
+                                   usbdescbldr_item_t * item,
+                                   const uint16_t *     langIDs,
+                                   size_t               langIDsLength)
+{
+  _list_t list;
+
+  if(langIDs == NULL && langIDsLength != 0)
+    return USBDESCBLDR_INVALID;
+
+  // Bounds check
+  if(langIDsLength > 0xff)
+    return USBDESCBLDR_OVERSIZED;
 
+  _list_array(&list, langIDs, langIDsLength, sizeof(*langIDs));
+  return _make_languageIDs(ctx, item, &list);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_make_languageIDs(usbdescbldr_ctx_t *  ctx,
+                             usbdescbldr_item_t * item,
+                             ...)
+{
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
+
+  va_start(va, item);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint16_t));
+
+  rc = _make_languageIDs(ctx, item, &list);
+
+  va_end(again);
+  va_end(va);
+  return rc;
+}
 
 
 // Define a new string and obtain its index.
@@ -518,9 +1523,8 @@ usbdescbldr_make_string_descriptor(usbdescbldr_ctx_t *  ctx,
 {
   USB_STRING_DESCRIPTOR *dest;
   size_t needs;
-  unsigned char *drop;
-  const char *ascii;
-  uint16_t wchar;
+  size_t room, length, units, made;
+  usbdescbldr_status_t rc;
 
   if(string == NULL || ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -529,39 +1533,57 @@ usbdescbldr_make_string_descriptor(usbdescbldr_ctx_t *  ctx,
   if (ctx->i_string > 0xff)
     return USBDESCBLDR_TOO_MANY;
     
-  // This has a fixed length, so check up front
-  needs = strlen(string) * sizeof(wchar) + sizeof(*dest);
+  // Widen the string straight into the buffer, checking the UTF-8 and
+  // counting as it goes, in as much of the room left as a string can use
+  // (a dry run only counts).
+  if (ctx->buffer == NULL) {
+    rc = usbdescbldr_utf8z_to_utf16le(NULL, 0, string, &made);
+  } else if (!_reserve(ctx, sizeof(*dest))) {
+    rc = USBDESCBLDR_NO_SPACE;
+  } else {
+    room = _bufferAvailable(ctx) < 0xff ? _bufferAvailable(ctx) : 0xff;
+    rc = usbdescbldr_utf8z_to_utf16le(ctx->append + sizeof(USB_DESCRIPTOR_HEADER),
+                                      room - sizeof(USB_DESCRIPTOR_HEADER), string, &made);
+  }
+
+  // Out of room: either the string is too long for a descriptor, or the
+  // buffer is (nearly) full. Do it again the long way, to tell which
+  // (and to grow the buffer, if it can).
+  if (rc == USBDESCBLDR_NO_SPACE) {
+    length = strlen(string);
+    rc = usbdescbldr_utf8_units(string, length, &units);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+    if (units * sizeof(uint16_t) + sizeof(*dest) > 0xff)
+      return USBDESCBLDR_OVERSIZED;
+    if(!_reserve(ctx, units * sizeof(uint16_t) + sizeof(*dest)))
+      return USBDESCBLDR_NO_SPACE;
+    usbdescbldr_utf8_to_utf16le(ctx->append + sizeof(USB_DESCRIPTOR_HEADER),
+                                units * sizeof(uint16_t), string, length, &made);
+  }
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  needs = made + sizeof(*dest);
   if (needs > 0xff)
     return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
 
   // Construct
   // (No need to stack)
   if (ctx->buffer != NULL) {
-    if (needs > _bufferAvailable(ctx))
-      return USBDESCBLDR_NO_SPACE;
-
     dest = (USB_STRING_DESCRIPTOR *) ctx->append;
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_STRING;
-
-    // In Strings, the string unichars immediately follow the header
-    drop = ((unsigned char *) dest) + sizeof(USB_DESCRIPTOR_HEADER);
-    for(ascii = string; *ascii; ++ascii) {      // (Do not copy the NULL)
-      wchar = (uint16_t) *ascii;                // (zero-extending, very explicitly)
-      wchar = ctx->fHostToLittleShort(wchar);
-      memcpy(drop, & wchar, sizeof(wchar));
-      drop += sizeof(wchar);
-    } 
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_STRING);
   item->size = needs;
-  item->address = ctx->append;
   item->index = ctx->i_string;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, string, NULL, 0);
 
   // Give the caller the assigned string index, if they want it
   if (index != NULL) 
@@ -572,6 +1594,60 @@ usbdescbldr_make_string_descriptor(usbdescbldr_ctx_t *  ctx,
 }
 
 
+// Define a new string from characters already in UTF-16LE, as the
+// descriptor holds them; with a segment list they are not copied.
+
+usbdescbldr_status_t
+usbdescbldr_make_string_descriptor_utf16le(usbdescbldr_ctx_t *  ctx,
+                                           usbdescbldr_item_t * item,
+                                           uint8_t *            index,
+                                           const uint8_t *      utf16le,
+                                           size_t               utf16leSize)
+{
+  USB_STRING_DESCRIPTOR *dest;
+  size_t needs;
+  size_t tail;
+
+  if(ctx == NULL || item == NULL || (utf16le == NULL && utf16leSize != 0) ||
+     (utf16leSize % sizeof(uint16_t)) != 0)
+    return USBDESCBLDR_INVALID;
+
+  if (ctx->i_string > 0xff)
+    return USBDESCBLDR_TOO_MANY;
+
+  needs = sizeof(USB_DESCRIPTOR_HEADER) + utf16leSize;
+  if (needs > 0xff)
+    return USBDESCBLDR_OVERSIZED;
+
+  tail = ctx->segments != NULL ? utf16leSize : 0;
+
+  if (ctx->buffer != NULL) {
+    if(!_reserve(ctx, needs - tail))
+      return USBDESCBLDR_NO_SPACE;
+
+    dest = (USB_STRING_DESCRIPTOR *) ctx->append;
+    dest->header.bLength = needs;
+    dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_STRING;
+    if(tail == 0 && utf16leSize != 0)
+      memcpy(((unsigned char *) dest) + sizeof(USB_DESCRIPTOR_HEADER), utf16le, utf16leSize);
+  }
+
+  _item_init(ctx, item, USBDESCBLDR_KIND_STRING);
+  item->size = needs;
+  item->index = ctx->i_string;
+
+  _advance_tail(ctx, item, needs, utf16le, tail);
+  if(ctx->record != NULL)
+    ctx->record(ctx->recorder, USBDESCBLDR_RECORD_UTF16LE, item, NULL, utf16le, utf16leSize);
+
+  if (index != NULL) 
+    *index = ctx->i_string;
+  ctx->i_string++;
+
+  return USBDESCBLDR_OK;
+}
+
+
 usbdescbldr_status_t
 usbdescbldr_make_bos_descriptor(usbdescbldr_ctx_t *  ctx,
                                 usbdescbldr_item_t * item,
@@ -584,7 +1660,7 @@ usbdescbldr_make_bos_descriptor(usbdescbldr_ctx_t *  ctx,
   
   // Check space
   if (ctx->buffer != NULL) {
-    if (sizeof(*dest) > _bufferAvailable(ctx)) 
+    if(!_reserve(ctx, sizeof(*dest)))
       return USBDESCBLDR_NO_SPACE;
   }
 
@@ -600,12 +1676,12 @@ usbdescbldr_make_bos_descriptor(usbdescbldr_ctx_t *  ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_BOS);
   item->size = sizeof(*dest);
-  item->address = ctx->append;
-  item->totalSize = (uint8_t *) & dest->wTotalLength;
 
-  ctx->append += sizeof(*dest);
+  _advance(ctx, item, sizeof(*dest));
+
+  _record(ctx, item, &capabilities, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -619,6 +1695,7 @@ usbdescbldr_make_device_capability_descriptor(usbdescbldr_ctx_t *  ctx,
 {
   USB_DEVICE_CAPABILITY_DESCRIPTOR *dest;
   size_t needs;
+  size_t tail;
 
   if(ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -633,28 +1710,32 @@ usbdescbldr_make_device_capability_descriptor(usbdescbldr_ctx_t *  ctx,
   if(needs > 0xff)
     return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
 
+  // With a segment list, the type dependent bytes are referenced
+  tail = ctx->segments != NULL ? typeDependentSize : 0;
+
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs - tail))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_DEVICE_CAPABILITY_DESCRIPTOR *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, needs - tail);
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_DEVICE_CAPABILITY;
 
     dest->bDevCapabilityType = bDevCapabilityType;
-    memcpy((void *) (dest + 1), typeDependent, typeDependentSize);
+    if(tail == 0)
+      memcpy((void *) (dest + 1), typeDependent, typeDependentSize);
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_DEVICE_CAPABILITY);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance_tail(ctx, item, needs, typeDependent, tail);
+  _record(ctx, item, &bDevCapabilityType, typeDependent, typeDependentSize);
 
   return USBDESCBLDR_OK;
 }
@@ -680,7 +1761,7 @@ usbdescbldr_make_standard_interface_descriptor(usbdescbldr_ctx_t *  ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_INTERFACE_DESCRIPTOR *) ctx->append;
@@ -699,12 +1780,13 @@ usbdescbldr_make_standard_interface_descriptor(usbdescbldr_ctx_t *  ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_INTERFACE);
   item->size = needs;
-  item->address = ctx->append;
+  item->index = form->bInterfaceNumber;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -716,7 +1798,6 @@ usbdescbldr_make_endpoint_descriptor(usbdescbldr_ctx_t *  ctx,
                                      const usbdescbldr_endpoint_short_form_t * form)
 {
   USB_ENDPOINT_DESCRIPTOR *dest;
-  uint16_t tShort;
   size_t needs;
 
   if(form == NULL || ctx == NULL || item == NULL)
@@ -729,7 +1810,7 @@ usbdescbldr_make_endpoint_descriptor(usbdescbldr_ctx_t *  ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_ENDPOINT_DESCRIPTOR *) ctx->append;
@@ -740,19 +1821,18 @@ usbdescbldr_make_endpoint_descriptor(usbdescbldr_ctx_t *  ctx,
 
     dest->bEndpointAddress = form->bEndpointAddress;
     dest->bmAttributes = form->bmAttributes;
-    tShort = ctx->fHostToLittleShort(form->wMaxPacketSize);
-    memcpy(&dest->wMaxPacketSize, &tShort, sizeof(dest->wMaxPacketSize));
+    usbdescbldr_put_le16(&dest->wMaxPacketSize, form->wMaxPacketSize);
     dest->bInterval = form->bInterval;
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_ENDPOINT);
   item->size = needs;
-  item->address = ctx->append;
   item->index = form->bEndpointAddress;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -764,7 +1844,6 @@ usbdescbldr_make_ss_ep_companion_descriptor(usbdescbldr_ctx_t *  ctx,
                                             const usbdescbldr_ss_ep_companion_short_form_t * form)
 {
   USB_SS_EP_COMPANION_DESCRIPTOR *dest;
-  uint16_t tShort;
   size_t needs;
 
   if(form == NULL || ctx == NULL || item == NULL)
@@ -777,7 +1856,7 @@ usbdescbldr_make_ss_ep_companion_descriptor(usbdescbldr_ctx_t *  ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_SS_EP_COMPANION_DESCRIPTOR *) ctx->append;
@@ -788,17 +1867,16 @@ usbdescbldr_make_ss_ep_companion_descriptor(usbdescbldr_ctx_t *  ctx,
 
     dest->bMaxBurst = form->bMaxBurst;
     dest->bmAttributes = form->bmAttributes;
-    tShort = ctx->fHostToLittleShort(form->wBytesPerInterval);
-    memcpy(&dest->wBytesPerInterval, &tShort, sizeof(dest->wBytesPerInterval));
+    usbdescbldr_put_le16(&dest->wBytesPerInterval, form->wBytesPerInterval);
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_SS_EP_COMPANION);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -823,7 +1901,7 @@ usbdescbldr_make_interface_association_descriptor(usbdescbldr_ctx_t *  ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_INTERFACE_ASSOCIATION_DESCRIPTOR *) ctx->append;
@@ -841,12 +1919,12 @@ usbdescbldr_make_interface_association_descriptor(usbdescbldr_ctx_t *  ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_INTERFACE_ASSOCIATION);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -916,62 +1994,66 @@ usbdescbldr_make_vs_interface_descriptor(usbdescbldr_ctx_t * ctx,
 // a variable number of interfaces at the end, which are given by their
 // interface numbers in a list, terminated with USBDESCBLDR_END_LIST .
 
-usbdescbldr_status_t
-usbdescbldr_make_vc_interface_header_fixed(usbdescbldr_ctx_t *  ctx,
-                                           usbdescbldr_item_t * item,
-                                           uint32_t             dwClockFrequency,
-                                           const uint8_t *      interfaceList,
-                                           size_t               interfaceListLength)
+static usbdescbldr_status_t
+_make_vc_interface_header(usbdescbldr_ctx_t *  ctx,
+                          usbdescbldr_item_t * item,
+                          uint32_t             dwClockFrequency,
+                          _list_t *            interfaces)
 {
   USB_VC_CS_INTERFACE_DESCRIPTOR * dest = NULL;
-  size_t needs;
-  uint16_t tShort;
-  uint32_t tInt;
+  size_t               needs;
+  usbdescbldr_status_t rc;
 
   if(ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
 
-  if (interfaceListLength > 0xff)
-    return USBDESCBLDR_TOO_MANY;
-
-  needs = sizeof(*dest) + sizeof(uint8_t) * interfaceListLength;
-  if(needs > 0xff)
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+  // Tack on the interface(s)
+  rc = _list_put(ctx, interfaces, sizeof(*dest), 0, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
-      return USBDESCBLDR_NO_SPACE;
-
     dest = (USB_VC_CS_INTERFACE_DESCRIPTOR *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
     dest->header.bDescriptorSubtype = USB_INTERFACE_SUBTYPE_VC_HEADER;
 
-    tShort = ctx->fHostToLittleShort(UVC_CLASS);
-    memcpy(&dest->bcdUVC, &tShort, sizeof(dest->bcdUVC));
-
-    tInt = ctx->fHostToLittleInt(dwClockFrequency);
-    memcpy(&dest->dwClockFrequency, &tInt, sizeof(dest->dwClockFrequency));
-    dest->bInCollection = interfaceListLength;
+    usbdescbldr_put_le16(&dest->bcdUVC, UVC_CLASS);
 
-    // Tack on the interface(s)
-    memcpy((void *) (dest + 1), interfaceList, sizeof(*interfaceList) * interfaceListLength);
+    usbdescbldr_put_le32(&dest->dwClockFrequency, dwClockFrequency);
+    dest->bInCollection = interfaces->length;
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_HEADER);
   item->size = needs;
-  item->address = ctx->append;
-  item->totalSize = (uint8_t *) &dest->wTotalLength;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, &dwClockFrequency, interfaces);
 
   return USBDESCBLDR_OK;
 }
+
+
+usbdescbldr_status_t
+usbdescbldr_make_vc_interface_header_fixed(usbdescbldr_ctx_t *  ctx,
+                                           usbdescbldr_item_t * item,
+                                           uint32_t             dwClockFrequency,
+                                           const uint8_t *      interfaceList,
+                                           size_t               interfaceListLength)
+{
+  _list_t list;
+
+  if (interfaceListLength > 0xff)
+    return USBDESCBLDR_TOO_MANY;
+
+  _list_array(&list, interfaceList, interfaceListLength, sizeof(*interfaceList));
+  return _make_vc_interface_header(ctx, item, dwClockFrequency, &list);
+}
     
 usbdescbldr_status_t
 usbdescbldr_make_vc_interface_header(usbdescbldr_ctx_t *  ctx,
@@ -980,32 +2062,19 @@ usbdescbldr_make_vc_interface_header(usbdescbldr_ctx_t *  ctx,
                                      ... // Terminated List of Interface Numbers
 )
 {
-  uint8_t   bInCollection;      // Number of interfaces
-  va_list   va, va_count;
-  uint8_t   collection[USBDESCBLDR_PARAM_MAX];
-  size_t    c;
-
-  // Determine the final length
-  va_start(va_count, dwClockFrequency);
-  va_copy(va, va_count);
-
-  for(bInCollection = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; bInCollection++)
-    ;
-  va_end(va_count);
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  if (bInCollection > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
+  va_start(va, dwClockFrequency);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint8_t));
 
-  for(c = 0; c < bInCollection; c++)
-    collection[c] = (uint8_t) va_arg(va, uint32_t);
+  rc = _make_vc_interface_header(ctx, item, dwClockFrequency, &list);
 
+  va_end(again);
   va_end(va);
-
-  return usbdescbldr_make_vc_interface_header_fixed(ctx, item,
-                                                    dwClockFrequency,
-                                                    collection, bInCollection);
+  return rc;
 }
 
 
@@ -1018,7 +2087,6 @@ usbdescbldr_make_camera_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 {
   USB_UVC_CAMERA_TERMINAL *dest = NULL;
   size_t needs;
-  uint32_t t32;
 
   if(form == NULL || ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -1027,7 +2095,7 @@ usbdescbldr_make_camera_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_UVC_CAMERA_TERMINAL *) ctx->append;
@@ -1039,34 +2107,29 @@ usbdescbldr_make_camera_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 
     dest->bTerminalID = form->bTerminalID;
 
-    t32 = ctx->fHostToLittleShort(USB_UVC_ITT_CAMERA);
-    memcpy(&dest->wTerminalType, &t32, sizeof(dest->wTerminalType));
+    usbdescbldr_put_le16(&dest->wTerminalType, USB_UVC_ITT_CAMERA);
 
     dest->bAssocTerminal = form->bAssocTerminal;
     dest->iTerminal = form->iTerminal;
 
-    t32 = ctx->fHostToLittleShort(form->wObjectiveFocalLengthMin);
-    memcpy(&dest->wObjectiveFocalLengthMin, &t32, sizeof(dest->wObjectiveFocalLengthMin));
+    usbdescbldr_put_le16(&dest->wObjectiveFocalLengthMin, form->wObjectiveFocalLengthMin);
 
-    t32 = ctx->fHostToLittleShort(form->wObjectiveFocalLengthMax);
-    memcpy(&dest->wObjectiveFocalLengthMax, &t32, sizeof(dest->wObjectiveFocalLengthMax));
+    usbdescbldr_put_le16(&dest->wObjectiveFocalLengthMax, form->wObjectiveFocalLengthMax);
 
-    t32 = ctx->fHostToLittleShort(form->wOcularFocalLength);
-    memcpy(&dest->wOcularFocalLength, &t32, sizeof(dest->wOcularFocalLength));
+    usbdescbldr_put_le16(&dest->wOcularFocalLength, form->wOcularFocalLength);
 
-    // Using t32 as a 3-byte buffer; just don't copy the whole four bytes
+    // bmControls is three bytes
     dest->bControlBitfieldSize = sizeof(dest->bmControls);
-    t32 = ctx->fHostToLittleInt(form->controls);
-    memcpy(&dest->bmControls, &t32, sizeof(dest->bmControls));
+    usbdescbldr_put_le24(&dest->bmControls, form->controls);
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_CAMERA_TERMINAL);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -1081,7 +2144,6 @@ usbdescbldr_make_streaming_out_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 {
   USB_UVC_STREAMING_OUT_TERMINAL *dest;
   size_t needs;
-  uint32_t t32;
 
   if(form == NULL || ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -1090,7 +2152,7 @@ usbdescbldr_make_streaming_out_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_UVC_STREAMING_OUT_TERMINAL *) ctx->append;
@@ -1102,8 +2164,7 @@ usbdescbldr_make_streaming_out_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 
     dest->bTerminalID = form->bTerminalID;
 
-    t32 = ctx->fHostToLittleShort(USB_UVC_OTT_STREAMING);
-    memcpy(&dest->wTerminalType, &t32, sizeof(dest->wTerminalType));
+    usbdescbldr_put_le16(&dest->wTerminalType, USB_UVC_OTT_STREAMING);
 
     dest->bAssocTerminal = form->bAssocTerminal;
     dest->bSourceID = form->bSourceID;
@@ -1111,12 +2172,12 @@ usbdescbldr_make_streaming_out_terminal_descriptor(usbdescbldr_ctx_t * ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_OUTPUT_TERMINAL);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -1125,37 +2186,30 @@ usbdescbldr_make_streaming_out_terminal_descriptor(usbdescbldr_ctx_t * ctx,
 
 // The Selector Unit.
 
-usbdescbldr_status_t
-usbdescbldr_make_vc_selector_unit_fixed(usbdescbldr_ctx_t *  ctx,
-                                        usbdescbldr_item_t * item,
-                                        uint8_t              iSelector,    // string index
-                                        uint8_t              bUnitID,
-                                        const uint8_t *      inputs,       // List of Input (Source) Pin(s)
-                                        size_t               inputsLength) // Length of the above
-   
-
+static usbdescbldr_status_t
+_make_vc_selector_unit(usbdescbldr_ctx_t *  ctx,
+                       usbdescbldr_item_t * item,
+                       uint8_t              iSelector,
+                       uint8_t              bUnitID,
+                       _list_t *            inputs)
 {
   USB_UVC_VC_SELECTOR_UNIT * dest;
-  size_t    needs;
-  uint8_t * drop;
+  size_t               needs;
+  uint8_t              args[2];          // The scalars, in order, for a recorder
+  usbdescbldr_status_t rc;
 
   if(ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
 
-  if (inputsLength > 255)
-    return USBDESCBLDR_TOO_MANY;
-
-  needs = sizeof(*dest) + sizeof(*inputs) * inputsLength + sizeof(iSelector);
-  if(needs > 0xff)
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+  // The inputs follow the bNrInPins, and the iSelector (string) follows them
+  rc = _list_put(ctx, inputs, sizeof(*dest) + sizeof(uint8_t), sizeof(iSelector), &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
-      return USBDESCBLDR_NO_SPACE;
-
     dest = (USB_UVC_VC_SELECTOR_UNIT *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
@@ -1163,27 +2217,42 @@ usbdescbldr_make_vc_selector_unit_fixed(usbdescbldr_ctx_t *  ctx,
 
     dest->bUnitID = bUnitID;
     
-    // Tack on the bNrInPins and interface(s)
-    drop = (uint8_t *) (dest + 1);
-    *drop++ = inputsLength;
-    memcpy(drop, inputs, sizeof(*inputs) * inputsLength);
-    drop += sizeof(*inputs) * inputsLength;
-    // .. and the iSelector (string).
-    *drop = iSelector;
+    *(uint8_t *) (dest + 1) = inputs->length;
+    ctx->append[needs - sizeof(iSelector)] = iSelector;
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_SELECTOR_UNIT);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  args[0] = iSelector;
+  args[1] = bUnitID;
+  _record_list(ctx, item, args, inputs);
 
   return USBDESCBLDR_OK;
 }
 
 
+usbdescbldr_status_t
+usbdescbldr_make_vc_selector_unit_fixed(usbdescbldr_ctx_t *  ctx,
+                                        usbdescbldr_item_t * item,
+                                        uint8_t              iSelector,    // string index
+                                        uint8_t              bUnitID,
+                                        const uint8_t *      inputs,       // List of Input (Source) Pin(s)
+                                        size_t               inputsLength) // Length of the above
+{
+  _list_t list;
+
+  if (inputsLength > 255)
+    return USBDESCBLDR_TOO_MANY;
+
+  _list_array(&list, inputs, inputsLength, sizeof(*inputs));
+  return _make_vc_selector_unit(ctx, item, iSelector, bUnitID, &list);
+}
+
+
 usbdescbldr_status_t
 usbdescbldr_make_vc_selector_unit(usbdescbldr_ctx_t *  ctx,
                                   usbdescbldr_item_t * item,
@@ -1192,31 +2261,19 @@ usbdescbldr_make_vc_selector_unit(usbdescbldr_ctx_t *  ctx,
                                   ... // Terminated List of Input (Source) Pin(s)
 )
 {
-  uint8_t   bNrInPins;      // Number of inputs
-  va_list   va, va_count;
-  size_t    c;
-  uint8_t   inputs[USBDESCBLDR_PARAM_MAX];
-
-
-  // Determine the final length
-  va_start(va_count, bUnitID);
-  va_copy(va, va_count);
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  for(bNrInPins = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; bNrInPins++)
-    ;
-  va_end(va_count);
+  va_start(va, bUnitID);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint8_t));
 
-  if (bNrInPins > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
+  rc = _make_vc_selector_unit(ctx, item, iSelector, bUnitID, &list);
 
-  for(c = 0; c < bNrInPins; c++)
-    inputs[c] = (uint8_t) va_arg(va, uint32_t);
+  va_end(again);
   va_end(va);
-
-  return usbdescbldr_make_vc_selector_unit_fixed(ctx, item, iSelector, bUnitID,
-                                                 inputs, bNrInPins);
+  return rc;
 }
 
 
@@ -1231,8 +2288,6 @@ usbdescbldr_make_vc_processor_unit(usbdescbldr_ctx_t *  ctx,
 {
   USB_UVC_VC_PROCESSING_UNIT * dest;
   size_t needs;
-  uint32_t t32;
-  uint16_t t16;
 
   if(ctx == NULL || form == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -1241,7 +2296,7 @@ usbdescbldr_make_vc_processor_unit(usbdescbldr_ctx_t *  ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_UVC_VC_PROCESSING_UNIT *) ctx->append;
@@ -1254,12 +2309,10 @@ usbdescbldr_make_vc_processor_unit(usbdescbldr_ctx_t *  ctx,
     dest->bUnitID = form->bUnitID;
     dest->bSourceID = form->bSourceID;
 
-    t16 = ctx->fHostToLittleShort(form->wMaxMultiplier);
-    memcpy(&dest->wMaxMultiplier, &t16, sizeof(dest->wMaxMultiplier));
+    usbdescbldr_put_le16(&dest->wMaxMultiplier, form->wMaxMultiplier);
 
     dest->bControlSize = sizeof(dest->bmControls);
-    t32 = ctx->fHostToLittleInt(form->controls);
-    memcpy(&dest->bmControls, &t32, sizeof(dest->bmControls));
+    usbdescbldr_put_le24(&dest->bmControls, form->controls);
 
     dest->iProcessing = form->iProcessing;
 #if     UVC_CLASS_SELECT >= 110
@@ -1268,50 +2321,46 @@ usbdescbldr_make_vc_processor_unit(usbdescbldr_ctx_t *  ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_PROCESSING_UNIT);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
 
 
-usbdescbldr_status_t
-usbdescbldr_make_extension_unit_descriptor_fixed(usbdescbldr_ctx_t *  ctx,
-                                                 usbdescbldr_item_t * item,
-                                                 const usbdescbldr_vc_extension_unit_short_form_t * form,
-                                                 const uint8_t *      sources,
-                                                 size_t               sourcesLength)
+static usbdescbldr_status_t
+_make_extension_unit_descriptor(usbdescbldr_ctx_t *  ctx,
+                                usbdescbldr_item_t * item,
+                                const usbdescbldr_vc_extension_unit_short_form_t * form,
+                                _list_t *            sources)
 {
   USB_UVC_VC_EXTENSION_UNIT * dest;
-  size_t    needs;
-  uint8_t * drop;
-  USB_GUID  tGUID;
+  size_t               needs, after;
+  uint8_t *            drop;
+  usbdescbldr_status_t rc;
 
-  if(item == NULL)
+  if(item == NULL || form == NULL)
     return USBDESCBLDR_INVALID;
 
   // A complex structure, with multiple varying-size fields *and* fixed-sized
-  // ones intermingled among them.
-  needs = sizeof(*dest);                  // Prefix of fixed-size fields
-  needs += sizeof(*sources) * sourcesLength; // baSourceID
-  needs += sizeof(uint8_t);               // bControlSize
-  needs += form->bControlSize;            // bmControls
-  needs += sizeof(uint8_t);               // iExtension
+  // ones intermingled among them. The sources (baSourceID) follow the prefix
+  // of fixed-size fields; after them come the rest.
+  after = sizeof(uint8_t);                // bControlSize
+  after += form->bControlSize;            // bmControls
+  after += sizeof(uint8_t);               // iExtension
 
-  if(needs > 0xff)
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+  rc = _list_put(ctx, sources, sizeof(*dest), after, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
-      return USBDESCBLDR_NO_SPACE;
-
     dest = (USB_UVC_VC_EXTENSION_UNIT *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
@@ -1319,19 +2368,16 @@ usbdescbldr_make_extension_unit_descriptor_fixed(usbdescbldr_ctx_t *  ctx,
 
     dest->bUnitID = form->bUnitID;
 
-    tGUID.dwData1 = ctx->fHostToLittleInt(form->guidExtensionCode.dwData1);
-    tGUID.dwData2 = ctx->fHostToLittleShort(form->guidExtensionCode.dwData2);
-    tGUID.dwData3 = ctx->fHostToLittleShort(form->guidExtensionCode.dwData3);
-    memcpy(&tGUID.dwData4, form->guidExtensionCode.dwData4, sizeof(tGUID.dwData4));
-    memcpy(&dest->guidExtensionCode, &tGUID, sizeof(dest->guidExtensionCode));
+    usbdescbldr_put_le32(&dest->guidExtensionCode.dwData1, form->guidExtensionCode.dwData1);
+    usbdescbldr_put_le16(&dest->guidExtensionCode.dwData2, form->guidExtensionCode.dwData2);
+    usbdescbldr_put_le16(&dest->guidExtensionCode.dwData3, form->guidExtensionCode.dwData3);
+    memcpy(dest->guidExtensionCode.dwData4, form->guidExtensionCode.dwData4, sizeof(dest->guidExtensionCode.dwData4));
 
     dest->bNumControls = form->bNumControls;
-    dest->bNrInPins = sourcesLength;
+    dest->bNrInPins = sources->length;
 
-    // Tack on the sources(s): baSourceID
-    drop = (uint8_t *) (dest + 1);
-    memcpy(drop, sources, sizeof(*sources) * sourcesLength);
-    drop += sizeof(*sources) * sourcesLength;
+    // Past the sources:
+    drop = ctx->append + needs - after;
 
     // bControlSize
     *drop++ = form->bControlSize;
@@ -1345,18 +2391,30 @@ usbdescbldr_make_extension_unit_descriptor_fixed(usbdescbldr_ctx_t *  ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_EXTENSION_UNIT);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, form, sources);
 
   return USBDESCBLDR_OK;
 }
 
 
-// UVC Class-Specific VC interrupt endpoint:
+usbdescbldr_status_t
+usbdescbldr_make_extension_unit_descriptor_fixed(usbdescbldr_ctx_t *  ctx,
+                                                 usbdescbldr_item_t * item,
+                                                 const usbdescbldr_vc_extension_unit_short_form_t * form,
+                                                 const uint8_t *      sources,
+                                                 size_t               sourcesLength)
+{
+  _list_t list;
+
+  _list_array(&list, sources, sourcesLength, sizeof(*sources));
+  return _make_extension_unit_descriptor(ctx, item, form, &list);
+}
+
 
 usbdescbldr_status_t
 usbdescbldr_make_extension_unit_descriptor(usbdescbldr_ctx_t * ctx,
@@ -1364,30 +2422,19 @@ usbdescbldr_make_extension_unit_descriptor(usbdescbldr_ctx_t * ctx,
                                            const usbdescbldr_vc_extension_unit_short_form_t * form,
                                            ...) // Varying number of SourceIDs.
 {
-  uint8_t   bNrSources;      // Number of sources
-  va_list   va, va_count;
-  uint8_t   sources[USBDESCBLDR_PARAM_MAX];
-  size_t    p;
-
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  // Determine the final length
-  va_start(va_count, form);
-  va_copy(va, va_count);
+  va_start(va, form);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint8_t));
 
-  for(bNrSources = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; bNrSources++)
-    ;
-  va_end(va_count);
-
-  if (bNrSources > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
+  rc = _make_extension_unit_descriptor(ctx, item, form, &list);
 
-  for(p = 0; p < bNrSources; p++)
-      sources[p] = (uint8_t) va_arg(va, uint32_t);
+  va_end(again);
   va_end(va);
-
-  return usbdescbldr_make_extension_unit_descriptor_fixed(ctx, item, form, sources, bNrSources);
+  return rc;
 }
 
 // UVC Class-Specific VC interrupt endpoint:
@@ -1399,7 +2446,6 @@ usbdescbldr_make_vc_interrupt_ep(usbdescbldr_ctx_t *  ctx,
 {
   USB_VC_CS_INTR_EP_DESCRIPTOR * dest;
   size_t needs;
-  uint16_t t16;
 
   if(ctx == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -1408,7 +2454,7 @@ usbdescbldr_make_vc_interrupt_ep(usbdescbldr_ctx_t *  ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (USB_VC_CS_INTR_EP_DESCRIPTOR *) ctx->append;
@@ -1418,17 +2464,16 @@ usbdescbldr_make_vc_interrupt_ep(usbdescbldr_ctx_t *  ctx,
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_ENDPOINT;
     dest->header.bDescriptorSubtype = USB_VC_SUBTYPE_EP_INTERRUPT;
 
-    t16 = ctx->fHostToLittleShort(wMaxTransferSize);
-    memcpy(&dest->wMaxTransferSize, &t16, sizeof(dest->wMaxTransferSize));
+    usbdescbldr_put_le16(&dest->wMaxTransferSize, wMaxTransferSize);
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VC_INTERRUPT_EP);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, &wMaxTransferSize, NULL, 0);
 
   return USBDESCBLDR_OK;
 }
@@ -1437,35 +2482,27 @@ usbdescbldr_make_vc_interrupt_ep(usbdescbldr_ctx_t *  ctx,
 
 // UVC Video Stream Interface Input Header
 
-usbdescbldr_status_t
-usbdescbldr_make_vs_interface_header_fixed(usbdescbldr_ctx_t *  ctx,
-                                           usbdescbldr_item_t * item,
-                                           const usbdescbldr_vs_if_input_header_short_form_t * form,
-                                           const uint8_t *      bmaControls,
-                                           size_t               bmaControlsLength)
+static usbdescbldr_status_t
+_make_vs_interface_header(usbdescbldr_ctx_t *  ctx,
+                          usbdescbldr_item_t * item,
+                          const usbdescbldr_vs_if_input_header_short_form_t * form,
+                          _list_t *            bmaControls)
 {
   USB_UVC_VS_INPUT_HEADER_DESCRIPTOR * dest = NULL;
-  size_t needs;
+  size_t               needs;
+  usbdescbldr_status_t rc;
 
   if(item == NULL || form == NULL)
     return USBDESCBLDR_INVALID;
 
-  if (bmaControlsLength > 0xff)
-    return USBDESCBLDR_TOO_MANY;
-
-  needs = sizeof(*dest);                               // Prefix of fixed-size fields
-  needs += sizeof(*bmaControls) * bmaControlsLength;   // bmaControls
-
-  if(needs > 0xff)
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+  rc = _list_put(ctx, bmaControls, sizeof(*dest), 0, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
-      return USBDESCBLDR_NO_SPACE;
-
     dest = (USB_UVC_VS_INPUT_HEADER_DESCRIPTOR *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
@@ -1473,7 +2510,7 @@ usbdescbldr_make_vs_interface_header_fixed(usbdescbldr_ctx_t *  ctx,
 
     // There are Controls for each format, and (as of UVC 1.5) the
     // control size is 1 -- but it is variable and may change in the future.
-    dest->bNumFormats = bmaControlsLength;
+    dest->bNumFormats = bmaControls->length;
     dest->bEndpointAddress = form->bEndpointAddress;
     dest->bmInfo = form->bmInfo;
     dest->bTerminalLink = form->bTerminalLink;
@@ -1481,88 +2518,83 @@ usbdescbldr_make_vs_interface_header_fixed(usbdescbldr_ctx_t *  ctx,
     dest->bTriggerSupport = form->bTriggerSupport;
     dest->bTriggerUsage = form->bTriggerUsage;
     dest->bControlSize = sizeof(uint8_t); // Not very general, but standardized (for now)
-
-    memcpy((void *) (dest + 1), bmaControls, sizeof(bmaControls) * bmaControlsLength);
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VS_INPUT_HEADER);
   item->size = needs;
-  item->address = ctx->append;
-  item->totalSize = (uint8_t *) &dest->wTotalLength;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, form, bmaControls);
 
   return USBDESCBLDR_OK;
 }
 
+
+usbdescbldr_status_t
+usbdescbldr_make_vs_interface_header_fixed(usbdescbldr_ctx_t *  ctx,
+                                           usbdescbldr_item_t * item,
+                                           const usbdescbldr_vs_if_input_header_short_form_t * form,
+                                           const uint8_t *      bmaControls,
+                                           size_t               bmaControlsLength)
+{
+  _list_t list;
+
+  if (bmaControlsLength > 0xff)
+    return USBDESCBLDR_TOO_MANY;
+
+  _list_array(&list, bmaControls, bmaControlsLength, sizeof(*bmaControls));
+  return _make_vs_interface_header(ctx, item, form, &list);
+}
+
 usbdescbldr_status_t
 usbdescbldr_make_vs_interface_header(usbdescbldr_ctx_t *  ctx,
                                      usbdescbldr_item_t * item,
                                      const usbdescbldr_vs_if_input_header_short_form_t * form,
                                      ...) // Varying: terminated by USBDESCBLDR_LIST_END
 {
-  uint8_t   bNumFormats;      // Number of formats (controls)
-  va_list   va, va_count;
-  size_t    f;
-  uint8_t   formatIndex[USBDESCBLDR_PARAM_MAX];
-
-  if(item == NULL || form == NULL)
-    return USBDESCBLDR_INVALID;
-
-  // Determine the final length
-  va_start(va_count, form);
-  va_copy(va, va_count);
-
-  for(bNumFormats = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; bNumFormats++)
-    // COULD range-check each source to be a byte value here
-    ;
-  va_end(va_count);
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  if (bNumFormats > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
+  va_start(va, form);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint8_t));
 
-  for(f = 0; f < bNumFormats; f++)
-    formatIndex[f] = (uint8_t) va_arg(va, uint32_t);
+  rc = _make_vs_interface_header(ctx, item, form, &list);
 
+  va_end(again);
   va_end(va);
-
-  return usbdescbldr_make_vs_interface_header_fixed(ctx, item, form, formatIndex, bNumFormats);
+  return rc;
 }
 
 
 // UVC Video Stream Interface Output Header
 
-usbdescbldr_status_t
-usbdescbldr_make_uvc_vs_if_output_header_fixed(usbdescbldr_ctx_t *  ctx,
-                                               usbdescbldr_item_t * item,
-                                               const usbdescbldr_vs_if_output_header_short_form_t * form,
-                                               const uint8_t *      bmaControls,
-                                               size_t               bmaControlsLength)
+static usbdescbldr_status_t
+_make_uvc_vs_if_output_header(usbdescbldr_ctx_t *  ctx,
+                              usbdescbldr_item_t * item,
+                              const usbdescbldr_vs_if_output_header_short_form_t * form,
+                              _list_t *            bmaControls)
 {
   USB_UVC_VS_OUTPUT_HEADER_DESCRIPTOR * dest;
-  size_t    needs;
-  uint8_t * drop;             // Place to drop next built member
+  size_t               needs;
+  usbdescbldr_status_t rc;
 
   if(item == NULL || form == NULL)
     return USBDESCBLDR_INVALID;
 
-  needs = sizeof(*dest);                               // Prefix of fixed-size fields
-  needs += sizeof(*bmaControls) * bmaControlsLength;   // bmaControls
-
-  if(needs > 0xff)
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+  // Tack on the Controls. These are 8-bit values (upcast to int32s, if passed
+  // as arguments), stored as bytes.
+  rc = _list_put(ctx, bmaControls, sizeof(*dest), 0, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
-      return USBDESCBLDR_NO_SPACE;
-
     dest = (USB_UVC_VS_OUTPUT_HEADER_DESCRIPTOR *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
@@ -1572,55 +2604,53 @@ usbdescbldr_make_uvc_vs_if_output_header_fixed(usbdescbldr_ctx_t *  ctx,
     dest->bEndpointAddress = form->bEndpointAddress;
     dest->bTerminalLink = form->bTerminalLink;
     dest->bControlSize = sizeof(uint8_t); // Not very general, but standardized (for now)
-
-    drop = (uint8_t *) (dest + 1); // Beginning of bmaControls
-
-    // Tack on the Controls. These are 8-bit values, but were upcast to int32s by the call
-    memcpy((void *) (dest + 1), bmaControls, sizeof(*bmaControls) * bmaControlsLength);
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VS_OUTPUT_HEADER);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, form, bmaControls);
 
   return USBDESCBLDR_OK;
 }
 
 
+usbdescbldr_status_t
+usbdescbldr_make_uvc_vs_if_output_header_fixed(usbdescbldr_ctx_t *  ctx,
+                                               usbdescbldr_item_t * item,
+                                               const usbdescbldr_vs_if_output_header_short_form_t * form,
+                                               const uint8_t *      bmaControls,
+                                               size_t               bmaControlsLength)
+{
+  _list_t list;
+
+  _list_array(&list, bmaControls, bmaControlsLength, sizeof(*bmaControls));
+  return _make_uvc_vs_if_output_header(ctx, item, form, &list);
+}
+
+
 usbdescbldr_status_t
 usbdescbldr_make_uvc_vs_if_output_header(usbdescbldr_ctx_t * ctx,
                                          usbdescbldr_item_t * item,
                                          const usbdescbldr_vs_if_output_header_short_form_t * form,
                                          ...) // Varying: bmaControls (which are passed as int32s), terminated by USBDESCBLDR_LIST_END
 {
-  uint8_t   bNumFormats;      // Number of formats (controls)
-  va_list   va, va_count;
-  uint8_t   formats[USBDESCBLDR_PARAM_MAX];
-  size_t    f;
-
-  // Build the fixed array of parameters
-  va_start(va_count, form);
-  va_copy(va, va_count);
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  for(bNumFormats = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; bNumFormats++)
-    ;
-  va_end(va_count);
-
-  if(bNumFormats > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;            // .. as opposed to NO SPACE ..
-  }
+  va_start(va, form);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint8_t));
 
-  // Tack on the Controls. These are 8-bit values, but were upcast to int32s by the call
-  //TODO: that provokes sign extension. Deal with that
-  for(f = 0; f < bNumFormats; f++)
-    formats[f] = (uint8_t) va_arg(va, uint32_t);
+  rc = _make_uvc_vs_if_output_header(ctx, item, form, &list);
 
-  return usbdescbldr_make_uvc_vs_if_output_header_fixed(ctx, item, form, formats, bNumFormats);
+  va_end(again);
+  va_end(va);
+  return rc;
 }
 
 
@@ -1634,7 +2664,6 @@ usbdescbldr_make_uvc_vs_format_frame(usbdescbldr_ctx_t * ctx,
 {
   UVC_VS_FORMAT_FRAME_DESCRIPTOR * dest;
   size_t needs;
-  USB_GUID tGUID;
 
   if(ctx == NULL || form == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -1643,7 +2672,7 @@ usbdescbldr_make_uvc_vs_format_frame(usbdescbldr_ctx_t * ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (UVC_VS_FORMAT_FRAME_DESCRIPTOR *) ctx->append;
@@ -1656,11 +2685,10 @@ usbdescbldr_make_uvc_vs_format_frame(usbdescbldr_ctx_t * ctx,
     dest->bFormatIndex = form->bFormatIndex;
     dest->bNumFrameDescriptors = form->bNumFrameDescriptors;
 
-    tGUID.dwData1 = ctx->fHostToLittleInt(form->guidFormat.dwData1);
-    tGUID.dwData2 = ctx->fHostToLittleShort(form->guidFormat.dwData2);
-    tGUID.dwData3 = ctx->fHostToLittleShort(form->guidFormat.dwData3);
-    memcpy(&tGUID.dwData4, form->guidFormat.dwData4, sizeof(tGUID.dwData4));
-    memcpy(&dest->guidFormat, &tGUID, sizeof(dest->guidFormat));
+    usbdescbldr_put_le32(&dest->guidFormat.dwData1, form->guidFormat.dwData1);
+    usbdescbldr_put_le16(&dest->guidFormat.dwData2, form->guidFormat.dwData2);
+    usbdescbldr_put_le16(&dest->guidFormat.dwData3, form->guidFormat.dwData3);
+    memcpy(dest->guidFormat.dwData4, form->guidFormat.dwData4, sizeof(dest->guidFormat.dwData4));
 
     dest->bBitsPerPixel = form->bBitsPerPixel;
     dest->bDefaultFrameIndex = form->bDefaultFrameIndex;
@@ -1671,12 +2699,12 @@ usbdescbldr_make_uvc_vs_format_frame(usbdescbldr_ctx_t * ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 
@@ -1691,7 +2719,6 @@ usbdescbldr_make_uvc_vs_format_uncompressed(usbdescbldr_ctx_t * ctx,
 {
   UVC_VS_FORMAT_UNCOMPRESSED_DESCRIPTOR * dest;
   size_t needs;
-  USB_GUID tGUID;
 
   if(ctx == NULL || form == NULL || item == NULL)
     return USBDESCBLDR_INVALID;
@@ -1700,7 +2727,7 @@ usbdescbldr_make_uvc_vs_format_uncompressed(usbdescbldr_ctx_t * ctx,
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx))
+    if(!_reserve(ctx, needs))
       return USBDESCBLDR_NO_SPACE;
 
     dest = (UVC_VS_FORMAT_UNCOMPRESSED_DESCRIPTOR *) ctx->append;
@@ -1713,11 +2740,10 @@ usbdescbldr_make_uvc_vs_format_uncompressed(usbdescbldr_ctx_t * ctx,
     dest->bFormatIndex = form->bFormatIndex;
     dest->bNumFrameDescriptors = form->bNumFrameDescriptors;
 
-    tGUID.dwData1 = ctx->fHostToLittleInt(form->guidFormat.dwData1);
-    tGUID.dwData2 = ctx->fHostToLittleShort(form->guidFormat.dwData2);
-    tGUID.dwData3 = ctx->fHostToLittleShort(form->guidFormat.dwData3);
-    memcpy(&tGUID.dwData4, form->guidFormat.dwData4, sizeof(tGUID.dwData4));
-    memcpy(&dest->guidFormat, &tGUID, sizeof(dest->guidFormat));
+    usbdescbldr_put_le32(&dest->guidFormat.dwData1, form->guidFormat.dwData1);
+    usbdescbldr_put_le16(&dest->guidFormat.dwData2, form->guidFormat.dwData2);
+    usbdescbldr_put_le16(&dest->guidFormat.dwData3, form->guidFormat.dwData3);
+    memcpy(dest->guidFormat.dwData4, form->guidFormat.dwData4, sizeof(dest->guidFormat.dwData4));
 
     dest->bBitsPerPixel = form->bBitsPerPixel;
     dest->bDefaultFrameIndex = form->bDefaultFrameIndex;
@@ -1728,12 +2754,12 @@ usbdescbldr_make_uvc_vs_format_uncompressed(usbdescbldr_ctx_t * ctx,
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record(ctx, item, form, NULL, 0);
 
   return USBDESCBLDR_OK;
 
@@ -1743,50 +2769,41 @@ usbdescbldr_make_uvc_vs_format_uncompressed(usbdescbldr_ctx_t * ctx,
 
 // Frame Descriptors
 
-usbdescbldr_status_t
-usbdescbldr_make_uvc_vs_frame_frame_fixed(usbdescbldr_ctx_t *  ctx,
-                                          usbdescbldr_item_t * item,
-                                          const usbdescbldr_uvc_vs_frame_frame_based_short_form_t * form,
-                                          const uint32_t *     dwIntervals,
-                                          size_t               dwIntervalsLength)
+// The frame intervals follow the fixed-size fields: base, granularity and
+// max for a continuous range, or else each possible setting.
+static size_t
+_interval_count(uint8_t bFrameIntervalType)
+{
+  return bFrameIntervalType == 0 ? 3 : bFrameIntervalType;
+}
+
+
+static usbdescbldr_status_t
+_make_uvc_vs_frame_frame(usbdescbldr_ctx_t *  ctx,
+                         usbdescbldr_item_t * item,
+                         const usbdescbldr_uvc_vs_frame_frame_based_short_form_t * form,
+                         _list_t *            dwIntervals)
 {
   UVC_VS_FRAME_FRAME_DESCRIPTOR * dest;
-  size_t needs;
-  uint8_t * drop;             // Place to drop next built member
-  uint16_t t16;
-  uint32_t t32;
-  uint32_t i;
-  uint8_t   intervalsParams;
+  size_t               needs;
+  usbdescbldr_status_t rc;
 
   if(item == NULL || form == NULL)
     return USBDESCBLDR_INVALID;
 
-  // Determine the final length
-  if(form->bFrameIntervalType == 0) {
-    // Continuous: expect base, granularity, max.
-    intervalsParams = 3;
-  } else {
-    // Discrete: caller passes each possible setting.
-    intervalsParams = form->bFrameIntervalType;
-  }
+  // Need to swap the intervals, as they aren't bytes
+  rc = _list_put(ctx, dwIntervals, sizeof(*dest), 0, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
-  if (intervalsParams != dwIntervalsLength)
+  // These need to agree:
+  if(dwIntervals->length != _interval_count(form->bFrameIntervalType))
     return USBDESCBLDR_INVALID;
 
-  needs = sizeof(*dest);                             // Prefix of fixed-size fields
-  needs += sizeof(*dwIntervals) * intervalsParams;   // intervals
-  if(needs > 0xff) {
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
-  }
-
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx)) {
-      return USBDESCBLDR_NO_SPACE;
-    }
-
     dest = (UVC_VS_FRAME_FRAME_DESCRIPTOR *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
@@ -1795,124 +2812,97 @@ usbdescbldr_make_uvc_vs_frame_frame_fixed(usbdescbldr_ctx_t *  ctx,
     dest->bFrameIndex = form->bFrameIndex;
     dest->bmCapabilities = form->bmCapabilities;
 
-    t16 = ctx->fHostToLittleShort(form->wHeight);
-    memcpy(&dest->wHeight, &t16, sizeof(dest->wHeight));
+    usbdescbldr_put_le16(&dest->wHeight, form->wHeight);
 
-    t16 = ctx->fHostToLittleShort(form->wWidth);
-    memcpy(&dest->wWidth, &t16, sizeof(dest->wWidth));
+    usbdescbldr_put_le16(&dest->wWidth, form->wWidth);
 
-    t32 = ctx->fHostToLittleInt(form->dwMinBitRate);
-    memcpy(&dest->dwMinBitRate, &t32, sizeof(dest->dwMinBitRate));
+    usbdescbldr_put_le32(&dest->dwMinBitRate, form->dwMinBitRate);
 
-    t32 = ctx->fHostToLittleInt(form->dwMaxBitRate);
-    memcpy(&dest->dwMaxBitRate, &t32, sizeof(dest->dwMaxBitRate));
+    usbdescbldr_put_le32(&dest->dwMaxBitRate, form->dwMaxBitRate);
 
-    t32 = ctx->fHostToLittleInt(form->dwDefaultFrameInterval);
-    memcpy(&dest->dwDefaultFrameInterval, &t32, sizeof(dest->dwDefaultFrameInterval));
+    usbdescbldr_put_le32(&dest->dwDefaultFrameInterval, form->dwDefaultFrameInterval);
 
-    t32 = ctx->fHostToLittleInt(form->dwBytesPerLine);
-    memcpy(&dest->dwBytesPerLine, &t32, sizeof(dest->dwBytesPerLine));
+    usbdescbldr_put_le32(&dest->dwBytesPerLine, form->dwBytesPerLine);
 
     dest->bFrameIntervalType = form->bFrameIntervalType;
-
-    // Need to swap the intervals, as they aren't bytes
-    drop = (uint8_t *) (dest + 1); // Beginning of interval table
-    for (i = 0; i < intervalsParams; i++) {
-      t32 = ctx->fHostToLittleInt(dwIntervals[i]);
-      memcpy(drop, &t32, sizeof(t32));
-      drop += sizeof(t32);
-    }
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VS_FRAME_FRAME_BASED);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, form, dwIntervals);
 
   return USBDESCBLDR_OK;
 }
 
+
+usbdescbldr_status_t
+usbdescbldr_make_uvc_vs_frame_frame_fixed(usbdescbldr_ctx_t *  ctx,
+                                          usbdescbldr_item_t * item,
+                                          const usbdescbldr_uvc_vs_frame_frame_based_short_form_t * form,
+                                          const uint32_t *     dwIntervals,
+                                          size_t               dwIntervalsLength)
+{
+  _list_t list;
+
+  if(form != NULL && _interval_count(form->bFrameIntervalType) != dwIntervalsLength)
+    return USBDESCBLDR_INVALID;
+
+  _list_array(&list, dwIntervals, dwIntervalsLength, sizeof(*dwIntervals));
+  return _make_uvc_vs_frame_frame(ctx, item, form, &list);
+}
+
 usbdescbldr_status_t
 usbdescbldr_make_uvc_vs_frame_frame(usbdescbldr_ctx_t *  ctx,
                                     usbdescbldr_item_t * item,
                                     const usbdescbldr_uvc_vs_frame_frame_based_short_form_t * form,
                                     ... /* interval data */)
 {
-  uint8_t   numIntervals;
-  va_list   va, va_count;
-  uint32_t  intervals[USBDESCBLDR_PARAM_MAX];
-  size_t    i;
-
-  // Determine the final length
-  va_start(va_count, form);
-  va_copy(va, va_count);
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  for(numIntervals = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; numIntervals++)
-    ;
-  va_end(va_count);
+  va_start(va, form);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint32_t));
 
-  if (numIntervals > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
+  rc = _make_uvc_vs_frame_frame(ctx, item, form, &list);
 
-  for(i = 0; i < numIntervals; i++)
-    intervals[i] = va_arg(va, uint32_t);
+  va_end(again);
   va_end(va);
-
-  return usbdescbldr_make_uvc_vs_frame_frame_fixed(ctx, item, form, intervals, numIntervals);
+  return rc;
 }
 
 
 
-usbdescbldr_status_t
-usbdescbldr_make_uvc_vs_frame_uncompressed_fixed(usbdescbldr_ctx_t *  ctx,
-                                                 usbdescbldr_item_t * item,
-                                                 const usbdescbldr_uvc_vs_frame_uncompressed_short_form_t * form,
-                                                 const  uint32_t *    dwIntervals,
-                                                 size_t               dwIntervalsLength)
+static usbdescbldr_status_t
+_make_uvc_vs_frame_uncompressed(usbdescbldr_ctx_t *  ctx,
+                                usbdescbldr_item_t * item,
+                                const usbdescbldr_uvc_vs_frame_uncompressed_short_form_t * form,
+                                _list_t *            dwIntervals)
 {
   UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR * dest = NULL;
-  uint8_t   intervalsParams;
-  uint16_t  t16;
-  uint32_t  t32;
-  size_t    needs;
-  size_t    i;
-  uint8_t * drop;
+  size_t               needs;
+  usbdescbldr_status_t rc;
 
   if(item == NULL || form == NULL)
     return USBDESCBLDR_INVALID;
 
-  // Determine the final length
-  if(form->bFrameIntervalType == 0) {
-    // Continuous: expect base, granularity, max.
-    intervalsParams = 3;
-  }
-  else {
-    // Discrete: caller passes each possible setting. The type tells how many.
-    intervalsParams = form->bFrameIntervalType;
-  }
-
-  needs = sizeof(*dest);                        // Prefix of fixed-size fields
-  needs += sizeof(uint32_t) * intervalsParams;  // Add in the interval(s)
-  if(needs > 0xff)
-    return USBDESCBLDR_OVERSIZED;  // .. as opposed to NO SPACE ..
+  rc = _list_put(ctx, dwIntervals, sizeof(*dest), 0, &needs);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
 
   // These need to agree:
-  if (intervalsParams != dwIntervalsLength)
+  if(dwIntervals->length != _interval_count(form->bFrameIntervalType))
     return USBDESCBLDR_INVALID;
 
   // Construct
   if(ctx->buffer != NULL) {
-    if(needs > _bufferAvailable(ctx)) {
-      return USBDESCBLDR_NO_SPACE;
-    }
-
     dest = (UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR *) ctx->append;
-    memset(dest, 0, needs);
+    memset(dest, 0, sizeof(*dest));
 
     dest->header.bLength = needs;
     dest->header.bDescriptorType = USB_DESCRIPTOR_TYPE_VC_CS_INTERFACE;
@@ -1921,72 +2911,66 @@ usbdescbldr_make_uvc_vs_frame_uncompressed_fixed(usbdescbldr_ctx_t *  ctx,
     dest->bFrameIndex = form->bFrameIndex;
     dest->bmCapabilities = form->bmCapabilities;
 
-    t16 = ctx->fHostToLittleShort(form->wWidth);
-    memcpy(&dest->wWidth, &t16, sizeof(dest->wWidth));
+    usbdescbldr_put_le16(&dest->wWidth, form->wWidth);
 
-    t16 = ctx->fHostToLittleShort(form->wHeight);
-    memcpy(&dest->wHeight, &t16, sizeof(dest->wHeight));
+    usbdescbldr_put_le16(&dest->wHeight, form->wHeight);
 
-    t32 = ctx->fHostToLittleInt(form->dwMinBitRate);
-    memcpy(&dest->dwMinBitRate, &t32, sizeof(dest->dwMinBitRate));
+    usbdescbldr_put_le32(&dest->dwMinBitRate, form->dwMinBitRate);
 
-    t32 = ctx->fHostToLittleInt(form->dwMaxBitRate);
-    memcpy(&dest->dwMaxBitRate, &t32, sizeof(dest->dwMaxBitRate));
+    usbdescbldr_put_le32(&dest->dwMaxBitRate, form->dwMaxBitRate);
 
-    t32 = ctx->fHostToLittleInt(form->dwMaxVideoFrameBufferSize);
-    memcpy(&dest->dwMaxVideoFrameBufferSize, &t32, sizeof(dest->dwMaxVideoFrameBufferSize));
+    usbdescbldr_put_le32(&dest->dwMaxVideoFrameBufferSize, form->dwMaxVideoFrameBufferSize);
 
-    t32 = ctx->fHostToLittleInt(form->dwDefaultFrameInterval);
-    memcpy(&dest->dwDefaultFrameInterval, &t32, sizeof(dest->dwDefaultFrameInterval));
+    usbdescbldr_put_le32(&dest->dwDefaultFrameInterval, form->dwDefaultFrameInterval);
 
     dest->bFrameIntervalType = form->bFrameIntervalType;
-
-    drop = (uint8_t *) (dest + 1); // Beginning of interval table
-    for(i = 0; i < intervalsParams; i++) {
-      t32 = ctx->fHostToLittleInt(dwIntervals[i]);
-      memcpy(drop, &t32, sizeof(t32));
-      drop += sizeof(t32);
-    }
   }
 
   // Build the item 
-  _item_init(item);
+  _item_init(ctx, item, USBDESCBLDR_KIND_VS_FRAME_UNCOMPRESSED);
   item->size = needs;
-  item->address = ctx->append;
 
   // Consume buffer space (or just count, in dry run mode)
-  ctx->append += needs;
+  _advance(ctx, item, needs);
+  _record_list(ctx, item, form, dwIntervals);
 
   return USBDESCBLDR_OK;
 }
 
+
+usbdescbldr_status_t
+usbdescbldr_make_uvc_vs_frame_uncompressed_fixed(usbdescbldr_ctx_t *  ctx,
+                                                 usbdescbldr_item_t * item,
+                                                 const usbdescbldr_uvc_vs_frame_uncompressed_short_form_t * form,
+                                                 const  uint32_t *    dwIntervals,
+                                                 size_t               dwIntervalsLength)
+{
+  _list_t list;
+
+  if(form != NULL && _interval_count(form->bFrameIntervalType) != dwIntervalsLength)
+    return USBDESCBLDR_INVALID;
+
+  _list_array(&list, dwIntervals, dwIntervalsLength, sizeof(*dwIntervals));
+  return _make_uvc_vs_frame_uncompressed(ctx, item, form, &list);
+}
+
 usbdescbldr_status_t
 usbdescbldr_make_uvc_vs_frame_uncompressed(usbdescbldr_ctx_t * ctx,
                                            usbdescbldr_item_t * item,
                                            const usbdescbldr_uvc_vs_frame_uncompressed_short_form_t * form,
                                            ... /* interval data */)
 {
-  uint8_t   numIntervals;
-  va_list   va, va_count;
-  uint32_t  intervals[USBDESCBLDR_PARAM_MAX];
-  size_t    i;
-
-  // Determine the final length
-  va_start(va_count, form);
-  va_copy(va, va_count);
+  va_list              va, again;
+  _list_t              list;
+  usbdescbldr_status_t rc;
 
-  for(numIntervals = 0; va_arg(va_count, uint32_t) != USBDESCBLDR_LIST_END; numIntervals++)
-    ;
-  va_end(va_count);
+  va_start(va, form);
+  va_copy(again, va);
+  _list_args(&list, &va, &again, sizeof(uint32_t));
 
-  if (numIntervals > USBDESCBLDR_PARAM_MAX) {
-    va_end(va);
-    return USBDESCBLDR_TOO_MANY;
-  }
+  rc = _make_uvc_vs_frame_uncompressed(ctx, item, form, &list);
 
-  for(i = 0; i < numIntervals; i++)
-    intervals[i] = va_arg(va, uint32_t);
+  va_end(again);
   va_end(va);
-
-  return usbdescbldr_make_uvc_vs_frame_uncompressed_fixed(ctx, item, form, intervals, numIntervals);
+  return rc;
 }
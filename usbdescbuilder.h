@@ -17,11 +17,6 @@ extern "C" {
 #include <stdint.h>
 
 
-// TODO
-// -- Dry run mode won't work right now; the wTotalSize pointers in the items
-// all point to descriptor fields in the buffer. Remedy will be to shadow the total
-// lengths within the items themselves.
-
   // //////////////////////////////////////////////////////////////////
   // //////////////////////////////////////////////////////////////////
   // API
@@ -34,16 +29,102 @@ extern "C" {
 ///
 /// Callers should treat the context as 'read only'.
 
+/// Sessions may instead obtain (and grow) their own buffer through an
+/// allocator provided by the caller; see usbdescbldr_init_growable().
+/// Each function is passed the allocator's user pointer.
+typedef struct {
+  void * (*allocate)(void *user, size_t size);                               ///< New block, or NULL
+  void * (*grow)(void *user, void *block, size_t oldSize, size_t newSize);   ///< Larger block, contents kept; or NULL
+  void   (*release)(void *user, void *block);
+  void *   user;
+} usbdescbldr_allocator_t;
+
+struct usbdescbldr_item_s;
+
+/// One piece of the descriptors, under usbdescbldr_set_segments(): either
+/// bytes in the session's buffer, or bytes of the caller's, referenced
+/// where they lie. The descriptors are the pieces, in order.
+typedef struct {
+  const uint8_t * data;
+  size_t          length;
+} usbdescbldr_segment_t;
+
+/// One field worked out by usbdescbldr_close() (a total length, or a count
+/// of subordinates), under usbdescbldr_set_fixups(): where it lies in the
+/// descriptors, and what it holds (little-endian, of 1 or 2 bytes).
+typedef struct {
+  uint32_t offset;
+  uint16_t value;
+  uint8_t  size;
+} usbdescbldr_fixup_t;
+
+/// A flushing window session (see usbdescbldr_set_window_flush()) calls this
+/// each time its window is full, and once at close for what is left: the
+/// window holds the bytes of the descriptors from offset on. It returns a
+/// usbdescbldr_status_t (USBDESCBLDR_OK to go on).
+typedef int (*usbdescbldr_flush_t)(void *user, unsigned char *window, size_t offset, size_t length);
+
+/// A session being recorded (see usbdescrecipe.h) calls this after each
+/// successful maker call, with op the kind of item made, form the short form
+/// (or for makers which take scalars, their arguments), and list any array
+/// the maker was given. After each item given to usbdescbldr_add_children()
+/// is linked, op is USBDESCBLDR_RECORD_LINK, item the child, and form the parent.
+/// A string made from UTF-16LE has op USBDESCBLDR_RECORD_UTF16LE, and its
+/// bytes as list.
+/// A variadic maker's list may come in pieces: the first with the call,
+/// and the rest, in order, with op USBDESCBLDR_RECORD_MORE (and the same
+/// item and form).
+typedef void (*usbdescbldr_record_t)(void *                            recorder,
+                                     uint8_t                           op,
+                                     const struct usbdescbldr_item_s * item,
+                                     const void *                      form,
+                                     const void *                      list,
+                                     size_t                            listLength);
+
+#define USBDESCBLDR_RECORD_LINK      0x80
+#define USBDESCBLDR_RECORD_UTF16LE   0x81
+#define USBDESCBLDR_RECORD_MORE      0x82
+
 typedef struct usbdescbldr_ctx_s {
   unsigned char   initialized;  // Have we been initialized? 0: no.
 
   unsigned char * buffer;       // Start of user-provided buffer (if any)
   size_t          bufferSize;   // Length in bytes of any user-provided buffer
   unsigned char * append;       // Address in buffer for next addition (append)
+  size_t          length;       // Bytes made so far (counted in a dry run, too)
+  unsigned int    options;      // USBDESCBLDR_OPTION_... flags
+  usbdescbldr_allocator_t allocator;  // Source of the buffer, if the session owns it
 
   unsigned int    i_string;     // Next string index to be assigned
 
+  struct usbdescbldr_item_s * made;   // Most recently made item; each item links to the one before
+  uint64_t        fingerprint;  // Running hash, under USBDESCBLDR_OPTION_FINGERPRINT
+  usbdescbldr_record_t record;  // Told of each maker call and link, if set
+  void *          recorder;     // .. and given this
+
+  unsigned char * window;       // Where to copy the bytes of a window session, if this is one
+  size_t          windowOffset; // .. from this offset in the descriptors
+  size_t          windowLength; // .. for this many bytes
+  usbdescbldr_flush_t windowFlush;  // Hands on each full window, if the window moves on
+  void *          windowUser;   // .. given this
+  size_t          windowEnd;    // .. up to this offset
+  int             windowStatus; // .. and what it last returned, if not OK
+
+  usbdescbldr_fixup_t * fixups; // The fields close works out, if the session keeps a list of them
+  size_t          fixupCapacity;
+  size_t          fixupCount;
+
+  usbdescbldr_segment_t * segments;   // The pieces, if the session keeps a list of them
+  size_t          segmentCapacity;
+  size_t          segmentCount;
+
+  unsigned char * itemArena;    // Optional caller-provided storage for items
+  size_t          itemArenaSize;
+  size_t          itemArenaUsed;
+
   // Conversion functions for little-endian support across platforms.
+  // Kept for callers; the makers themselves store fields with the inline
+  // primitives of usbdescendian.h.
   uint16_t(*fLittleShortToHost)(uint16_t s);
   uint16_t(*fHostToLittleShort)(uint16_t s);
   unsigned int(*fLittleIntToHost)(unsigned int s);
@@ -60,6 +141,7 @@ typedef struct usbdescbldr_ctx_s {
     USBDESCBLDR_INVALID,          ///< Null ptr, duplicate, range error..
     USBDESCBLDR_OVERSIZED,        ///< Exceeds size limit
     USBDESCBLDR_TOO_MANY,         ///< Exceeds instance count limit
+    USBDESCBLDR_NOT_FOUND,        ///< No such descriptor
     // ...
   } usbdescbldr_status_t;
 
@@ -72,11 +154,30 @@ typedef struct usbdescbldr_ctx_s {
   // as a DWORD (uint32_t) value in a descriptor.
 
   /// API members which accept a variable number of arguments
-  /// typically will use this constant to terminate the list.
+  /// typically will use this constant to terminate the list. They
+  /// take as many as fit in the descriptor being made.
   /// API members which accept a variable number of pointers
   /// will use NULL to terminate their lists.
   static const uint32_t USBDESCBLDR_LIST_END = 0xee00eeef;
 
+  /// Options for usbdescbldr_set_options().
+  /// RELOCATABLE: items record only their offset within the buffer, and
+  /// their address members are left NULL. Use usbdescbldr_item_address()
+  /// to find a descriptor; the buffer may then be moved freely (see
+  /// usbdescbldr_rebase()).
+#define USBDESCBLDR_OPTION_RELOCATABLE   0x0001
+
+  /// FINGERPRINT: nothing is kept. Each descriptor is made in the buffer,
+  /// mixed into a running hash of the session, and then overwritten by the
+  /// next. The hierarchy given to usbdescbldr_add_children() is mixed in,
+  /// too. The buffer need only hold one descriptor
+  /// (USBDESCBLDR_FINGERPRINT_WINDOW bytes); see usbdescbldr_get_fingerprint().
+#define USBDESCBLDR_OPTION_FINGERPRINT   0x0002
+
+  /// The smallest buffer for a USBDESCBLDR_OPTION_FINGERPRINT session:
+  /// enough for any one descriptor, whose bLength is a byte.
+#define USBDESCBLDR_FINGERPRINT_WINDOW   256
+
 
   // ITEM
   // The 'handle' by which callers store the results of maker calls. Callers
@@ -84,8 +185,38 @@ typedef struct usbdescbldr_ctx_s {
   // never should they modify the contents.
 
   /// Items (the handles) contain a list of the items they enclose
-  /// (items tha contribute to their total length).
-#define USBDESCBLDR_MAX_CHILDREN 16
+  /// (items that contribute to their total length). The list is threaded
+  /// through the items themselves, so there is no limit to its length.
+
+  /// What sort of descriptor an item holds.
+  typedef enum {
+    USBDESCBLDR_KIND_NONE,
+    USBDESCBLDR_KIND_DEVICE,
+    USBDESCBLDR_KIND_DEVICE_QUALIFIER,
+    USBDESCBLDR_KIND_CONFIGURATION,
+    USBDESCBLDR_KIND_LANGUAGES,
+    USBDESCBLDR_KIND_STRING,
+    USBDESCBLDR_KIND_BOS,
+    USBDESCBLDR_KIND_DEVICE_CAPABILITY,
+    USBDESCBLDR_KIND_INTERFACE,
+    USBDESCBLDR_KIND_ENDPOINT,
+    USBDESCBLDR_KIND_SS_EP_COMPANION,
+    USBDESCBLDR_KIND_INTERFACE_ASSOCIATION,
+    USBDESCBLDR_KIND_VC_HEADER,
+    USBDESCBLDR_KIND_VC_CAMERA_TERMINAL,
+    USBDESCBLDR_KIND_VC_OUTPUT_TERMINAL,
+    USBDESCBLDR_KIND_VC_SELECTOR_UNIT,
+    USBDESCBLDR_KIND_VC_PROCESSING_UNIT,
+    USBDESCBLDR_KIND_VC_EXTENSION_UNIT,
+    USBDESCBLDR_KIND_VC_INTERRUPT_EP,
+    USBDESCBLDR_KIND_VS_INPUT_HEADER,
+    USBDESCBLDR_KIND_VS_OUTPUT_HEADER,
+    USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED,
+    USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED,
+    USBDESCBLDR_KIND_VS_FRAME_FRAME_BASED,
+    USBDESCBLDR_KIND_VS_FRAME_UNCOMPRESSED,
+    USBDESCBLDR_KIND_COUNT
+  } usbdescbldr_kind_t;
 
   /// Items are filled in as results from each of the API maker
   /// calls. They will be used after the maker calls have been
@@ -93,14 +224,21 @@ typedef struct usbdescbldr_ctx_s {
   /// of layered descriptors, and to access the binary results
   /// for each descriptor.
   /// 
-  /// Callers should treat items as 'read only'.
+  /// Callers should treat items as 'read only', and should not
+  /// reuse an item for another maker call within the same session.
   typedef struct usbdescbldr_item_s {
-    void *                      address;        ///< Where it is stored
+    void *                      address;        ///< Where it is stored (NULL in dry run, or if relocatable)
+    struct usbdescbldr_item_s * parent;         ///< The item this one was made subordinate to, if any
+    struct usbdescbldr_item_s * first;          ///< First sub-item ('child')
+    struct usbdescbldr_item_s * last;           ///< Last sub-item
+    struct usbdescbldr_item_s * next;           ///< Next sub-item of the same parent
+    struct usbdescbldr_item_s * made;           ///< The item made just before this one
+    uint32_t                    offset;         ///< Where it is stored, relative to the start of the buffer
     unsigned int                index;          ///< Index, interface number, endpoint number, anything of this nature
     uint16_t                    size;           ///< Size of item itself
-    uint8_t *                   totalSize;      ///< Unaligned uint16_t *; Size of item and all children, or NULL if not kept
-    unsigned int                items;          ///< Number of sub-items ('children')
-    struct usbdescbldr_item_s * item[USBDESCBLDR_MAX_CHILDREN];
+    uint16_t                    total;          ///< Size of item and all children (once closed)
+    uint16_t                    items;          ///< Number of sub-items ('children')
+    uint8_t                     kind;           ///< A usbdescbldr_kind_t
   } usbdescbldr_item_t;
 
  // The standard GUID:
@@ -125,21 +263,236 @@ typedef struct usbdescbldr_ctx_s {
   /// will simply use the items to try and come up with a scaffolding of
   /// the final results, which may provide sanity checking and sizes.
   ///\param [in] bufferSize The size in bytes of the buffer.
+  ///
+  /// To size a buffer exactly: init with a NULL buffer, make everything,
+  /// add the children, close, and ask usbdescbldr_get_size(). Then
+  /// allocate that many bytes, init again with the buffer, and repeat the
+  /// same calls to fill it.
   usbdescbldr_status_t
   usbdescbldr_init(usbdescbldr_ctx_t * 	ctx,
                    unsigned char *		buffer,
                    size_t            	bufferSize);
 
+  /// Size of the first buffer obtained by usbdescbldr_init_growable(),
+  /// when the caller has no better idea.
+#define USBDESCBLDR_GROWABLE_INITIAL_SIZE   256
+
+  /// Reset internal state and begin a new descriptor, in a buffer which
+  /// the session obtains from the allocator and grows whenever a maker
+  /// call needs more room. Makers then never fail with USBDESCBLDR_NO_SPACE
+  /// unless the allocator does. The buffer may move as it grows; item
+  /// addresses are kept up to date (or use USBDESCBLDR_OPTION_RELOCATABLE).
+  /// The buffer is released by usbdescbldr_end(), unless the caller takes
+  /// it first with usbdescbldr_take_buffer().
+  ///\param [in] ctx A context to be initialized for the session.
+  ///\param [in] allocator The allocator; it is copied into the context.
+  ///\param [in] initialSize The size in bytes of the first buffer (0 for a default).
+  usbdescbldr_status_t
+  usbdescbldr_init_growable(usbdescbldr_ctx_t *             ctx,
+                            const usbdescbldr_allocator_t * allocator,
+                            size_t                          initialSize);
+
+  /// An allocator using the C library heap (malloc(), realloc(), free()).
+  extern const usbdescbldr_allocator_t usbdescbldr_heap_allocator;
+
   /// Commit (complete/finish) the build session in progress.
+  /// This is where layering happens: total lengths (wTotalLength) and
+  /// counts of subordinates (bNumInterfaces, bNumFormats, bNumFrameDescriptors,
+  /// bNumDeviceCaps) are computed for every item and written to its descriptor.
+  /// Counts given in short forms are kept for items given no such subordinates.
+  ///\param [in] ctx The context for the session.
   usbdescbldr_status_t
     usbdescbldr_close(usbdescbldr_ctx_t * ctx);
 
+  /// Report the number of bytes made so far. After a dry run, this is
+  /// exactly the buffer size required to make the same descriptors for real.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] size The number of bytes.
+  usbdescbldr_status_t
+    usbdescbldr_get_size(const usbdescbldr_ctx_t * ctx,
+                         size_t *                  size);
+
+  /// Report the hash of a USBDESCBLDR_OPTION_FINGERPRINT session: of every
+  /// descriptor made, in order, and of the hierarchy. Sessions making the
+  /// same calls with the same short forms have the same fingerprint.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] fingerprint The hash.
+  usbdescbldr_status_t
+    usbdescbldr_get_fingerprint(const usbdescbldr_ctx_t * ctx,
+                                uint64_t *                fingerprint);
+
+  /// Take ownership of a growable session's buffer. The caller must
+  /// release it (with the same allocator); the session no longer has a buffer.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] buffer The buffer.
+  ///\param [out] length The number of bytes made in it.
+  usbdescbldr_status_t
+    usbdescbldr_take_buffer(usbdescbldr_ctx_t * ctx,
+                            unsigned char **    buffer,
+                            size_t *            length);
+
   /// Terminate use of the builder. Release any resources.
   /// Once this is complete, the API requires an _init() before
   /// anything will perform again.
   usbdescbldr_status_t
     usbdescbldr_end(usbdescbldr_ctx_t * ctx);
 
+  /// Choose options for the session (USBDESCBLDR_OPTION_...). Call this
+  /// after usbdescbldr_init() and before any maker calls.
+  ///\param [in] ctx The context for the session.
+  ///\param [in] options The options, ORed together.
+  usbdescbldr_status_t
+    usbdescbldr_set_options(usbdescbldr_ctx_t * ctx,
+                            unsigned int        options);
+
+  /// Tell the session its buffer has moved. The caller copies the
+  /// contents (ctx->length bytes) to the new buffer; the session then
+  /// continues there. With USBDESCBLDR_OPTION_RELOCATABLE no item needs
+  /// to change; otherwise each item's address is updated.
+  ///\param [in] ctx The context for the session.
+  ///\param [in] buffer The new buffer, already holding the descriptors.
+  ///\param [in] bufferSize The size in bytes of the new buffer.
+  usbdescbldr_status_t
+    usbdescbldr_rebase(usbdescbldr_ctx_t * ctx,
+                       unsigned char *     buffer,
+                       size_t              bufferSize);
+
+  /// Make the session a window session: each descriptor is made in the
+  /// buffer and then overwritten by the next, as under
+  /// USBDESCBLDR_OPTION_FINGERPRINT, and only those of its bytes which fall
+  /// in [offset, offset + length) of the whole are kept, copied to the
+  /// window. usbdescbldr_close() patches lengths and counts there, too.
+  /// The buffer need only hold one descriptor (USBDESCBLDR_FINGERPRINT_WINDOW
+  /// bytes). Call this after usbdescbldr_init() and before any maker calls.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] window Where to copy the bytes.
+  ///\param [in] offset The offset of the first byte wanted.
+  ///\param [in] length The number of bytes wanted.
+  usbdescbldr_status_t
+    usbdescbldr_set_window(usbdescbldr_ctx_t * ctx,
+                           unsigned char *     window,
+                           size_t              offset,
+                           size_t              length);
+
+  /// Make a window session move its window on: each time it is full, it
+  /// is handed to flush, and then holds the next bytes, so that a run of
+  /// the descriptors of any length (to end) is made in one pass, a window at
+  /// a time; usbdescbldr_close() flushes what is left. Such a session keeps
+  /// no hierarchy, and works nothing out at close: usbdescbldr_add_children()
+  /// (given the context) does nothing, and usbdescbldr_item_alloc() hands
+  /// out the same item each time, so an arena of one will do. The lengths
+  /// and counts close would store are the caller's to put in, in flush
+  /// (from the fixups of an earlier dry run, say; see usbdescbldr_set_fixups()).
+  /// A status other than USBDESCBLDR_OK from flush ends the flushing, and
+  /// is returned by usbdescbldr_close(). Call this after usbdescbldr_set_window().
+  ///\param [in] ctx The context for the session.
+  ///\param [in] flush Takes each full window.
+  ///\param [in] user Passed to flush.
+  ///\param [in] end The offset past the last byte wanted.
+  usbdescbldr_status_t
+    usbdescbldr_set_window_flush(usbdescbldr_ctx_t * ctx,
+                                 usbdescbldr_flush_t flush,
+                                 void *              user,
+                                 size_t              end);
+
+  /// Keep a list of the fields usbdescbldr_close() works out: the total
+  /// length and count of subordinates of each container, where they lie in
+  /// the descriptors. This works in a dry run, too, so that a session which
+  /// keeps nothing else (see usbdescbldr_set_window_flush()) can put them in
+  /// later. Close returns USBDESCBLDR_NO_SPACE if there are more than fit.
+  /// Call this after usbdescbldr_init() and before usbdescbldr_close().
+  ///\param [in] ctx The context for the session.
+  ///\param [out] fixups Storage for the list.
+  ///\param [in] fixupCapacity The number of fields there is storage for.
+  usbdescbldr_status_t
+    usbdescbldr_set_fixups(usbdescbldr_ctx_t *   ctx,
+                           usbdescbldr_fixup_t * fixups,
+                           size_t                fixupCapacity);
+
+  /// Report the fields worked out at close.
+  ///\param [in] ctx The context for the session (closed).
+  ///\param [out] fixups The list.
+  ///\param [out] count The number of fields in it.
+  usbdescbldr_status_t
+    usbdescbldr_get_fixups(const usbdescbldr_ctx_t *    ctx,
+                           const usbdescbldr_fixup_t ** fixups,
+                           size_t *                     count);
+
+  /// Keep a list of the pieces of the descriptors, as they are made, so
+  /// that the bytes of the caller's which some makers are given need not
+  /// be copied: device capability payloads, and strings given in UTF-16LE,
+  /// are referenced where they lie, and only the rest (the headers) is made
+  /// in the buffer. Those bytes must then last as long as the descriptors
+  /// are used. Item offsets, sizes, and usbdescbldr_get_size() count all the
+  /// bytes, wherever they lie; usbdescbldr_slice_segments() finds the pieces
+  /// of any run of them, for a DMA engine to gather.
+  /// The session must have a buffer of the caller's, and neither of the
+  /// RELOCATABLE or FINGERPRINT options, nor a window. Call this after
+  /// usbdescbldr_init() and before any maker calls.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] segments Storage for the list.
+  ///\param [in] segmentCapacity The number of pieces there is storage for.
+  usbdescbldr_status_t
+    usbdescbldr_set_segments(usbdescbldr_ctx_t *     ctx,
+                             usbdescbldr_segment_t * segments,
+                             size_t                  segmentCapacity);
+
+  /// Report the pieces of the descriptors made so far.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] segments The list.
+  ///\param [out] count The number of pieces in it.
+  usbdescbldr_status_t
+    usbdescbldr_get_segments(const usbdescbldr_ctx_t *      ctx,
+                             const usbdescbldr_segment_t ** segments,
+                             size_t *                       count);
+
+  /// Find the pieces of one run of the descriptors (a reply to GET_DESCRIPTOR,
+  /// say): the first and last are cut to the run. A run reaching past the
+  /// end is cut short.
+  ///\param [in] segments The pieces of all the descriptors.
+  ///\param [in] count The number of them.
+  ///\param [in] offset The offset of the run.
+  ///\param [in] length The length of the run.
+  ///\param [out] slice The pieces of the run.
+  ///\param [in] sliceCapacity The number of pieces there is room for.
+  ///\param [out] sliceCount The number of pieces of the run.
+  usbdescbldr_status_t
+    usbdescbldr_slice_segments(const usbdescbldr_segment_t * segments,
+                               size_t                        count,
+                               size_t                        offset,
+                               size_t                        length,
+                               usbdescbldr_segment_t *       slice,
+                               size_t                        sliceCapacity,
+                               size_t *                      sliceCount);
+
+  /// Find an item's descriptor in the session's current buffer.
+  /// Returns NULL in a dry run, or a fingerprint or window session. With a
+  /// segment list, this is the part of it made in the buffer.
+  ///\param [in] ctx The context for the session.
+  ///\param [in] item The item.
+  void *
+    usbdescbldr_item_address(const usbdescbldr_ctx_t *  ctx,
+                             const usbdescbldr_item_t * item);
+
+  /// Provide storage from which items may be taken with usbdescbldr_item_alloc(),
+  /// rather than the caller declaring each one. The storage must outlive
+  /// the session's use of its items. Call this after usbdescbldr_init().
+  ///\param [in] ctx The context for the session.
+  ///\param [in] arena Storage for items.
+  ///\param [in] arenaSize The size in bytes of the storage.
+  usbdescbldr_status_t
+    usbdescbldr_set_item_arena(usbdescbldr_ctx_t * ctx,
+                               void *              arena,
+                               size_t              arenaSize);
+
+  /// Take an item from the arena given to usbdescbldr_set_item_arena().
+  /// The item is ready to be passed to a maker call.
+  ///\param [in] ctx The context for the session.
+  ///\param [out] item The new item.
+  usbdescbldr_status_t
+    usbdescbldr_item_alloc(usbdescbldr_ctx_t *   ctx,
+                           usbdescbldr_item_t ** item);
+
   // //////////////////////////////////////////////////////////////////
   // Constructions
 
@@ -148,7 +501,10 @@ typedef struct usbdescbldr_ctx_s {
   /// Pass the context, a result item, and the subordinate items.
   /// Terminate this list with NULL.
   /// This call can be used as many times as necessary (its effects
-  /// are cumulative).
+  /// are cumulative), and in any order; the lengths themselves are
+  /// computed by usbdescbldr_close(). An item may have only one parent,
+  /// and may not be given twice, or be given to one of its own
+  /// subordinates (USBDESCBLDR_INVALID, with nothing changed).
   ///\param [in] ctx The context for the session.
   ///\param [in] parent The item to accept new subordinates.
   ///\param [in] ... The items for the parent to accept, NULL-terminated.
@@ -170,6 +526,17 @@ typedef struct usbdescbldr_ctx_s {
                                  usbdescbldr_item_t * item,
                                  ...);
 
+  /// Create the language descriptor, from an array of language IDs.
+  ///\param [in] ctx The context for the session.
+  ///\param [in] item The item to receive the result.
+  ///\param [in] langIDs The language specifiers to be included in the descriptor.
+  ///\param [in] langIDsLength The number of them.
+  usbdescbldr_status_t
+    usbdescbldr_make_languageIDs_fixed(usbdescbldr_ctx_t *  ctx,
+                                       usbdescbldr_item_t * item,
+                                       const uint16_t *     langIDs,
+                                       size_t               langIDsLength);
+
   // //////////////////////////////////////////////////////////////////
   // Maker calls.
   //
@@ -246,7 +613,7 @@ typedef struct usbdescbldr_ctx_s {
   // //////////////////////////////////////////////////////////////////
 
   /// Define a new string and obtain its index. The string is passed as a flat C-style
-  /// ASCII string. Builder assigns string indices automatically, and so the result
+  /// UTF-8 string (see usbdescutf8.h). Builder assigns string indices automatically, and so the result
   /// is passed back to the caller through the (optional) out parameter index .
   /// (This is also stored in the item; should the caller wish to 'worry about it' later, it can be
   /// accessed there.)
@@ -254,13 +621,28 @@ typedef struct usbdescbldr_ctx_s {
   ///\param [in] item The result for the make.
   ///\param [out] index If non-NULL, the assigned string index will be returned here.
   ///\param [in] string The string to be stored in the descriptor.
-  // Pass the string in ASCII and NULL-terminated (a classic C string).
+  // Pass the string in UTF-8 and NULL-terminated (a classic C string).
   usbdescbldr_status_t
     usbdescbldr_make_string_descriptor(usbdescbldr_ctx_t *     ctx,
                                        usbdescbldr_item_t *    item,
                                        uint8_t *               index,    // OUT
                                        const char *            string);  // IN
 
+  /// Define a new string from UTF-16LE, as it is to appear in the descriptor,
+  /// and obtain its index. Under usbdescbldr_set_segments() the
+  /// characters are referenced, not copied.
+  ///\param [in] ctx The context for the session.
+  ///\param [in] item The result for the make.
+  ///\param [out] index If non-NULL, the assigned string index will be returned here.
+  ///\param [in] utf16le The characters, little-endian.
+  ///\param [in] utf16leSize The size of them in bytes (even).
+  usbdescbldr_status_t
+    usbdescbldr_make_string_descriptor_utf16le(usbdescbldr_ctx_t *  ctx,
+                                               usbdescbldr_item_t * item,
+                                               uint8_t *            index,
+                                               const uint8_t *      utf16le,
+                                               size_t               utf16leSize);
+
   // //////////////////////////////////////////////////////////////////
 
   /// Generate a Binary Object Store.
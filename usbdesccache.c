@@ -0,0 +1,270 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "usbdesccache.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// Each build is held in one block from the allocator: its items first
+// (so that they keep the alignment the allocator gives), then its buffer,
+// then its key.
+
+// Keys are hashed with 64-bit FNV-1a, as fingerprints are.
+#define USBDESCBLDR_CACHE_FNV_OFFSET    0xcbf29ce484222325ULL
+#define USBDESCBLDR_CACHE_FNV_PRIME     0x00000100000001b3ULL
+
+static uint64_t
+_hash(const void *key, size_t size)
+{
+  const uint8_t *bp = (const uint8_t *) key;
+  uint64_t       hash = USBDESCBLDR_CACHE_FNV_OFFSET;
+
+  while(size--) {
+    hash ^= *bp++;
+    hash *= USBDESCBLDR_CACHE_FNV_PRIME;
+  }
+
+  return hash;
+}
+
+
+static void
+_drop(usbdescbldr_cache_t *cache, usbdescbldr_cache_entry_t *entry)
+{
+  cache->allocator.release(cache->allocator.user, entry->items);
+  cache->bytesUsed -= entry->size;
+  memset(entry, 0, sizeof(*entry));
+}
+
+
+// Make room for a build of the given size, dropping the least recently
+// used builds as need be. Returns the slot to hold it.
+static usbdescbldr_cache_entry_t *
+_make_room(usbdescbldr_cache_t *cache, size_t size)
+{
+  usbdescbldr_cache_entry_t *vacant, *oldest;
+  size_t                     e;
+
+  for(;;) {
+    vacant = oldest = NULL;
+    for(e = 0; e < cache->capacity; e++) {
+      if(cache->entries[e].lastUsed == 0) {
+        if(vacant == NULL)
+          vacant = &cache->entries[e];
+      } else if(oldest == NULL || cache->entries[e].lastUsed < oldest->lastUsed) {
+        oldest = &cache->entries[e];
+      }
+    }
+
+    if(vacant != NULL && cache->bytesUsed + size <= cache->byteLimit)
+      return vacant;
+
+    if(oldest == NULL)
+      return NULL;
+
+    _drop(cache, oldest);
+    cache->evictions++;
+  }
+}
+
+
+// Run the caller's maker calls into a block, and close the session.
+// The block's layout must come out just as the dry run said.
+static usbdescbldr_status_t
+_make(usbdescbldr_cache_build_t   build,
+      void *                      user,
+      unsigned char *             block,
+      size_t                      itemBytes,
+      size_t                      length,
+      usbdescbldr_ctx_t *         ctx)
+{
+  usbdescbldr_item_t * ip;
+  usbdescbldr_status_t rc;
+
+  if((rc = usbdescbldr_init(ctx, block + itemBytes, length)) != USBDESCBLDR_OK)
+    return rc;
+  if((rc = usbdescbldr_set_item_arena(ctx, block, itemBytes)) != USBDESCBLDR_OK)
+    return rc;
+  if((rc = build(ctx, user)) != USBDESCBLDR_OK)
+    return rc;
+  if((rc = usbdescbldr_close(ctx)) != USBDESCBLDR_OK)
+    return rc;
+
+  if(ctx->length != length || ctx->itemArenaUsed != itemBytes)
+    return USBDESCBLDR_INVALID;
+
+  // Items from elsewhere would not outlive the call
+  for(ip = ctx->made; ip != NULL; ip = ip->made) {
+    if((unsigned char *) ip < block || (unsigned char *) ip >= block + itemBytes)
+      return USBDESCBLDR_INVALID;
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_cache_init(usbdescbldr_cache_t *           cache,
+                       usbdescbldr_cache_entry_t *     entries,
+                       size_t                          capacity,
+                       size_t                          byteLimit,
+                       const usbdescbldr_allocator_t * allocator,
+                       void *                          scratch,
+                       size_t                          scratchSize)
+{
+  if(cache == NULL || entries == NULL || capacity == 0 || allocator == NULL ||
+     allocator->allocate == NULL || allocator->release == NULL ||
+     (scratch == NULL && scratchSize != 0))
+    return USBDESCBLDR_INVALID;
+
+  memset(cache, 0, sizeof(*cache));
+  memset(entries, 0, capacity * sizeof(*entries));
+
+  cache->entries = entries;
+  cache->capacity = capacity;
+  cache->byteLimit = byteLimit;
+  cache->allocator = *allocator;
+  cache->scratch = (unsigned char *) scratch;
+  cache->scratchSize = scratchSize;
+
+  return USBDESCBLDR_OK;
+}
+
+
+// A hit costs a hash of the key, and a compare; a miss, a dry run and
+// one real build.
+
+usbdescbldr_status_t
+usbdescbldr_cache_build(usbdescbldr_cache_t *               cache,
+                        const void *                        key,
+                        size_t                              keySize,
+                        usbdescbldr_cache_build_t           build,
+                        void *                              user,
+                        const usbdescbldr_cache_entry_t **  entry)
+{
+  usbdescbldr_ctx_t          ctx;
+  usbdescbldr_cache_entry_t *ep;
+  usbdescbldr_status_t       rc;
+  unsigned char *            block;
+  uint64_t                   fingerprint;
+  size_t                     itemBytes, length, size, e;
+
+  if(cache == NULL || cache->entries == NULL || (key == NULL && keySize != 0) ||
+     build == NULL || entry == NULL)
+    return USBDESCBLDR_INVALID;
+
+  fingerprint = _hash(key, keySize);
+  cache->clock++;
+
+  for(e = 0; e < cache->capacity; e++) {
+    ep = &cache->entries[e];
+    if(ep->lastUsed != 0 && ep->fingerprint == fingerprint && ep->keySize == keySize &&
+       (keySize == 0 || memcmp(ep->key, key, keySize) == 0)) {
+      ep->lastUsed = cache->clock;
+      cache->hits++;
+      *entry = ep;
+      return USBDESCBLDR_OK;
+    }
+  }
+
+  cache->misses++;
+
+  // Size it
+  if((rc = usbdescbldr_init(&ctx, NULL, 0)) != USBDESCBLDR_OK ||
+     (rc = usbdescbldr_set_item_arena(&ctx, cache->scratch, cache->scratchSize)) != USBDESCBLDR_OK ||
+     (rc = build(&ctx, user)) != USBDESCBLDR_OK ||
+     (rc = usbdescbldr_close(&ctx)) != USBDESCBLDR_OK ||
+     (rc = usbdescbldr_get_size(&ctx, &length)) != USBDESCBLDR_OK) {
+    usbdescbldr_end(&ctx);
+    return rc;
+  }
+
+  itemBytes = ctx.itemArenaUsed;
+  usbdescbldr_end(&ctx);
+
+  // Make it for real, and keep it
+  if(itemBytes > cache->byteLimit || length > cache->byteLimit - itemBytes ||
+     keySize > cache->byteLimit - itemBytes - length)
+    return USBDESCBLDR_OVERSIZED;
+  size = itemBytes + length + keySize;
+
+  block = (unsigned char *) cache->allocator.allocate(cache->allocator.user, size);
+  if(block == NULL)
+    return USBDESCBLDR_NO_SPACE;
+
+  // Nothing is dropped for a build that fails
+  rc = _make(build, user, block, itemBytes, length, &ctx);
+  if(rc == USBDESCBLDR_OK && (ep = _make_room(cache, size)) == NULL)
+    rc = USBDESCBLDR_NO_SPACE;
+  if(rc != USBDESCBLDR_OK) {
+    usbdescbldr_end(&ctx);
+    cache->allocator.release(cache->allocator.user, block);
+    return rc;
+  }
+
+  if(keySize != 0)
+    memcpy(block + itemBytes + length, key, keySize);
+
+  ep->fingerprint = fingerprint;
+  ep->key = block + itemBytes + length;
+  ep->keySize = keySize;
+  ep->lastUsed = cache->clock;
+  ep->buffer = block + itemBytes;
+  ep->length = length;
+  ep->items = (usbdescbldr_item_t *) block;
+  ep->itemCount = itemBytes / sizeof(usbdescbldr_item_t);
+  ep->made = ctx.made;
+  ep->size = size;
+  cache->bytesUsed += ep->size;
+
+  // The session is done with; its buffer and items now belong to the entry.
+  memset(&ctx, 0, sizeof(ctx));
+
+  *entry = ep;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_cache_flush(usbdescbldr_cache_t * cache)
+{
+  size_t e;
+
+  if(cache == NULL || cache->entries == NULL)
+    return USBDESCBLDR_INVALID;
+
+  for(e = 0; e < cache->capacity; e++) {
+    if(cache->entries[e].lastUsed != 0)
+      _drop(cache, &cache->entries[e]);
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_cache_end(usbdescbldr_cache_t * cache)
+{
+  usbdescbldr_status_t rc;
+
+  if((rc = usbdescbldr_cache_flush(cache)) != USBDESCBLDR_OK)
+    return rc;
+
+  memset(cache, 0, sizeof(*cache));
+  return USBDESCBLDR_OK;
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Cache
+  //
+  // The platform configuration seldom changes from one boot or reset to
+  // the next, and so neither do the descriptors built from it. The cache
+  // keeps finished builds -- buffer and item tree -- keyed by the short
+  // forms they were made from. The caller passes those as a key, of bytes
+  // (a struct, say, of every short form and option its maker calls take);
+  // the key is hashed and compared, and on a match the earlier build is
+  // returned as it is, without running the maker calls at all. Only a miss
+  // runs them: once as a dry run, to size the build, and once for real.
+  //
+  // The cache holds at most a fixed number of builds, and at most a fixed
+  // number of bytes; the least recently used builds are dropped to make
+  // room. Storage for builds comes from the caller's allocator.
+
+  /// The caller's maker calls. The function is given a session which is
+  /// initialized, with an item arena; it takes every item it makes from
+  /// usbdescbldr_item_alloc(), makes and links them, and does not close the
+  /// session or change its options. It is called twice for each miss, and
+  /// must make the same calls each time for the same key.
+  typedef usbdescbldr_status_t (*usbdescbldr_cache_build_t)(usbdescbldr_ctx_t *ctx, void *user);
+
+  /// One cached build. Callers should treat this as 'read only'; it is
+  /// valid until the cache drops it (a later miss may) or is ended.
+  typedef struct {
+    uint64_t             fingerprint;   ///< Hash of the key
+    const void *         key;           ///< A copy of the key
+    size_t               keySize;
+    uint32_t             lastUsed;      ///< Cache clock at last use; 0 if the slot is free
+    unsigned char *      buffer;        ///< The descriptors, closed
+    size_t               length;        ///< Bytes of descriptors in the buffer
+    usbdescbldr_item_t * items;         ///< The items, in the order they were taken from the arena
+    size_t               itemCount;
+    usbdescbldr_item_t * made;          ///< Most recently made item; each links to the one before
+    size_t               size;          ///< Bytes held for the build
+  } usbdescbldr_cache_entry_t;
+
+  /// The cache. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_cache_entry_t * entries;
+    size_t                      capacity;     ///< Builds held, at most
+    size_t                      byteLimit;    ///< Bytes held, at most
+    size_t                      bytesUsed;
+    usbdescbldr_allocator_t     allocator;
+
+    unsigned char *             scratch;      ///< Items for sizing a build
+    size_t                      scratchSize;
+    uint32_t                    clock;
+
+    unsigned long               hits;
+    unsigned long               misses;
+    unsigned long               evictions;
+  } usbdescbldr_cache_t;
+
+  /// Prepare an empty cache.
+  ///\param [out] cache The cache.
+  ///\param [in] entries Storage for the builds held.
+  ///\param [in] capacity The number of entries.
+  ///\param [in] byteLimit The most bytes (descriptors, items and keys) to hold for all builds together.
+  ///\param [in] allocator The source of storage for builds; it is copied into the cache.
+  ///\param [in] scratch Storage for the items of the dry run on a miss, aligned
+  /// as an array of items; as large as the largest build's item arena.
+  ///\param [in] scratchSize The size in bytes of the scratch storage.
+  usbdescbldr_status_t
+    usbdescbldr_cache_init(usbdescbldr_cache_t *           cache,
+                           usbdescbldr_cache_entry_t *     entries,
+                           size_t                          capacity,
+                           size_t                          byteLimit,
+                           const usbdescbldr_allocator_t * allocator,
+                           void *                          scratch,
+                           size_t                          scratchSize);
+
+  /// Obtain the build for a key: from the cache if it holds one made for
+  /// the same key, otherwise by running the caller's maker calls (and
+  /// keeping the build, in place of the least recently used if need be).
+  /// Every byte of the key counts, so a struct's padding should be zeroed;
+  /// and a pointer in it counts as an address, not as what it points to.
+  ///\param [in] cache The cache.
+  ///\param [in] key The short forms the build is made from.
+  ///\param [in] keySize The size of the key in bytes.
+  ///\param [in] build The caller's maker calls; not called on a hit.
+  ///\param [in] user Passed to build.
+  ///\param [out] entry The build.
+  usbdescbldr_status_t
+    usbdescbldr_cache_build(usbdescbldr_cache_t *               cache,
+                            const void *                        key,
+                            size_t                              keySize,
+                            usbdescbldr_cache_build_t           build,
+                            void *                              user,
+                            const usbdescbldr_cache_entry_t **  entry);
+
+  /// Drop every build held.
+  ///\param [in] cache The cache.
+  usbdescbldr_status_t
+    usbdescbldr_cache_flush(usbdescbldr_cache_t * cache);
+
+  /// Drop every build held, and terminate use of the cache.
+  ///\param [in] cache The cache.
+  usbdescbldr_status_t
+    usbdescbldr_cache_end(usbdescbldr_cache_t * cache);
+
+#ifdef __cplusplus
+}
+#endif
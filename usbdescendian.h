@@ -0,0 +1,129 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Little-endian field access
+  //
+  // Descriptor fields are little-endian and, within packed descriptors,
+  // unaligned. These primitives store and load them in place. Being inline,
+  // with the host byte order fixed at compile time, each one comes down to
+  // a plain (unaligned) load or store on a little-endian host.
+  //
+  // Define USBDESCBLDR_SAFE_MEMCPY (CMake option of the same name) for
+  // targets whose memcpy() misplaces bytes within packed structures, as
+  // seen on Cypress; fields are then always moved a byte at a time.
+
+#if !defined(USBDESCBLDR_HOST_LITTLE_ENDIAN)
+#  if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+#    if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#      define USBDESCBLDR_HOST_LITTLE_ENDIAN  1
+#    else
+#      define USBDESCBLDR_HOST_LITTLE_ENDIAN  0
+#    endif
+#  elif defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM) || defined(_M_ARM64)
+#    define USBDESCBLDR_HOST_LITTLE_ENDIAN    1
+#  else
+     // Unknown: byte-at-a-time is correct for either order.
+#    define USBDESCBLDR_HOST_LITTLE_ENDIAN    0
+#  endif
+#endif
+
+#if USBDESCBLDR_HOST_LITTLE_ENDIAN && !defined(USBDESCBLDR_SAFE_MEMCPY)
+#  define USBDESCBLDR_DIRECT_LE  1
+#else
+#  define USBDESCBLDR_DIRECT_LE  0
+#endif
+
+  /// Store a 16-bit value, little-endian, at any alignment.
+  static inline void
+  usbdescbldr_put_le16(void *p, uint16_t v)
+  {
+#if USBDESCBLDR_DIRECT_LE
+    memcpy(p, &v, sizeof(v));
+#else
+    uint8_t *b = (uint8_t *) p;
+
+    b[0] = (uint8_t) (v >> 0);
+    b[1] = (uint8_t) (v >> 8);
+#endif
+  }
+
+  /// Store the low 24 bits of a value, little-endian, at any alignment.
+  static inline void
+  usbdescbldr_put_le24(void *p, uint32_t v)
+  {
+    uint8_t *b = (uint8_t *) p;
+
+    b[0] = (uint8_t) (v >> 0);
+    b[1] = (uint8_t) (v >> 8);
+    b[2] = (uint8_t) (v >> 16);
+  }
+
+  /// Store a 32-bit value, little-endian, at any alignment.
+  static inline void
+  usbdescbldr_put_le32(void *p, uint32_t v)
+  {
+#if USBDESCBLDR_DIRECT_LE
+    memcpy(p, &v, sizeof(v));
+#else
+    uint8_t *b = (uint8_t *) p;
+
+    b[0] = (uint8_t) (v >> 0);
+    b[1] = (uint8_t) (v >> 8);
+    b[2] = (uint8_t) (v >> 16);
+    b[3] = (uint8_t) (v >> 24);
+#endif
+  }
+
+  /// Load a little-endian 16-bit value from any alignment.
+  static inline uint16_t
+  usbdescbldr_get_le16(const void *p)
+  {
+#if USBDESCBLDR_DIRECT_LE
+    uint16_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    const uint8_t *b = (const uint8_t *) p;
+
+    return (uint16_t) (b[0] | (b[1] << 8));
+#endif
+  }
+
+  /// Load a little-endian 32-bit value from any alignment.
+  static inline uint32_t
+  usbdescbldr_get_le32(const void *p)
+  {
+#if USBDESCBLDR_DIRECT_LE
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+#else
+    const uint8_t *b = (const uint8_t *) p;
+
+    return ((uint32_t) b[0] << 0) | ((uint32_t) b[1] << 8) |
+           ((uint32_t) b[2] << 16) | ((uint32_t) b[3] << 24);
+#endif
+  }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,236 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescep0.h"
+#include "usbdescendian.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// bMaxPacketSize0, from the device descriptor: a size, or from USB 3.0 on,
+// a power of two.
+static size_t
+_device_max_packet(const usbdescbldr_responder_t *resp)
+{
+  const usbdescbldr_setup_t setup = {
+    0x80, USB_REQUEST_GET_DESCRIPTOR, USB_DESCRIPTOR_TYPE_DEVICE << 8, 0, sizeof(USB_DEVICE_DESCRIPTOR)
+  };
+  const uint8_t *device;
+  size_t         length;
+  uint8_t        size;
+
+  if(usbdescbldr_responder_get_descriptor(resp, &setup, &device, &length) != USBDESCBLDR_OK ||
+     length < sizeof(USB_DEVICE_DESCRIPTOR))
+    return 0;
+
+  size = device[offsetof(USB_DEVICE_DESCRIPTOR, bMaxPacketSize0)];
+  if(usbdescbldr_get_le16(device + offsetof(USB_DEVICE_DESCRIPTOR, bcdUSB)) >= 0x0300)
+    return size < 16 ? (size_t) 1 << size : 0;
+
+  return size;
+}
+
+
+// Gather a packet's bytes from the pieces of a segment list.
+static void
+_gather(usbdescbldr_ep0_t *ep0, size_t offset, size_t length)
+{
+  const usbdescbldr_segment_t *segments = ep0->responder.segments;
+  size_t                       s, at = 0, take;
+
+  for(s = 0; s < ep0->responder.segmentCount && at < length; s++) {
+    if(offset >= segments[s].length) {
+      offset -= segments[s].length;
+      continue;
+    }
+
+    take = segments[s].length - offset;
+    if(take > length - at)
+      take = length - at;
+    memcpy(ep0->packet + at, segments[s].data + offset, take);
+    at += take;
+    offset = 0;
+  }
+}
+
+
+// Send the next packet of the data stage: bytes, or the closing zero-length
+// packet. A failure to send ends the transfer.
+static usbdescbldr_status_t
+_send(usbdescbldr_ep0_t *ep0)
+{
+  usbdescbldr_segment_t piece;
+  const uint8_t *       data = ep0->packet;
+  size_t                length, count;
+  usbdescbldr_status_t  rc;
+
+  length = ep0->remaining < ep0->maxPacketSize ? ep0->remaining : ep0->maxPacketSize;
+
+  if(length == 0) {
+    ep0->zlp = 0;
+  } else if(ep0->reply != NULL) {
+    data = ep0->reply + ep0->offset;
+  } else if(ep0->responder.buffer != NULL) {
+    data = ep0->responder.buffer + ep0->offset;
+  } else {
+    // Straight from the piece it lies in, if it lies in one.
+    rc = usbdescbldr_slice_segments(ep0->responder.segments, ep0->responder.segmentCount,
+                                    ep0->offset, length, &piece, 1, &count);
+    if(rc == USBDESCBLDR_OK && count == 1)
+      data = piece.data;
+    else
+      _gather(ep0, ep0->offset, length);
+  }
+
+  ep0->offset += length;
+  ep0->remaining -= length;
+
+  rc = ep0->transmit(ep0->user, data, length);
+  if(rc != USBDESCBLDR_OK)
+    ep0->active = 0;
+
+  return rc;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_ep0_init(usbdescbldr_ep0_t *        ep0,
+                     const usbdescbldr_ctx_t *  ctx,
+                     size_t                     maxPacketSize,
+                     usbdescbldr_ep0_transmit_t transmit,
+                     usbdescbldr_ep0_stall_t    stall,
+                     void *                     user)
+{
+  usbdescbldr_status_t rc;
+
+  if(ep0 == NULL || ctx == NULL || transmit == NULL || stall == NULL)
+    return USBDESCBLDR_INVALID;
+
+  memset(ep0, 0, sizeof(*ep0));
+
+  rc = usbdescbldr_responder_init(&ep0->responder, ctx);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  if(maxPacketSize == 0)
+    maxPacketSize = _device_max_packet(&ep0->responder);
+
+  // 8, 16, 32 or 64 (or 512, for SuperSpeed), and no more than the packet buffer
+  if(maxPacketSize < 8 || (maxPacketSize & (maxPacketSize - 1)) != 0)
+    return USBDESCBLDR_INVALID;
+  if(maxPacketSize > USBDESCBLDR_EP0_MAX_PACKET)
+    return USBDESCBLDR_OVERSIZED;
+
+  ep0->maxPacketSize = maxPacketSize;
+  ep0->transmit = transmit;
+  ep0->stall = stall;
+  ep0->user = user;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_ep0_set_strings(usbdescbldr_ep0_t *           ep0,
+                            const usbdescbldr_strings_t * tab)
+{
+  if(ep0 == NULL)
+    return USBDESCBLDR_INVALID;
+
+  return usbdescbldr_responder_set_strings(&ep0->responder, tab);
+}
+
+
+// The reply is as much of the descriptor as the host asked for. A reply
+// short of wLength that fills its last packet would leave the host
+// waiting for more; the zero-length packet tells it there is none.
+
+usbdescbldr_status_t
+usbdescbldr_ep0_setup(usbdescbldr_ep0_t * ep0,
+                      const uint8_t *     setup)
+{
+  usbdescbldr_setup_t  request;
+  size_t               length;
+  usbdescbldr_status_t rc;
+
+  if(ep0 == NULL || setup == NULL || ep0->transmit == NULL)
+    return USBDESCBLDR_INVALID;
+
+  ep0->active = 0;
+  ep0->reply = NULL;
+
+  request.bmRequestType = setup[0];
+  request.bRequest = setup[1];
+  request.wValue = usbdescbldr_get_le16(setup + 2);
+  request.wIndex = usbdescbldr_get_le16(setup + 4);
+  request.wLength = usbdescbldr_get_le16(setup + 6);
+
+  rc = usbdescbldr_responder_find(&ep0->responder, &request, &ep0->offset, &length);
+
+  // A localized string is sent from its table.
+  if(rc == USBDESCBLDR_UNSUPPORTED && ep0->responder.strings != NULL) {
+    rc = usbdescbldr_responder_get_descriptor(&ep0->responder, &request, &ep0->reply, &length);
+    ep0->offset = 0;
+  }
+  if(rc == USBDESCBLDR_NOT_FOUND)
+    ep0->stall(ep0->user);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  ep0->remaining = length;
+  ep0->zlp = length < request.wLength && (length % ep0->maxPacketSize) == 0;
+
+  // With no data stage, the host goes straight to the status stage.
+  if(length == 0)
+    return USBDESCBLDR_OK;
+
+  ep0->active = 1;
+  return _send(ep0);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_ep0_in_complete(usbdescbldr_ep0_t * ep0)
+{
+  if(ep0 == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ep0->active)
+    return USBDESCBLDR_OK;
+
+  if(ep0->remaining == 0 && !ep0->zlp) {
+    ep0->active = 0;
+    return USBDESCBLDR_OK;
+  }
+
+  return _send(ep0);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_ep0_abort(usbdescbldr_ep0_t * ep0)
+{
+  if(ep0 == NULL)
+    return USBDESCBLDR_INVALID;
+
+  ep0->active = 0;
+  ep0->remaining = 0;
+  ep0->zlp = 0;
+
+  return USBDESCBLDR_OK;
+}
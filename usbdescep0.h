@@ -0,0 +1,122 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+#include "usbdescresponder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // EP0
+  //
+  // The data stage of GET_DESCRIPTOR, on top of the responder: the reply
+  // is cut into packets of bMaxPacketSize0, sent one at a time as the
+  // host takes them, and ended with a zero-length packet when it falls
+  // short of wLength on a packet boundary. Descriptors that do not exist
+  // are answered with a STALL.
+  //
+  // Each SETUP starts afresh, so the host's usual habit of reading a
+  // descriptor twice (9 bytes of a configuration, then wTotalLength of it)
+  // needs nothing special; nor does a SETUP arriving mid-transfer.
+  //
+  // Packets are sent from where the descriptors lie; only a packet that
+  // spans pieces of a segment list (see usbdescbldr_set_segments()) is
+  // gathered into the engine's packet buffer first. Like the rest of the
+  // builder, the engine is provided by the caller and does not allocate.
+
+  /// The largest bMaxPacketSize0 the engine handles (64, the most for
+  /// USB 2.0). Raise it to 512 for SuperSpeed.
+#ifndef USBDESCBLDR_EP0_MAX_PACKET
+#define USBDESCBLDR_EP0_MAX_PACKET   64
+#endif
+
+  /// Sends one IN packet on EP0 (length may be zero). The engine calls
+  /// this from usbdescbldr_ep0_setup() and usbdescbldr_ep0_in_complete();
+  /// the bytes need last only until the packet has been taken by the host.
+  typedef usbdescbldr_status_t (*usbdescbldr_ep0_transmit_t)(void *user, const uint8_t *packet, size_t length);
+
+  /// Stalls EP0, for a request the engine cannot answer.
+  typedef usbdescbldr_status_t (*usbdescbldr_ep0_stall_t)(void *user);
+
+  /// The engine. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_responder_t    responder;
+    size_t                     maxPacketSize;
+    usbdescbldr_ep0_transmit_t transmit;
+    usbdescbldr_ep0_stall_t    stall;
+    void *                     user;
+
+    // The transfer in progress:
+    int                        active;        ///< A data stage is under way
+    const uint8_t *            reply;         ///< The reply, if it lies outside the descriptors (a localized string)
+    size_t                     offset;        ///< Where in the descriptors (or reply) the next packet starts
+    size_t                     remaining;     ///< Bytes yet to send
+    int                        zlp;           ///< .. then a zero-length packet
+
+    uint8_t                    packet[USBDESCBLDR_EP0_MAX_PACKET];
+  } usbdescbldr_ep0_t;
+
+  /// Set up the engine for the descriptors built by a context. Call this
+  /// once, after usbdescbldr_close(); the context's buffer (and any
+  /// segment list) must not change for as long as the engine is in use.
+  ///\param [out] ep0 The engine.
+  ///\param [in] ctx A closed context with a (non dry-run) buffer.
+  ///\param [in] maxPacketSize The size of an EP0 packet; 0 to take it from the device descriptor.
+  ///\param [in] transmit Sends a packet.
+  ///\param [in] stall Stalls EP0.
+  ///\param [in] user Passed to transmit and stall.
+  usbdescbldr_status_t
+    usbdescbldr_ep0_init(usbdescbldr_ep0_t *        ep0,
+                         const usbdescbldr_ctx_t *  ctx,
+                         size_t                     maxPacketSize,
+                         usbdescbldr_ep0_transmit_t transmit,
+                         usbdescbldr_ep0_stall_t    stall,
+                         void *                     user);
+
+  /// Answer for the localized strings of a string table, as
+  /// usbdescbldr_responder_set_strings() does.
+  ///\param [in] ep0 The engine.
+  ///\param [in] tab The string table, or NULL.
+  usbdescbldr_status_t
+    usbdescbldr_ep0_set_strings(usbdescbldr_ep0_t *           ep0,
+                                const usbdescbldr_strings_t * tab);
+
+  /// Handle a SETUP packet. Any transfer in progress is dropped. A
+  /// GET_DESCRIPTOR is answered with its first packet (or, for a descriptor
+  /// that does not exist, a STALL, and USBDESCBLDR_NOT_FOUND). Other
+  /// requests yield USBDESCBLDR_UNSUPPORTED, and are the caller's to handle.
+  ///\param [in] ep0 The engine.
+  ///\param [in] setup The 8 bytes of the SETUP packet, as received.
+  usbdescbldr_status_t
+    usbdescbldr_ep0_setup(usbdescbldr_ep0_t * ep0,
+                          const uint8_t *     setup);
+
+  /// Note that the host has taken the last packet sent, and send the next,
+  /// if there is one. When the data stage is done, active is cleared.
+  ///\param [in] ep0 The engine.
+  usbdescbldr_status_t
+    usbdescbldr_ep0_in_complete(usbdescbldr_ep0_t * ep0);
+
+  /// Drop any transfer in progress (on a bus reset, say, or when the host
+  /// starts the status stage early).
+  ///\param [in] ep0 The engine.
+  usbdescbldr_status_t
+    usbdescbldr_ep0_abort(usbdescbldr_ep0_t * ep0);
+
+#ifdef __cplusplus
+}
+#endif
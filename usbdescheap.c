@@ -0,0 +1,48 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <stdlib.h>
+
+#include "usbdescbuilder.h"
+
+// The default allocator for growable sessions: the C library heap.
+// Kept apart from the builder proper so that targets without a heap
+// need never link it.
+
+static void *
+_heap_allocate(void *user, size_t size)
+{
+  (void) user;
+  return malloc(size);
+}
+
+
+static void *
+_heap_grow(void *user, void *block, size_t oldSize, size_t newSize)
+{
+  (void) user;
+  (void) oldSize;
+  return realloc(block, newSize);
+}
+
+
+static void
+_heap_release(void *user, void *block)
+{
+  (void) user;
+  free(block);
+}
+
+
+const usbdescbldr_allocator_t usbdescbldr_heap_allocator = {
+  _heap_allocate,
+  _heap_grow,
+  _heap_release,
+  NULL
+};
@@ -0,0 +1,327 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescimage.h"
+#include "usbdescendian.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// Header field offsets; see usbdescimage.h.
+#define _MAGIC          0
+#define _VERSION        4
+#define _HEADER_SIZE    6
+#define _IMAGE_SIZE     8
+#define _ENTRIES        12
+#define _INDEX_OFFSET   16
+#define _DATA_OFFSET    20
+#define _DATA_LENGTH    24
+#define _DATA_CRC       28
+#define _HEADER_CRC     32
+
+// Index entry field offsets
+#define _TYPE           0
+#define _INDEX          1
+#define _LANGUAGE       2
+#define _OFFSET         4
+#define _LENGTH         8
+
+
+// CRC-32 (IEEE 802.3, as zlib), a nibble at a time: a small table, and
+// quick enough for the few kilobytes an image holds.
+static const uint32_t _crcNibble[16] = {
+  0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+  0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+static uint32_t
+_crc32(uint32_t crc, const uint8_t *bp, size_t size)
+{
+  crc = ~crc;
+  while(size--) {
+    crc ^= *bp++;
+    crc = (crc >> 4) ^ _crcNibble[crc & 0x0f];
+    crc = (crc >> 4) ^ _crcNibble[crc & 0x0f];
+  }
+  return ~crc;
+}
+
+
+// Write (or, with no index space, just count) the entry for one span.
+// Strings past index 0 are in the first language declared.
+static uint32_t
+_entry(const usbdescbldr_responder_t *resp, uint8_t *index, uint32_t n,
+       uint8_t type, uint8_t bIndex, const usbdescbldr_span_t *span)
+{
+  uint8_t *entry;
+  uint16_t language = 0;
+
+  if(span->length == 0)
+    return n;
+
+  if(type == USB_DESCRIPTOR_TYPE_STRING && bIndex != 0 && resp->langs != 0)
+    language = resp->langID[0];
+
+  if(index != NULL) {
+    entry = index + n * USBDESCBLDR_IMAGE_ENTRY_SIZE;
+    entry[_TYPE] = type;
+    entry[_INDEX] = bIndex;
+    usbdescbldr_put_le16(entry + _LANGUAGE, language);
+    usbdescbldr_put_le32(entry + _OFFSET, span->offset);
+    usbdescbldr_put_le32(entry + _LENGTH, span->length);
+  }
+
+  return n + 1;
+}
+
+
+// The entries for a descriptor set, in the order the responder keeps them.
+static uint32_t
+_entries(const usbdescbldr_responder_t *resp, uint8_t *index)
+{
+  uint32_t     n = 0;
+  unsigned int i;
+
+  n = _entry(resp, index, n, USB_DESCRIPTOR_TYPE_DEVICE, 0, &resp->device);
+  n = _entry(resp, index, n, USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER, 0, &resp->qualifier);
+  n = _entry(resp, index, n, USB_DESCRIPTOR_TYPE_BOS, 0, &resp->bos);
+  for(i = 0; i < USBDESCBLDR_RESPONDER_MAX_CONFIGS; i++)
+    n = _entry(resp, index, n, USB_DESCRIPTOR_TYPE_CONFIGURATION, (uint8_t) i, &resp->config[i]);
+  for(i = 0; i < USBDESCBLDR_RESPONDER_MAX_STRINGS; i++)
+    n = _entry(resp, index, n, USB_DESCRIPTOR_TYPE_STRING, (uint8_t) i, &resp->string[i]);
+
+  return n;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+// The responder already knows where everything the host can ask for
+// is; the index is its findings, written down.
+
+usbdescbldr_status_t
+usbdescbldr_image_write(const uint8_t * descriptors,
+                        size_t          length,
+                        uint8_t *       image,
+                        size_t          imageSize,
+                        size_t *        written)
+{
+  usbdescbldr_responder_t resp;
+  usbdescbldr_status_t    rc;
+  uint32_t                entries;
+  size_t                  indexOffset, dataOffset, total;
+
+  if(descriptors == NULL || written == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if((rc = usbdescbldr_responder_init_buffer(&resp, descriptors, length)) != USBDESCBLDR_OK)
+    return rc;
+
+  entries = _entries(&resp, NULL);
+  indexOffset = USBDESCBLDR_IMAGE_HEADER_SIZE;
+  dataOffset = indexOffset + entries * USBDESCBLDR_IMAGE_ENTRY_SIZE;
+  total = dataOffset + length;
+  if(total > 0xffffffffu)
+    return USBDESCBLDR_OVERSIZED;
+
+  *written = total;
+  if(image == NULL)
+    return USBDESCBLDR_OK;
+
+  if(imageSize < total)
+    return USBDESCBLDR_NO_SPACE;
+
+  _entries(&resp, image + indexOffset);
+  memcpy(image + dataOffset, descriptors, length);
+
+  usbdescbldr_put_le32(image + _MAGIC, USBDESCBLDR_IMAGE_MAGIC);
+  usbdescbldr_put_le16(image + _VERSION, USBDESCBLDR_IMAGE_VERSION);
+  usbdescbldr_put_le16(image + _HEADER_SIZE, USBDESCBLDR_IMAGE_HEADER_SIZE);
+  usbdescbldr_put_le32(image + _IMAGE_SIZE, (uint32_t) total);
+  usbdescbldr_put_le32(image + _ENTRIES, entries);
+  usbdescbldr_put_le32(image + _INDEX_OFFSET, (uint32_t) indexOffset);
+  usbdescbldr_put_le32(image + _DATA_OFFSET, (uint32_t) dataOffset);
+  usbdescbldr_put_le32(image + _DATA_LENGTH, (uint32_t) length);
+  usbdescbldr_put_le32(image + _DATA_CRC, _crc32(0, image + indexOffset, total - indexOffset));
+  usbdescbldr_put_le32(image + _HEADER_CRC, _crc32(0, image, _HEADER_CRC));
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Everything here is a fixed number of reads, whatever the image holds.
+
+usbdescbldr_status_t
+usbdescbldr_image_load(usbdescbldr_image_t * image,
+                       const void *          bytes,
+                       size_t                size)
+{
+  const uint8_t *bp = (const uint8_t *) bytes;
+  uint32_t       headerSize, imageSize, entries, indexOffset, dataOffset, dataLength;
+
+  if(image == NULL || bytes == NULL)
+    return USBDESCBLDR_INVALID;
+
+  memset(image, 0, sizeof(*image));
+
+  if(size < USBDESCBLDR_IMAGE_HEADER_SIZE ||
+     usbdescbldr_get_le32(bp + _MAGIC) != USBDESCBLDR_IMAGE_MAGIC)
+    return USBDESCBLDR_INVALID;
+
+  // Only the major version must agree
+  if((usbdescbldr_get_le16(bp + _VERSION) >> 8) != (USBDESCBLDR_IMAGE_VERSION >> 8))
+    return USBDESCBLDR_UNSUPPORTED;
+
+  if(usbdescbldr_get_le32(bp + _HEADER_CRC) != _crc32(0, bp, _HEADER_CRC))
+    return USBDESCBLDR_INVALID;
+
+  headerSize = usbdescbldr_get_le16(bp + _HEADER_SIZE);
+  imageSize = usbdescbldr_get_le32(bp + _IMAGE_SIZE);
+  entries = usbdescbldr_get_le32(bp + _ENTRIES);
+  indexOffset = usbdescbldr_get_le32(bp + _INDEX_OFFSET);
+  dataOffset = usbdescbldr_get_le32(bp + _DATA_OFFSET);
+  dataLength = usbdescbldr_get_le32(bp + _DATA_LENGTH);
+
+  // The parts must lie in order, within the image, within what was given.
+  if(headerSize < USBDESCBLDR_IMAGE_HEADER_SIZE || imageSize > size ||
+     indexOffset < headerSize || indexOffset > imageSize ||
+     entries > (imageSize - indexOffset) / USBDESCBLDR_IMAGE_ENTRY_SIZE ||
+     dataOffset < indexOffset + entries * USBDESCBLDR_IMAGE_ENTRY_SIZE ||
+     dataOffset > imageSize || dataLength > imageSize - dataOffset)
+    return USBDESCBLDR_INVALID;
+
+  image->image = bp;
+  image->imageSize = imageSize;
+  image->index = bp + indexOffset;
+  image->entries = entries;
+  image->data = bp + dataOffset;
+  image->dataLength = dataLength;
+  image->dataCrc = usbdescbldr_get_le32(bp + _DATA_CRC);
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_image_verify(const usbdescbldr_image_t * image)
+{
+  if(image == NULL || image->image == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(_crc32(0, image->index, image->imageSize - (size_t) (image->index - image->image)) != image->dataCrc)
+    return USBDESCBLDR_INVALID;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_image_find(const usbdescbldr_image_t * image,
+                       uint8_t                     bDescriptorType,
+                       uint8_t                     bIndex,
+                       uint16_t                    wLanguageID,
+                       const uint8_t **            desc,
+                       size_t *                    length)
+{
+  const uint8_t *entry;
+  uint32_t       e, offset, size;
+
+  if(image == NULL || image->image == NULL || desc == NULL || length == NULL)
+    return USBDESCBLDR_INVALID;
+
+  for(e = 0; e < image->entries; e++) {
+    entry = image->index + e * USBDESCBLDR_IMAGE_ENTRY_SIZE;
+    if(entry[_TYPE] != bDescriptorType || entry[_INDEX] != bIndex ||
+       usbdescbldr_get_le16(entry + _LANGUAGE) != wLanguageID)
+      continue;
+
+    offset = usbdescbldr_get_le32(entry + _OFFSET);
+    size = usbdescbldr_get_le32(entry + _LENGTH);
+    if(offset > image->dataLength || size > image->dataLength - offset)
+      return USBDESCBLDR_INVALID;
+
+    *desc = image->data + offset;
+    *length = size;
+    return USBDESCBLDR_OK;
+  }
+
+  return USBDESCBLDR_NOT_FOUND;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_image_responder(usbdescbldr_responder_t *   resp,
+                            const usbdescbldr_image_t * image)
+{
+  const uint8_t *     entry;
+  usbdescbldr_span_t *span;
+  uint32_t            e, offset, length;
+  unsigned int        l;
+
+  if(resp == NULL || image == NULL || image->image == NULL)
+    return USBDESCBLDR_INVALID;
+
+  memset(resp, 0, sizeof(*resp));
+  resp->buffer = image->data;
+  resp->bufferSize = image->dataLength;
+
+  for(e = 0; e < image->entries; e++) {
+    entry = image->index + e * USBDESCBLDR_IMAGE_ENTRY_SIZE;
+    offset = usbdescbldr_get_le32(entry + _OFFSET);
+    length = usbdescbldr_get_le32(entry + _LENGTH);
+    if(offset > image->dataLength || length > image->dataLength - offset ||
+       length < sizeof(USB_DESCRIPTOR_HEADER) || length > 0xffff)
+      return USBDESCBLDR_INVALID;
+
+    switch(entry[_TYPE]) {
+    case USB_DESCRIPTOR_TYPE_DEVICE:
+      span = &resp->device;
+      break;
+    case USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER:
+      span = &resp->qualifier;
+      break;
+    case USB_DESCRIPTOR_TYPE_BOS:
+      span = &resp->bos;
+      break;
+    case USB_DESCRIPTOR_TYPE_CONFIGURATION:
+      if(entry[_INDEX] >= USBDESCBLDR_RESPONDER_MAX_CONFIGS)
+        return USBDESCBLDR_TOO_MANY;
+      span = &resp->config[entry[_INDEX]];
+      break;
+    case USB_DESCRIPTOR_TYPE_STRING:
+      if(entry[_INDEX] >= USBDESCBLDR_RESPONDER_MAX_STRINGS)
+        return USBDESCBLDR_TOO_MANY;
+      span = &resp->string[entry[_INDEX]];
+      break;
+    default:
+      // From a later version, perhaps; not for the responder.
+      continue;
+    }
+
+    span->offset = offset;
+    span->length = (uint16_t) length;
+  }
+
+  // String zero is the list of languages
+  if(resp->string[0].length != 0) {
+    entry = resp->buffer + resp->string[0].offset;
+    for(l = 0; l < (resp->string[0].length - 2u) / 2 && l < USBDESCBLDR_RESPONDER_MAX_LANGS; l++)
+      resp->langID[l] = usbdescbldr_get_le16(entry + 2 + 2 * l);
+    resp->langs = l;
+  }
+
+  return USBDESCBLDR_OK;
+}
@@ -0,0 +1,129 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+#include "usbdescresponder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Image
+  //
+  // A descriptor set built ahead of time (offline, or on a previous boot),
+  // kept as a self-describing image that can be mapped straight from a file
+  // and used where it lies. Loading checks the header and nothing else; the
+  // index within says where each descriptor the host may ask for is, so no
+  // walk of the descriptors is needed either.
+  //
+  // All fields are little-endian, at these byte offsets:
+  //
+  //   Header (USBDESCBLDR_IMAGE_HEADER_SIZE bytes)
+  //     0  magic        'U' 'D' 'B' 'I'
+  //     4  version      USBDESCBLDR_IMAGE_VERSION (16 bits)
+  //     6  headerSize   (16 bits)
+  //     8  imageSize    Bytes in the whole image
+  //    12  entries      Index entries
+  //    16  indexOffset  From the start of the image
+  //    20  dataOffset   From the start of the image
+  //    24  dataLength   Bytes of descriptors
+  //    28  dataCrc      CRC-32 of the index and the descriptors
+  //    32  headerCrc    CRC-32 of the 32 bytes above
+  //
+  //   Index entry (USBDESCBLDR_IMAGE_ENTRY_SIZE bytes each)
+  //     0  bDescriptorType
+  //     1  bIndex       Configuration or string index; 0 otherwise
+  //     2  wLanguageID  For strings other than index 0; 0 otherwise (16 bits)
+  //     4  offset       From the start of the descriptors
+  //     8  length       Including subordinates (wTotalLength)
+  //
+  //   Descriptors (dataLength bytes), just as the builder made them.
+  //
+  // A newer version may add fields to the end of the header; a loader of
+  // the same major version steps over them by way of headerSize.
+
+#define USBDESCBLDR_IMAGE_MAGIC         0x49424455    ///< "UDBI", as stored
+#define USBDESCBLDR_IMAGE_VERSION       0x0100        ///< Major in the high byte
+#define USBDESCBLDR_IMAGE_HEADER_SIZE   36
+#define USBDESCBLDR_IMAGE_ENTRY_SIZE    12
+
+  /// A loaded image: pointers into the caller's bytes. Callers should treat
+  /// this as 'read only'.
+  typedef struct {
+    const uint8_t * image;
+    size_t          imageSize;
+    const uint8_t * index;
+    uint32_t        entries;
+    const uint8_t * data;
+    size_t          dataLength;
+    uint32_t        dataCrc;
+  } usbdescbldr_image_t;
+
+  /// Write an image of a descriptor set. Pass a NULL image to learn the size
+  /// needed (as with a dry run).
+  ///\param [in] descriptors The descriptors, as made by a closed session.
+  ///\param [in] length The number of bytes of descriptors.
+  ///\param [out] image Where to write the image, or NULL.
+  ///\param [in] imageSize The size in bytes of the space at image.
+  ///\param [out] written The size in bytes of the image.
+  usbdescbldr_status_t
+    usbdescbldr_image_write(const uint8_t * descriptors,
+                            size_t          length,
+                            uint8_t *       image,
+                            size_t          imageSize,
+                            size_t *        written);
+
+  /// Load an image, checking only its header. The bytes must stay put
+  /// (mapped, say) for as long as the image is in use.
+  ///\param [out] image The loaded image.
+  ///\param [in] bytes The image.
+  ///\param [in] size The number of bytes available.
+  usbdescbldr_status_t
+    usbdescbldr_image_load(usbdescbldr_image_t * image,
+                           const void *          bytes,
+                           size_t                size);
+
+  /// Check the index and descriptors of a loaded image against its CRC.
+  /// This reads the whole image; call it when the storage is suspect.
+  ///\param [in] image The loaded image.
+  usbdescbldr_status_t
+    usbdescbldr_image_verify(const usbdescbldr_image_t * image);
+
+  /// Find a descriptor by its index entry.
+  ///\param [in] image The loaded image.
+  ///\param [in] bDescriptorType The descriptor type.
+  ///\param [in] bIndex The configuration or string index; 0 otherwise.
+  ///\param [in] wLanguageID The language, for strings other than index 0.
+  ///\param [out] desc The descriptor (and its subordinates).
+  ///\param [out] length The number of bytes.
+  usbdescbldr_status_t
+    usbdescbldr_image_find(const usbdescbldr_image_t * image,
+                           uint8_t                     bDescriptorType,
+                           uint8_t                     bIndex,
+                           uint16_t                    wLanguageID,
+                           const uint8_t **            desc,
+                           size_t *                    length);
+
+  /// Prepare a responder from an image's index, without walking its descriptors.
+  ///\param [out] resp The responder to be initialized.
+  ///\param [in] image The loaded image.
+  usbdescbldr_status_t
+    usbdescbldr_image_responder(usbdescbldr_responder_t *   resp,
+                                const usbdescbldr_image_t * image);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,273 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescindex.h"
+#include "usbdescparse.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// Video class-specific descriptors keep their ID or index in the fourth
+// byte: bTerminalID / bUnitID, bFormatIndex, bFrameIndex. Formats follow
+// that with bNumFrameDescriptors.
+#define USBDESCBLDR_UVC_ID_OFFSET       3
+#define USBDESCBLDR_UVC_FRAMES_OFFSET   4
+
+
+// The endpoint table slot for an address: the number, with IN endpoints above OUT.
+static unsigned int
+_endpoint_slot(uint8_t bEndpointAddress)
+{
+  return (bEndpointAddress & 0x0f) | ((bEndpointAddress & 0x80) >> 3);
+}
+
+
+static int
+_is_vc_entity(uint8_t subtype)
+{
+  return subtype >= USB_INTERFACE_SUBTYPE_VC_INPUT_TERMINAL &&
+         subtype <= USB_INTERFACE_SUBTYPE_VC_ENCODING_UNIT;
+}
+
+
+// Formats which are followed by frames of their own
+static int
+_is_vs_format(uint8_t subtype)
+{
+  return subtype == USB_INTERFACE_SUBTYPE_VS_FORMAT_UNCOMPRESSED ||
+         subtype == USB_INTERFACE_SUBTYPE_VS_FORMAT_MJPEG ||
+         subtype == USB_INTERFACE_SUBTYPE_VS_FORMAT_FRAME_BASED;
+}
+
+
+static int
+_is_vs_frame(uint8_t subtype)
+{
+  return subtype == USB_INTERFACE_SUBTYPE_VS_FRAME_UNCOMPRESSED ||
+         subtype == USB_INTERFACE_SUBTYPE_VS_FRAME_MJPEG ||
+         subtype == USB_INTERFACE_SUBTYPE_VS_FRAME_FRAME_BASED;
+}
+
+
+// The format table row for a VideoStreaming interface, or -1.
+static int
+_vs_slot(const usbdescbldr_index_t *index, uint8_t bInterfaceNumber)
+{
+  if(bInterfaceNumber >= USBDESCBLDR_INDEX_MAX_INTERFACES)
+    return -1;
+
+  return (int) index->vsSlot[bInterfaceNumber] - 1;
+}
+
+
+static const uint8_t *
+_at(const usbdescbldr_index_t *index, uint16_t offset)
+{
+  return offset != 0 ? index->config + offset : NULL;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+// A single walk of the configuration. Class-specific descriptors are
+// attributed to the interface most recently passed; frames to the
+// format most recently passed.
+
+usbdescbldr_status_t
+usbdescbldr_index_init(usbdescbldr_index_t * index,
+                       const uint8_t *       config,
+                       size_t                size)
+{
+  usbdescbldr_iter_t              top, it;
+  usbdescbldr_status_t            rc;
+  const USB_INTERFACE_DESCRIPTOR *ifc;
+  usbdescbldr_index_format_t *    format = NULL;
+  int                             vs = -1;
+  uint8_t                         number = 0;
+  uint8_t                         id;
+  uint16_t                        offset;
+
+  if(index == NULL || config == NULL)
+    return USBDESCBLDR_INVALID;
+
+  memset(index, 0, sizeof(*index));
+
+  usbdescbldr_iter_init(&top, config, size);
+  if((rc = usbdescbldr_iter_next(&top)) != USBDESCBLDR_OK)
+    return rc == USBDESCBLDR_NOT_FOUND ? USBDESCBLDR_INVALID : rc;
+  if(usbdescbldr_view_configuration(&top) == NULL)
+    return USBDESCBLDR_INVALID;
+  if((rc = usbdescbldr_iter_subordinates(&top, &it)) != USBDESCBLDR_OK)
+    return rc;
+
+  index->config = config;
+  index->configLength = (uint16_t) (top.length + it.bufferSize);
+
+  while((rc = usbdescbldr_iter_next(&it)) == USBDESCBLDR_OK) {
+    offset = (uint16_t) (it.desc - config);
+
+    if((ifc = usbdescbldr_view_interface(&it)) != NULL) {
+      number = ifc->bInterfaceNumber;
+      format = NULL;
+      if(number >= USBDESCBLDR_INDEX_MAX_INTERFACES ||
+         ifc->bAlternateSetting >= USBDESCBLDR_INDEX_MAX_ALTERNATES)
+        return USBDESCBLDR_TOO_MANY;
+      index->interface[number][ifc->bAlternateSetting] = offset;
+
+      // Formats belong to the VideoStreaming interface, not a setting of it
+      vs = -1;
+      if(it.interfaceClass == USB_INTERFACE_CC_VIDEO &&
+         it.interfaceSubClass == USB_INTERFACE_VC_SC_VIDEOSTREAMING) {
+        if((vs = _vs_slot(index, number)) < 0) {
+          if(index->vsInterfaces >= USBDESCBLDR_INDEX_MAX_VS_INTERFACES)
+            return USBDESCBLDR_TOO_MANY;
+          vs = index->vsInterfaces++;
+          index->vsSlot[number] = (uint8_t) (vs + 1);
+        }
+      }
+      continue;
+    }
+
+    if(usbdescbldr_view_endpoint(&it) != NULL) {
+      id = ((const USB_ENDPOINT_DESCRIPTOR *) it.desc)->bEndpointAddress;
+      if(index->endpoint[_endpoint_slot(id)] == 0)
+        index->endpoint[_endpoint_slot(id)] = offset;
+      continue;
+    }
+
+    if(it.type != UVC_CS_INTERFACE || it.length <= USBDESCBLDR_UVC_ID_OFFSET ||
+       it.interfaceClass != USB_INTERFACE_CC_VIDEO)
+      continue;
+
+    id = it.desc[USBDESCBLDR_UVC_ID_OFFSET];
+
+    if(it.interfaceSubClass == USB_INTERFACE_VC_SC_VIDEOCONTROL) {
+      if(_is_vc_entity(it.subtype))
+        index->entity[id] = offset;
+    } else if(vs >= 0 && _is_vs_format(it.subtype)) {
+      if(id == 0 || id > USBDESCBLDR_INDEX_MAX_FORMATS ||
+         it.length <= USBDESCBLDR_UVC_FRAMES_OFFSET)
+        return USBDESCBLDR_TOO_MANY;
+
+      // Set aside a frame slot for each frame the format claims; once only,
+      // or the first format's frames would be lost.
+      format = &index->format[vs][id - 1];
+      if(format->offset != 0)
+        return USBDESCBLDR_INVALID;
+      format->offset = offset;
+      format->firstFrame = index->frames;
+      format->frames = it.desc[USBDESCBLDR_UVC_FRAMES_OFFSET];
+      if(index->frames + format->frames > USBDESCBLDR_INDEX_MAX_FRAMES)
+        return USBDESCBLDR_TOO_MANY;
+      index->frames += format->frames;
+    } else if(format != NULL && _is_vs_frame(it.subtype)) {
+      if(id == 0 || id > format->frames)
+        return USBDESCBLDR_INVALID;
+      index->frame[format->firstFrame + id - 1] = offset;
+    }
+  }
+
+  return rc == USBDESCBLDR_NOT_FOUND ? USBDESCBLDR_OK : rc;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_index_init_item(usbdescbldr_index_t *        index,
+                            const usbdescbldr_ctx_t *    ctx,
+                            const usbdescbldr_item_t *   config)
+{
+  if(index == NULL || ctx == NULL || config == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->buffer == NULL)
+    return USBDESCBLDR_DRY_RUN;
+
+  if(config->kind != USBDESCBLDR_KIND_CONFIGURATION)
+    return USBDESCBLDR_INVALID;
+
+  return usbdescbldr_index_init(index, ctx->buffer + config->offset,
+                                ctx->length - config->offset);
+}
+
+
+const uint8_t *
+usbdescbldr_index_interface(const usbdescbldr_index_t * index,
+                            uint8_t                     bInterfaceNumber,
+                            uint8_t                     bAlternateSetting)
+{
+  if(bInterfaceNumber >= USBDESCBLDR_INDEX_MAX_INTERFACES ||
+     bAlternateSetting >= USBDESCBLDR_INDEX_MAX_ALTERNATES)
+    return NULL;
+
+  return _at(index, index->interface[bInterfaceNumber][bAlternateSetting]);
+}
+
+
+const uint8_t *
+usbdescbldr_index_endpoint(const usbdescbldr_index_t * index,
+                           uint8_t                     bEndpointAddress)
+{
+  // Bits 4..6 are reserved; no endpoint has them
+  if(bEndpointAddress & 0x70)
+    return NULL;
+
+  return _at(index, index->endpoint[_endpoint_slot(bEndpointAddress)]);
+}
+
+
+const uint8_t *
+usbdescbldr_index_entity(const usbdescbldr_index_t * index,
+                         uint8_t                     id)
+{
+  return _at(index, index->entity[id]);
+}
+
+
+const uint8_t *
+usbdescbldr_index_format(const usbdescbldr_index_t * index,
+                         uint8_t                     bInterfaceNumber,
+                         uint8_t                     bFormatIndex)
+{
+  int vs = _vs_slot(index, bInterfaceNumber);
+
+  if(vs < 0 || bFormatIndex == 0 || bFormatIndex > USBDESCBLDR_INDEX_MAX_FORMATS)
+    return NULL;
+
+  return _at(index, index->format[vs][bFormatIndex - 1].offset);
+}
+
+
+const uint8_t *
+usbdescbldr_index_frame(const usbdescbldr_index_t * index,
+                        uint8_t                     bInterfaceNumber,
+                        uint8_t                     bFormatIndex,
+                        uint8_t                     bFrameIndex)
+{
+  const usbdescbldr_index_format_t *format;
+  int                               vs = _vs_slot(index, bInterfaceNumber);
+
+  if(vs < 0 || bFormatIndex == 0 || bFormatIndex > USBDESCBLDR_INDEX_MAX_FORMATS)
+    return NULL;
+
+  format = &index->format[vs][bFormatIndex - 1];
+  if(bFrameIndex == 0 || bFrameIndex > format->frames)
+    return NULL;
+
+  return _at(index, index->frame[format->firstFrame + bFrameIndex - 1]);
+}
@@ -0,0 +1,133 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Index
+  //
+  // Control transfer handlers (probe/commit, class requests) look the
+  // same few descriptors up again and again. The index walks one
+  // configuration once, and thereafter answers each lookup from a
+  // direct table. Lookups yield a pointer to the descriptor within the
+  // configuration, or NULL; subtracting usbdescbldr_index_t.config gives
+  // its offset. Nothing is copied, and the API does not allocate.
+
+  /// Interface numbers the index can hold (0 .. n-1).
+#ifndef USBDESCBLDR_INDEX_MAX_INTERFACES
+#define USBDESCBLDR_INDEX_MAX_INTERFACES      16
+#endif
+
+  /// Alternate settings per interface the index can hold (0 .. n-1).
+#ifndef USBDESCBLDR_INDEX_MAX_ALTERNATES
+#define USBDESCBLDR_INDEX_MAX_ALTERNATES      8
+#endif
+
+  /// VideoStreaming interfaces the index can hold formats for.
+#ifndef USBDESCBLDR_INDEX_MAX_VS_INTERFACES
+#define USBDESCBLDR_INDEX_MAX_VS_INTERFACES   4
+#endif
+
+  /// Formats per VideoStreaming interface the index can hold (1 .. n).
+#ifndef USBDESCBLDR_INDEX_MAX_FORMATS
+#define USBDESCBLDR_INDEX_MAX_FORMATS         8
+#endif
+
+  /// Frames, summed over all formats, the index can hold.
+#ifndef USBDESCBLDR_INDEX_MAX_FRAMES
+#define USBDESCBLDR_INDEX_MAX_FRAMES          256
+#endif
+
+  /// Where a format's frames are found in the frame table.
+  typedef struct {
+    uint16_t offset;        ///< Of the format descriptor; 0 if absent
+    uint16_t firstFrame;    ///< Frame table slot of bFrameIndex 1
+    uint16_t frames;        ///< Number of slots (bNumFrameDescriptors)
+  } usbdescbldr_index_format_t;
+
+  /// The index. Offsets are from the start of the configuration descriptor,
+  /// which no other descriptor can share, so 0 marks an absent entry.
+  /// Callers should treat this as 'read only'.
+  typedef struct {
+    const uint8_t *            config;
+    uint16_t                   configLength;
+
+    uint16_t                   interface[USBDESCBLDR_INDEX_MAX_INTERFACES][USBDESCBLDR_INDEX_MAX_ALTERNATES];
+    uint16_t                   endpoint[32];     ///< By number, IN endpoints in the upper half
+    uint16_t                   entity[256];      ///< UVC units and terminals, by ID
+
+    uint8_t                    vsInterfaces;
+    uint8_t                    vsSlot[USBDESCBLDR_INDEX_MAX_INTERFACES];   ///< Format table row + 1, by interface; 0 if not VS
+    usbdescbldr_index_format_t format[USBDESCBLDR_INDEX_MAX_VS_INTERFACES][USBDESCBLDR_INDEX_MAX_FORMATS];
+    uint16_t                   frames;
+    uint16_t                   frame[USBDESCBLDR_INDEX_MAX_FRAMES];
+  } usbdescbldr_index_t;
+
+  /// Index a configuration descriptor and its subordinates.
+  ///\param [out] index The index to be built.
+  ///\param [in] config The configuration descriptor; its wTotalLength bytes must follow.
+  ///\param [in] size The number of bytes available at config.
+  usbdescbldr_status_t
+    usbdescbldr_index_init(usbdescbldr_index_t * index,
+                           const uint8_t *       config,
+                           size_t                size);
+
+  /// Index a configuration made by the builder. The context must be
+  /// closed, and its buffer must not move while the index is in use.
+  ///\param [out] index The index to be built.
+  ///\param [in] ctx The (closed, non dry-run) context.
+  ///\param [in] config The item for the configuration descriptor.
+  usbdescbldr_status_t
+    usbdescbldr_index_init_item(usbdescbldr_index_t *        index,
+                                const usbdescbldr_ctx_t *    ctx,
+                                const usbdescbldr_item_t *   config);
+
+  /// The interface descriptor for an interface and alternate setting.
+  const uint8_t *
+    usbdescbldr_index_interface(const usbdescbldr_index_t * index,
+                                uint8_t                     bInterfaceNumber,
+                                uint8_t                     bAlternateSetting);
+
+  /// The endpoint descriptor for an endpoint address. Where alternate
+  /// settings reuse an address, this is the first one in the configuration.
+  const uint8_t *
+    usbdescbldr_index_endpoint(const usbdescbldr_index_t * index,
+                               uint8_t                     bEndpointAddress);
+
+  /// The UVC unit or terminal descriptor with the given ID.
+  const uint8_t *
+    usbdescbldr_index_entity(const usbdescbldr_index_t * index,
+                             uint8_t                     id);
+
+  /// The VS format descriptor with the given bFormatIndex on a VideoStreaming interface.
+  const uint8_t *
+    usbdescbldr_index_format(const usbdescbldr_index_t * index,
+                             uint8_t                     bInterfaceNumber,
+                             uint8_t                     bFormatIndex);
+
+  /// The VS frame descriptor with the given bFrameIndex, of the given format.
+  const uint8_t *
+    usbdescbldr_index_frame(const usbdescbldr_index_t * index,
+                            uint8_t                     bInterfaceNumber,
+                            uint8_t                     bFormatIndex,
+                            uint8_t                     bFrameIndex);
+
+#ifdef __cplusplus
+}
+#endif
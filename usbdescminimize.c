@@ -0,0 +1,328 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescminimize.h"
+#include "usbdescendian.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// The continuous form of a frame's intervals: least, greatest, step.
+#define USBDESCBLDR_CONTINUOUS_INTERVALS   3
+
+
+// The session's items run newest first; turn them around (either way).
+static usbdescbldr_item_t *
+_reverse(usbdescbldr_item_t *ip)
+{
+  usbdescbldr_item_t *head = NULL, *next;
+
+  for(; ip != NULL; ip = next) {
+    next = ip->made;
+    ip->made = head;
+    head = ip;
+  }
+
+  return head;
+}
+
+
+// Where in a descriptor its string indices are. Those of the selector and
+// extension units come last, past their lists; the processing unit's, past
+// its bitmap (which trimming may have shortened).
+static size_t
+_string_fields(const usbdescbldr_item_t *item, const uint8_t *desc, size_t *at)
+{
+  switch(item->kind) {
+  case USBDESCBLDR_KIND_DEVICE:
+    at[0] = offsetof(USB_DEVICE_DESCRIPTOR, iManufacturer);
+    at[1] = offsetof(USB_DEVICE_DESCRIPTOR, iProduct);
+    at[2] = offsetof(USB_DEVICE_DESCRIPTOR, iSerialNumber);
+    return 3;
+  case USBDESCBLDR_KIND_CONFIGURATION:
+    at[0] = offsetof(USB_CONFIGURATION_DESCRIPTOR, iConfiguration);
+    return 1;
+  case USBDESCBLDR_KIND_INTERFACE:
+    at[0] = offsetof(USB_INTERFACE_DESCRIPTOR, iInterface);
+    return 1;
+  case USBDESCBLDR_KIND_INTERFACE_ASSOCIATION:
+    at[0] = offsetof(USB_INTERFACE_ASSOCIATION_DESCRIPTOR, iFunction);
+    return 1;
+  case USBDESCBLDR_KIND_VC_CAMERA_TERMINAL:
+    at[0] = offsetof(USB_UVC_CAMERA_TERMINAL, iTerminal);
+    return 1;
+  case USBDESCBLDR_KIND_VC_OUTPUT_TERMINAL:
+    at[0] = offsetof(USB_UVC_STREAMING_OUT_TERMINAL, iTerminal);
+    return 1;
+  case USBDESCBLDR_KIND_VC_PROCESSING_UNIT:
+    at[0] = offsetof(USB_UVC_VC_PROCESSING_UNIT, bControlSize);
+    if(at[0] >= item->size)
+      return 0;
+    at[0] += 1 + desc[at[0]];
+    return at[0] < item->size ? 1 : 0;
+  case USBDESCBLDR_KIND_VC_SELECTOR_UNIT:
+  case USBDESCBLDR_KIND_VC_EXTENSION_UNIT:
+    at[0] = item->size - 1;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+
+// Where a descriptor's bControlSize is, and how many bitmaps of that size
+// follow it; 0 if it has none (or they don't fit).
+static size_t
+_control_fields(const usbdescbldr_item_t *item, const uint8_t *desc, size_t *at)
+{
+  size_t rows = 1;
+
+  switch(item->kind) {
+  case USBDESCBLDR_KIND_VC_CAMERA_TERMINAL:
+    *at = offsetof(USB_UVC_CAMERA_TERMINAL, bControlBitfieldSize);
+    break;
+  case USBDESCBLDR_KIND_VC_PROCESSING_UNIT:
+    *at = offsetof(USB_UVC_VC_PROCESSING_UNIT, bControlSize);
+    break;
+  case USBDESCBLDR_KIND_VC_EXTENSION_UNIT:
+    *at = sizeof(USB_UVC_VC_EXTENSION_UNIT) + desc[offsetof(USB_UVC_VC_EXTENSION_UNIT, bNrInPins)];
+    break;
+  case USBDESCBLDR_KIND_VS_INPUT_HEADER:
+  case USBDESCBLDR_KIND_VS_OUTPUT_HEADER:
+    // bmaControls: one bitmap for each format, to the end
+    *at = item->kind == USBDESCBLDR_KIND_VS_INPUT_HEADER ?
+          offsetof(USB_UVC_VS_INPUT_HEADER_DESCRIPTOR, bControlSize) :
+          offsetof(USB_UVC_VS_OUTPUT_HEADER_DESCRIPTOR, bControlSize);
+    if(desc[*at] == 0 || (item->size - *at - 1) % desc[*at] != 0)
+      return 0;
+    rows = (item->size - *at - 1) / desc[*at];
+    break;
+  default:
+    return 0;
+  }
+
+  if(*at >= item->size || desc[*at] == 0 || *at + 1 + rows * desc[*at] > item->size)
+    return 0;
+
+  return rows;
+}
+
+
+// Trim a descriptor's bitmaps to the last byte any of them uses. The
+// new size of the descriptor.
+static size_t
+_trim_controls(const usbdescbldr_item_t *item, uint8_t *desc)
+{
+  size_t at, rows, r, n, keep = 1, b, tail;
+
+  rows = _control_fields(item, desc, &at);
+  if(rows == 0)
+    return item->size;
+
+  n = desc[at];
+  for(r = 0; r < rows; r++) {
+    for(b = n; b > keep; b--)
+      if(desc[at + 1 + r * n + b - 1] != 0)
+        break;
+    keep = b;
+  }
+
+  if(keep == n)
+    return item->size;
+
+  // Each bitmap down over the bytes dropped from those before, then the rest.
+  tail = at + 1 + rows * n;
+  for(r = 1; r < rows; r++)
+    memmove(desc + at + 1 + r * keep, desc + at + 1 + r * n, keep);
+  memmove(desc + at + 1 + rows * keep, desc + tail, item->size - tail);
+
+  desc[at] = (uint8_t) keep;
+  desc[0] = (uint8_t) (item->size - rows * (n - keep));
+  return desc[0];
+}
+
+
+// Collapse a frame's evenly spaced discrete intervals into the continuous
+// form. The new size of the descriptor.
+static size_t
+_collapse_intervals(const usbdescbldr_item_t *item, uint8_t *desc)
+{
+  size_t   at, type, count, i;
+  uint32_t first, last, step;
+  uint8_t *interval;
+
+  if(item->kind == USBDESCBLDR_KIND_VS_FRAME_FRAME_BASED) {
+    at = sizeof(UVC_VS_FRAME_FRAME_DESCRIPTOR);
+    type = offsetof(UVC_VS_FRAME_FRAME_DESCRIPTOR, bFrameIntervalType);
+  } else if(item->kind == USBDESCBLDR_KIND_VS_FRAME_UNCOMPRESSED) {
+    at = sizeof(UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR);
+    type = offsetof(UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR, bFrameIntervalType);
+  } else {
+    return item->size;
+  }
+
+  // Only where the continuous form is smaller
+  count = desc[type];
+  if(count <= USBDESCBLDR_CONTINUOUS_INTERVALS || at + count * sizeof(uint32_t) != item->size)
+    return item->size;
+
+  interval = desc + at;
+  first = usbdescbldr_get_le32(interval);
+  last = usbdescbldr_get_le32(interval + (count - 1) * sizeof(uint32_t));
+  if(first == last)
+    return item->size;
+
+  // Evenly spaced, rising or falling
+  step = usbdescbldr_get_le32(interval + sizeof(uint32_t)) - first;
+  for(i = 2; i < count; i++)
+    if(usbdescbldr_get_le32(interval + i * sizeof(uint32_t)) -
+       usbdescbldr_get_le32(interval + (i - 1) * sizeof(uint32_t)) != step)
+      return item->size;
+
+  if(last < first) {
+    i = first;
+    first = last;
+    last = (uint32_t) i;
+    step = 0 - step;
+  }
+
+  usbdescbldr_put_le32(interval, first);
+  usbdescbldr_put_le32(interval + sizeof(uint32_t), last);
+  usbdescbldr_put_le32(interval + 2 * sizeof(uint32_t), step);
+
+  desc[type] = 0;
+  desc[0] = (uint8_t) (at + USBDESCBLDR_CONTINUOUS_INTERVALS * sizeof(uint32_t));
+  return desc[0];
+}
+
+
+// Is a string to be dropped? Not if it is a subordinate of something.
+static int
+_unused(const usbdescbldr_item_t *item, const uint8_t *used, unsigned int passes)
+{
+  return (passes & USBDESCBLDR_MINIMIZE_STRINGS) && item->parent == NULL &&
+         !(used[(item->index & 0xff) >> 3] & (1 << (item->index & 7)));
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_minimize(usbdescbldr_ctx_t * ctx,
+                     unsigned int        passes,
+                     size_t *            saved)
+{
+  usbdescbldr_item_t * first, *ip, *next, *kept = NULL;
+  uint8_t              used[0x100 / 8];
+  uint8_t              renumber[0x100];
+  uint8_t *            desc;
+  size_t               at[3], fields, f, offset = 0, length = 0, size;
+  unsigned int         i, strings = 0;
+  usbdescbldr_status_t rc = USBDESCBLDR_OK;
+
+  if(ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  if(ctx->buffer == NULL)
+    return USBDESCBLDR_DRY_RUN;
+
+  if((ctx->options & USBDESCBLDR_OPTION_FINGERPRINT) || ctx->window != NULL || ctx->segments != NULL)
+    return USBDESCBLDR_INVALID;
+
+  // In buffer order. The items must lie end to end, each its descriptor.
+  first = _reverse(ctx->made);
+  memset(used, 0, sizeof(used));
+  for(ip = first; ip != NULL && rc == USBDESCBLDR_OK; ip = ip->made) {
+    desc = ctx->buffer + ip->offset;
+    if(ip->offset != offset || ip->size < sizeof(USB_DESCRIPTOR_HEADER) ||
+       ip->size > ctx->length - offset || desc[0] != ip->size)
+      rc = USBDESCBLDR_INVALID;
+    offset += ip->size;
+
+    fields = _string_fields(ip, desc, at);
+    for(f = 0; f < fields && rc == USBDESCBLDR_OK; f++)
+      used[desc[at[f]] >> 3] |= 1 << (desc[at[f]] & 7);
+  }
+
+  if(rc == USBDESCBLDR_OK && offset != ctx->length)
+    rc = USBDESCBLDR_INVALID;
+  if(rc != USBDESCBLDR_OK) {
+    ctx->made = _reverse(first);
+    return rc;
+  }
+
+  // Strings keep their order; those no one uses give up their indices.
+  for(i = 0; i < sizeof(renumber); i++)
+    renumber[i] = (uint8_t) i;
+  for(ip = first; ip != NULL; ip = ip->made) {
+    if(ip->kind == USBDESCBLDR_KIND_LANGUAGES) {
+      strings++;
+    } else if(ip->kind == USBDESCBLDR_KIND_STRING) {
+      if(_unused(ip, used, passes))
+        continue;
+      renumber[ip->index & 0xff] = (uint8_t) strings++;
+    }
+  }
+
+  // Shrink each descriptor where it is, then move it up after the last.
+  for(ip = first; ip != NULL; ip = next) {
+    next = ip->made;
+    desc = ctx->buffer + ip->offset;
+
+    if(ip->kind == USBDESCBLDR_KIND_STRING) {
+      if(_unused(ip, used, passes)) {
+        ip->kind = USBDESCBLDR_KIND_NONE;
+        ip->made = NULL;
+        continue;
+      }
+      ip->index = renumber[ip->index & 0xff];
+    }
+
+    if(passes & USBDESCBLDR_MINIMIZE_STRINGS) {
+      fields = _string_fields(ip, desc, at);
+      for(f = 0; f < fields; f++)
+        desc[at[f]] = renumber[desc[at[f]]];
+    }
+
+    if(passes & USBDESCBLDR_MINIMIZE_CONTROLS)
+      ip->size = (uint16_t) _trim_controls(ip, desc);
+    if(passes & USBDESCBLDR_MINIMIZE_INTERVALS)
+      ip->size = (uint16_t) _collapse_intervals(ip, desc);
+    size = ip->size;
+
+    memmove(ctx->buffer + length, desc, size);
+    ip->offset = (uint32_t) length;
+    if(ip->address != NULL)
+      ip->address = ctx->buffer + length;
+    length += size;
+
+    ip->made = kept;
+    kept = ip;
+  }
+
+  if(saved != NULL)
+    *saved = ctx->length - length;
+
+  ctx->made = kept;
+  ctx->length = length;
+  ctx->append = ctx->buffer + length;
+  ctx->i_string = strings;
+
+  return USBDESCBLDR_OK;
+}
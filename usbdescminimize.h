@@ -0,0 +1,68 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Minimizer
+  //
+  // A pass over a finished session, before usbdescbldr_close(), that
+  // makes the descriptors smaller without changing what they say. Every
+  // byte saved in a configuration is a byte less for the host to read at
+  // enumeration; at full speed, with 8- or 16-byte EP0 packets, that soon
+  // adds up to packets.
+  //
+  //  - INTERVALS: a frame's discrete intervals, when evenly spaced (and
+  //    more than three of them), become the continuous form: the least,
+  //    the greatest, and the step between.
+  //  - CONTROLS: bmControls bitmaps (camera terminal, processing and
+  //    extension units, VS headers' bmaControls) lose their trailing zero
+  //    bytes, and bControlSize with them. One byte is always kept.
+  //  - STRINGS: strings no descriptor refers to are dropped, and the rest
+  //    renumbered (as are the references to them). String zero is kept.
+  //
+  // The descriptors are moved up over the bytes saved, and their items
+  // follow; close then works out the totals. Dropped strings' items leave
+  // the session: their kind becomes USBDESCBLDR_KIND_NONE. Strings can't
+  // be dropped if anything outside the session holds their indices (a
+  // string table with localized strings, say); leave STRINGS out then.
+  //
+  // The session must have a buffer of its own making: not a dry run, a
+  // fingerprint, a window, or a segment list. A recorder is not told;
+  // a recipe replays the session as it was before the pass.
+
+  /// Passes of usbdescbldr_minimize().
+#define USBDESCBLDR_MINIMIZE_INTERVALS   0x0001
+#define USBDESCBLDR_MINIMIZE_CONTROLS    0x0002
+#define USBDESCBLDR_MINIMIZE_STRINGS     0x0004
+#define USBDESCBLDR_MINIMIZE_ALL         0x0007
+
+  /// Make a session's descriptors smaller. Call this after the last maker
+  /// call and before usbdescbldr_close().
+  ///\param [in] ctx The context for the session.
+  ///\param [in] passes The passes to make (USBDESCBLDR_MINIMIZE_...), ORed together.
+  ///\param [out] saved If non-NULL, the number of bytes saved.
+  usbdescbldr_status_t
+    usbdescbldr_minimize(usbdescbldr_ctx_t * ctx,
+                         unsigned int        passes,
+                         size_t *            saved);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,363 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescparse.h"
+#include "usbdescendian.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// Class-specific descriptor types (0x20 and up) carry a subtype
+// in their third byte.
+#define USBDESCBLDR_FIRST_CS_TYPE   0x20
+
+
+// Whether the iterator is within a video interface of the given subclass.
+static int
+_in_video(const usbdescbldr_iter_t *iter, uint8_t subClass)
+{
+  return iter->interfaceClass == USB_INTERFACE_CC_VIDEO &&
+         iter->interfaceSubClass == subClass;
+}
+
+
+// The current descriptor, if it is of the type (and subtype) asked for
+// and holds at least 'size' bytes.
+static const void *
+_view(const usbdescbldr_iter_t *iter, uint8_t type, int subtype, size_t size)
+{
+  if(iter == NULL || iter->desc == NULL)
+    return NULL;
+
+  if(iter->type != type || (subtype >= 0 && iter->subtype != subtype))
+    return NULL;
+
+  if(iter->length < size)
+    return NULL;
+
+  return iter->desc;
+}
+
+
+// Where the current descriptor keeps its wTotalLength, or 0 if it has none.
+static size_t
+_total_offset(const usbdescbldr_iter_t *iter)
+{
+  switch(iter->type) {
+  case USB_DESCRIPTOR_TYPE_CONFIGURATION:
+  case USB_DESCRIPTOR_TYPE_BOS:
+    return 2;
+
+  case UVC_CS_INTERFACE:
+    if(_in_video(iter, USB_INTERFACE_VC_SC_VIDEOCONTROL) &&
+       iter->subtype == USB_INTERFACE_SUBTYPE_VC_HEADER)
+      return 5;
+    if(_in_video(iter, USB_INTERFACE_VC_SC_VIDEOSTREAMING) &&
+       (iter->subtype == USB_INTERFACE_SUBTYPE_VS_INPUT_HEADER ||
+        iter->subtype == USB_INTERFACE_SUBTYPE_VS_OUTPUT_HEADER))
+      return 4;
+    break;
+
+  default:
+    break;
+  }
+
+  return 0;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_iter_init(usbdescbldr_iter_t * iter,
+                      const uint8_t *      buffer,
+                      size_t               bufferSize)
+{
+  if(iter == NULL || (buffer == NULL && bufferSize != 0))
+    return USBDESCBLDR_INVALID;
+
+  memset(iter, 0, sizeof(*iter));
+  iter->buffer = buffer;
+  iter->bufferSize = bufferSize;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_iter_next(usbdescbldr_iter_t * iter)
+{
+  const uint8_t *desc;
+  size_t         remains;
+  uint8_t        length;
+
+  if(iter == NULL)
+    return USBDESCBLDR_INVALID;
+
+  remains = iter->bufferSize - iter->offset;
+  if(remains == 0)
+    return USBDESCBLDR_NOT_FOUND;
+
+  // The header itself must be there, and bLength must cover it
+  // without running past the end.
+  if(remains < sizeof(USB_DESCRIPTOR_HEADER))
+    return USBDESCBLDR_INVALID;
+
+  desc = iter->buffer + iter->offset;
+  length = desc[0];
+  if(length < sizeof(USB_DESCRIPTOR_HEADER) || length > remains)
+    return USBDESCBLDR_INVALID;
+
+  iter->desc = desc;
+  iter->length = length;
+  iter->type = desc[1];
+  iter->subtype = 0;
+  if(iter->type >= USBDESCBLDR_FIRST_CS_TYPE && length >= sizeof(USB_CS_DESCRIPTOR_HEADER))
+    iter->subtype = desc[2];
+
+  // Note the interface that following class-specific descriptors belong to
+  if(iter->type == USB_DESCRIPTOR_TYPE_INTERFACE && length >= sizeof(USB_INTERFACE_DESCRIPTOR)) {
+    iter->interfaceClass = ((const USB_INTERFACE_DESCRIPTOR *) desc)->bInterfaceClass;
+    iter->interfaceSubClass = ((const USB_INTERFACE_DESCRIPTOR *) desc)->bInterfaceSubClass;
+  }
+
+  iter->offset += length;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_iter_find(usbdescbldr_iter_t * iter,
+                      uint8_t              type,
+                      int                  subtype)
+{
+  usbdescbldr_status_t rc;
+
+  while((rc = usbdescbldr_iter_next(iter)) == USBDESCBLDR_OK) {
+    if(iter->type == type && (subtype < 0 || iter->subtype == subtype))
+      break;
+  }
+
+  return rc;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_iter_subordinates(const usbdescbldr_iter_t * parent,
+                              usbdescbldr_iter_t *       sub)
+{
+  size_t   at;
+  size_t   start;
+  uint16_t total;
+
+  if(parent == NULL || sub == NULL || parent->desc == NULL)
+    return USBDESCBLDR_INVALID;
+
+  at = _total_offset(parent);
+  if(at == 0 || parent->length < at + sizeof(total))
+    return USBDESCBLDR_INVALID;
+
+  total = usbdescbldr_get_le16(parent->desc + at);
+
+  // The total counts the descriptor itself, and may not
+  // claim more than the enclosing buffer holds.
+  start = (size_t) (parent->desc - parent->buffer);
+  if(total < parent->length || total > parent->bufferSize - start)
+    return USBDESCBLDR_INVALID;
+
+  usbdescbldr_iter_init(sub, parent->desc + parent->length, total - parent->length);
+  sub->interfaceClass = parent->interfaceClass;
+  sub->interfaceSubClass = parent->interfaceSubClass;
+
+  return USBDESCBLDR_OK;
+}
+
+
+const USB_DEVICE_DESCRIPTOR *
+usbdescbldr_view_device(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_DEVICE_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_DEVICE, -1, sizeof(USB_DEVICE_DESCRIPTOR));
+}
+
+
+const USB_DEVICE_QUALIFIER_DESCRIPTOR *
+usbdescbldr_view_device_qualifier(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_DEVICE_QUALIFIER_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER, -1, sizeof(USB_DEVICE_QUALIFIER_DESCRIPTOR));
+}
+
+
+const USB_CONFIGURATION_DESCRIPTOR *
+usbdescbldr_view_configuration(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_CONFIGURATION_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_CONFIGURATION, -1, sizeof(USB_CONFIGURATION_DESCRIPTOR));
+}
+
+
+const USB_STRING_DESCRIPTOR *
+usbdescbldr_view_string(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_STRING_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_STRING, -1, sizeof(USB_STRING_DESCRIPTOR));
+}
+
+
+const USB_INTERFACE_ASSOCIATION_DESCRIPTOR *
+usbdescbldr_view_interface_association(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_INTERFACE_ASSOCIATION_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_INTERFACE_ASSOCIATION, -1,
+          sizeof(USB_INTERFACE_ASSOCIATION_DESCRIPTOR));
+}
+
+
+const USB_INTERFACE_DESCRIPTOR *
+usbdescbldr_view_interface(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_INTERFACE_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_INTERFACE, -1, sizeof(USB_INTERFACE_DESCRIPTOR));
+}
+
+
+const USB_ENDPOINT_DESCRIPTOR *
+usbdescbldr_view_endpoint(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_ENDPOINT_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_ENDPOINT, -1, sizeof(USB_ENDPOINT_DESCRIPTOR));
+}
+
+
+const USB_BOS_DESCRIPTOR *
+usbdescbldr_view_bos(const usbdescbldr_iter_t *iter)
+{
+  return (const USB_BOS_DESCRIPTOR *)
+    _view(iter, USB_DESCRIPTOR_TYPE_BOS, -1, sizeof(USB_BOS_DESCRIPTOR));
+}
+
+
+const USB_VC_CS_INTERFACE_DESCRIPTOR *
+usbdescbldr_view_vc_header(const usbdescbldr_iter_t *iter)
+{
+  if(iter == NULL || !_in_video(iter, USB_INTERFACE_VC_SC_VIDEOCONTROL))
+    return NULL;
+
+  return (const USB_VC_CS_INTERFACE_DESCRIPTOR *)
+    _view(iter, UVC_CS_INTERFACE, USB_INTERFACE_SUBTYPE_VC_HEADER,
+          sizeof(USB_VC_CS_INTERFACE_DESCRIPTOR));
+}
+
+
+const USB_UVC_VS_INPUT_HEADER_DESCRIPTOR *
+usbdescbldr_view_vs_input_header(const usbdescbldr_iter_t *iter)
+{
+  if(iter == NULL || !_in_video(iter, USB_INTERFACE_VC_SC_VIDEOSTREAMING))
+    return NULL;
+
+  return (const USB_UVC_VS_INPUT_HEADER_DESCRIPTOR *)
+    _view(iter, UVC_CS_INTERFACE, USB_INTERFACE_SUBTYPE_VS_INPUT_HEADER,
+          sizeof(USB_UVC_VS_INPUT_HEADER_DESCRIPTOR));
+}
+
+
+const UVC_VS_FORMAT_UNCOMPRESSED_DESCRIPTOR *
+usbdescbldr_view_vs_format_uncompressed(const usbdescbldr_iter_t *iter)
+{
+  if(iter == NULL || !_in_video(iter, USB_INTERFACE_VC_SC_VIDEOSTREAMING))
+    return NULL;
+
+  return (const UVC_VS_FORMAT_UNCOMPRESSED_DESCRIPTOR *)
+    _view(iter, UVC_CS_INTERFACE, USB_INTERFACE_SUBTYPE_VS_FORMAT_UNCOMPRESSED,
+          sizeof(UVC_VS_FORMAT_UNCOMPRESSED_DESCRIPTOR));
+}
+
+
+const UVC_VS_FORMAT_FRAME_DESCRIPTOR *
+usbdescbldr_view_vs_format_frame_based(const usbdescbldr_iter_t *iter)
+{
+  if(iter == NULL || !_in_video(iter, USB_INTERFACE_VC_SC_VIDEOSTREAMING))
+    return NULL;
+
+  return (const UVC_VS_FORMAT_FRAME_DESCRIPTOR *)
+    _view(iter, UVC_CS_INTERFACE, USB_INTERFACE_SUBTYPE_VS_FORMAT_FRAME_BASED,
+          sizeof(UVC_VS_FORMAT_FRAME_DESCRIPTOR));
+}
+
+
+const UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR *
+usbdescbldr_view_vs_frame_uncompressed(const usbdescbldr_iter_t *iter)
+{
+  if(iter == NULL || !_in_video(iter, USB_INTERFACE_VC_SC_VIDEOSTREAMING))
+    return NULL;
+
+  return (const UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR *)
+    _view(iter, UVC_CS_INTERFACE, USB_INTERFACE_SUBTYPE_VS_FRAME_UNCOMPRESSED,
+          sizeof(UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR));
+}
+
+
+const UVC_VS_FRAME_FRAME_DESCRIPTOR *
+usbdescbldr_view_vs_frame_frame_based(const usbdescbldr_iter_t *iter)
+{
+  if(iter == NULL || !_in_video(iter, USB_INTERFACE_VC_SC_VIDEOSTREAMING))
+    return NULL;
+
+  return (const UVC_VS_FRAME_FRAME_DESCRIPTOR *)
+    _view(iter, UVC_CS_INTERFACE, USB_INTERFACE_SUBTYPE_VS_FRAME_FRAME_BASED,
+          sizeof(UVC_VS_FRAME_FRAME_DESCRIPTOR));
+}
+
+
+// The interval table follows the fixed part of either frame descriptor.
+usbdescbldr_status_t
+usbdescbldr_vs_frame_interval(const usbdescbldr_iter_t * iter,
+                              unsigned int               i,
+                              uint32_t *                 interval)
+{
+  const UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR *uncompressed;
+  const UVC_VS_FRAME_FRAME_DESCRIPTOR *       frameBased;
+  const uint8_t *                             table;
+  unsigned int                                entries;
+
+  if(iter == NULL || interval == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if((uncompressed = usbdescbldr_view_vs_frame_uncompressed(iter)) != NULL) {
+    entries = uncompressed->bFrameIntervalType;
+    table = (const uint8_t *) (uncompressed + 1);
+  } else if((frameBased = usbdescbldr_view_vs_frame_frame_based(iter)) != NULL) {
+    entries = frameBased->bFrameIntervalType;
+    table = (const uint8_t *) (frameBased + 1);
+  } else {
+    return USBDESCBLDR_INVALID;
+  }
+
+  // Zero means continuous: minimum, maximum and step
+  if(entries == 0)
+    entries = 3;
+
+  if(i >= entries)
+    return USBDESCBLDR_NOT_FOUND;
+
+  // The table must lie within the descriptor's bLength
+  if((size_t) (table - iter->desc) + (i + 1) * sizeof(uint32_t) > iter->length)
+    return USBDESCBLDR_INVALID;
+
+  *interval = usbdescbldr_get_le32(table + i * sizeof(uint32_t));
+  return USBDESCBLDR_OK;
+}
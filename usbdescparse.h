@@ -0,0 +1,156 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "USBBldr.h"
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Parser
+  //
+  // The read side: walk a buffer of descriptors in place, whether it came
+  // from the builder, from flash, or from some other device. Every header
+  // is bounds-checked before it is believed. Nothing is copied; the views
+  // point into the caller's buffer, which must outlive them.
+  //
+  // The views are the packed structures of USBBldr.h. Their multi-byte
+  // fields are little-endian and unaligned; read them with
+  // usbdescbldr_get_le16() / usbdescbldr_get_le32() (usbdescendian.h).
+
+  /// Matches any subtype in usbdescbldr_iter_find().
+#define USBDESCBLDR_ANY_SUBTYPE   (-1)
+
+  /// An iterator over a run of descriptors. Callers should treat this as 'read only'.
+  typedef struct {
+    const uint8_t * buffer;
+    size_t          bufferSize;
+    size_t          offset;       ///< Offset of the next descriptor
+
+    const uint8_t * desc;         ///< The current descriptor; NULL before the first
+    uint8_t         length;       ///< Its bLength
+    uint8_t         type;         ///< Its bDescriptorType
+    uint8_t         subtype;      ///< Its bDescriptorSubtype, if class-specific; otherwise 0
+
+    // Class-specific interface subtypes only mean something within their
+    // interface (the VC and VS headers are both subtype 1), so the iterator
+    // remembers the class of the last interface descriptor it passed.
+    uint8_t         interfaceClass;
+    uint8_t         interfaceSubClass;
+  } usbdescbldr_iter_t;
+
+  /// Begin iterating a buffer of descriptors. No descriptor is current
+  /// until the first usbdescbldr_iter_next().
+  ///\param [out] iter The iterator.
+  ///\param [in] buffer The descriptors.
+  ///\param [in] bufferSize The number of bytes of descriptors.
+  usbdescbldr_status_t
+    usbdescbldr_iter_init(usbdescbldr_iter_t * iter,
+                          const uint8_t *      buffer,
+                          size_t               bufferSize);
+
+  /// Step to the next descriptor. Returns USBDESCBLDR_NOT_FOUND at the
+  /// end of the buffer, or USBDESCBLDR_INVALID if the next header is
+  /// truncated or claims more than the buffer holds (the iterator then
+  /// stays where it was).
+  ///\param [in] iter The iterator.
+  usbdescbldr_status_t
+    usbdescbldr_iter_next(usbdescbldr_iter_t * iter);
+
+  /// Step forward to the next descriptor of the given type (and subtype,
+  /// for class-specific types).
+  ///\param [in] iter The iterator.
+  ///\param [in] type The bDescriptorType sought.
+  ///\param [in] subtype The bDescriptorSubtype sought, or USBDESCBLDR_ANY_SUBTYPE.
+  usbdescbldr_status_t
+    usbdescbldr_iter_find(usbdescbldr_iter_t * iter,
+                          uint8_t              type,
+                          int                  subtype);
+
+  /// Begin iterating the subordinates of the current descriptor: those
+  /// counted by its wTotalLength, following the descriptor itself. This
+  /// applies to configuration, BOS, VC interface header and VS input/output
+  /// header descriptors; anything else yields USBDESCBLDR_INVALID. The
+  /// new iterator starts out within the parent's interface.
+  ///\param [in] parent An iterator positioned on the enclosing descriptor.
+  ///\param [out] sub The iterator over its subordinates.
+  usbdescbldr_status_t
+    usbdescbldr_iter_subordinates(const usbdescbldr_iter_t * parent,
+                                  usbdescbldr_iter_t *       sub);
+
+  // Typed views of the current descriptor. Each yields NULL unless the
+  // descriptor is of that type (and subtype), and long enough to hold
+  // the structure. Video class-specific views also require that the
+  // iterator has passed a VideoControl or VideoStreaming interface.
+
+  const USB_DEVICE_DESCRIPTOR *
+    usbdescbldr_view_device(const usbdescbldr_iter_t *iter);
+
+  const USB_DEVICE_QUALIFIER_DESCRIPTOR *
+    usbdescbldr_view_device_qualifier(const usbdescbldr_iter_t *iter);
+
+  const USB_CONFIGURATION_DESCRIPTOR *
+    usbdescbldr_view_configuration(const usbdescbldr_iter_t *iter);
+
+  const USB_STRING_DESCRIPTOR *
+    usbdescbldr_view_string(const usbdescbldr_iter_t *iter);
+
+  const USB_INTERFACE_ASSOCIATION_DESCRIPTOR *
+    usbdescbldr_view_interface_association(const usbdescbldr_iter_t *iter);
+
+  const USB_INTERFACE_DESCRIPTOR *
+    usbdescbldr_view_interface(const usbdescbldr_iter_t *iter);
+
+  const USB_ENDPOINT_DESCRIPTOR *
+    usbdescbldr_view_endpoint(const usbdescbldr_iter_t *iter);
+
+  const USB_BOS_DESCRIPTOR *
+    usbdescbldr_view_bos(const usbdescbldr_iter_t *iter);
+
+  const USB_VC_CS_INTERFACE_DESCRIPTOR *
+    usbdescbldr_view_vc_header(const usbdescbldr_iter_t *iter);
+
+  const USB_UVC_VS_INPUT_HEADER_DESCRIPTOR *
+    usbdescbldr_view_vs_input_header(const usbdescbldr_iter_t *iter);
+
+  const UVC_VS_FORMAT_UNCOMPRESSED_DESCRIPTOR *
+    usbdescbldr_view_vs_format_uncompressed(const usbdescbldr_iter_t *iter);
+
+  const UVC_VS_FORMAT_FRAME_DESCRIPTOR *
+    usbdescbldr_view_vs_format_frame_based(const usbdescbldr_iter_t *iter);
+
+  const UVC_VS_FRAME_UNCOMPRESSED_DESCRIPTOR *
+    usbdescbldr_view_vs_frame_uncompressed(const usbdescbldr_iter_t *iter);
+
+  const UVC_VS_FRAME_FRAME_DESCRIPTOR *
+    usbdescbldr_view_vs_frame_frame_based(const usbdescbldr_iter_t *iter);
+
+  /// Read one entry of the interval table of the current VS frame
+  /// descriptor (uncompressed or frame based). A discrete table has
+  /// bFrameIntervalType entries; a continuous one has three (minimum,
+  /// maximum, step).
+  ///\param [in] iter An iterator positioned on a VS frame descriptor.
+  ///\param [in] i The entry.
+  ///\param [out] interval The interval, in host order (100ns units).
+  usbdescbldr_status_t
+    usbdescbldr_vs_frame_interval(const usbdescbldr_iter_t * iter,
+                                  unsigned int               i,
+                                  uint32_t *                 interval);
+
+#ifdef __cplusplus
+}
+#endif
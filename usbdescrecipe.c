@@ -0,0 +1,1126 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "usbdescrecipe.h"
+#include "usbdescutf8.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+#define USBDESCBLDR_RECIPE_END   0
+
+// A field of a short form: where it is, and how wide. Fields of one byte
+// are stored as they are, of two or four as varints, and of eight (the
+// last of a GUID) as bytes.
+typedef struct {
+  uint8_t offset;
+  uint8_t width;
+} _field_t;
+
+#define USBDESCBLDR_FIELD(type, member)   { offsetof(type, member), sizeof(((type *) 0)->member) }
+
+// What follows the fields.
+enum {
+  _TAIL_NONE,
+  _TAIL_U8,         // A list of bytes
+  _TAIL_U16,        // .. of 16-bit values
+  _TAIL_U32,        // .. of 32-bit values
+  _TAIL_STRING,     // A string (the form is the string)
+};
+
+typedef struct {
+  const _field_t * fields;
+  uint8_t          fieldCount;
+  uint8_t          tail;
+} _op_t;
+
+
+// Makers which take scalars are recorded with those, in order, as their form.
+typedef struct { uint8_t capabilities; }                _bos_form_t;
+typedef struct { uint8_t bDevCapabilityType; }          _capability_form_t;
+typedef struct { uint32_t dwClockFrequency; }           _vc_header_form_t;
+typedef struct { uint8_t iSelector; uint8_t bUnitID; }  _selector_form_t;
+typedef struct { uint16_t wMaxTransferSize; }           _interrupt_ep_form_t;
+
+
+static const _field_t _device[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, bcdUSB),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, bDeviceClass),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, bDeviceSubClass),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, bDeviceProtocol),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, idVendor),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, idProduct),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, bcdDevice),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, iManufacturer),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, iProduct),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, iSerialNumber),
+  USBDESCBLDR_FIELD(usbdescbldr_device_descriptor_short_form_t, bNumConfigurations),
+};
+
+static const _field_t _qualifier[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_device_qualifier_short_form_t, bcdUSB),
+  USBDESCBLDR_FIELD(usbdescbldr_device_qualifier_short_form_t, bDeviceClass),
+  USBDESCBLDR_FIELD(usbdescbldr_device_qualifier_short_form_t, bDeviceSubClass),
+  USBDESCBLDR_FIELD(usbdescbldr_device_qualifier_short_form_t, bDeviceProtocol),
+  USBDESCBLDR_FIELD(usbdescbldr_device_qualifier_short_form_t, bMaxPacketSize0),
+  USBDESCBLDR_FIELD(usbdescbldr_device_qualifier_short_form_t, bNumConfigurations),
+};
+
+static const _field_t _configuration[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_device_configuration_short_form_t, bNumInterfaces),
+  USBDESCBLDR_FIELD(usbdescbldr_device_configuration_short_form_t, bConfigurationValue),
+  USBDESCBLDR_FIELD(usbdescbldr_device_configuration_short_form_t, iConfiguration),
+  USBDESCBLDR_FIELD(usbdescbldr_device_configuration_short_form_t, bmAttributes),
+  USBDESCBLDR_FIELD(usbdescbldr_device_configuration_short_form_t, bMaxPower),
+};
+
+static const _field_t _bos[] = {
+  USBDESCBLDR_FIELD(_bos_form_t, capabilities),
+};
+
+static const _field_t _capability[] = {
+  USBDESCBLDR_FIELD(_capability_form_t, bDevCapabilityType),
+};
+
+static const _field_t _interface[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, bInterfaceNumber),
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, bAlternateSetting),
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, bNumEndpoints),
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, bInterfaceClass),
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, bInterfaceSubClass),
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, bInterfaceProtocol),
+  USBDESCBLDR_FIELD(usbdescbldr_standard_interface_short_form_t, iInterface),
+};
+
+static const _field_t _endpoint[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_endpoint_short_form_t, bEndpointAddress),
+  USBDESCBLDR_FIELD(usbdescbldr_endpoint_short_form_t, bmAttributes),
+  USBDESCBLDR_FIELD(usbdescbldr_endpoint_short_form_t, wMaxPacketSize),
+  USBDESCBLDR_FIELD(usbdescbldr_endpoint_short_form_t, bInterval),
+};
+
+static const _field_t _companion[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_ss_ep_companion_short_form_t, bMaxBurst),
+  USBDESCBLDR_FIELD(usbdescbldr_ss_ep_companion_short_form_t, bmAttributes),
+  USBDESCBLDR_FIELD(usbdescbldr_ss_ep_companion_short_form_t, wBytesPerInterval),
+};
+
+static const _field_t _iad[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_iad_short_form_t, bFirstInterface),
+  USBDESCBLDR_FIELD(usbdescbldr_iad_short_form_t, bInterfaceCount),
+  USBDESCBLDR_FIELD(usbdescbldr_iad_short_form_t, bFunctionClass),
+  USBDESCBLDR_FIELD(usbdescbldr_iad_short_form_t, bFunctionSubClass),
+  USBDESCBLDR_FIELD(usbdescbldr_iad_short_form_t, bFunctionProtocol),
+  USBDESCBLDR_FIELD(usbdescbldr_iad_short_form_t, iFunction),
+};
+
+static const _field_t _vc_header[] = {
+  USBDESCBLDR_FIELD(_vc_header_form_t, dwClockFrequency),
+};
+
+static const _field_t _camera[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, bTerminalID),
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, bAssocTerminal),
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, iTerminal),
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, wObjectiveFocalLengthMin),
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, wObjectiveFocalLengthMax),
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, wOcularFocalLength),
+  USBDESCBLDR_FIELD(usbdescbldr_camera_terminal_short_form_t, controls),
+};
+
+static const _field_t _output_terminal[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_streaming_out_terminal_short_form_t, bTerminalID),
+  USBDESCBLDR_FIELD(usbdescbldr_streaming_out_terminal_short_form_t, bAssocTerminal),
+  USBDESCBLDR_FIELD(usbdescbldr_streaming_out_terminal_short_form_t, bSourceID),
+  USBDESCBLDR_FIELD(usbdescbldr_streaming_out_terminal_short_form_t, iTerminal),
+};
+
+static const _field_t _selector[] = {
+  USBDESCBLDR_FIELD(_selector_form_t, iSelector),
+  USBDESCBLDR_FIELD(_selector_form_t, bUnitID),
+};
+
+static const _field_t _processor[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_vc_processor_unit_short_form, bUnitID),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_processor_unit_short_form, bSourceID),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_processor_unit_short_form, wMaxMultiplier),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_processor_unit_short_form, controls),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_processor_unit_short_form, iProcessing),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_processor_unit_short_form, bmVideoStandards),
+};
+
+// bmControls (bControlSize bytes) follows these, ahead of the sources.
+static const _field_t _extension[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, bUnitID),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, guidExtensionCode.dwData1),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, guidExtensionCode.dwData2),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, guidExtensionCode.dwData3),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, guidExtensionCode.dwData4),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, bNumControls),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, bControlSize),
+  USBDESCBLDR_FIELD(usbdescbldr_vc_extension_unit_short_form_t, iExtension),
+};
+
+static const _field_t _interrupt_ep[] = {
+  USBDESCBLDR_FIELD(_interrupt_ep_form_t, wMaxTransferSize),
+};
+
+static const _field_t _input_header[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bNumFormats),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bEndpointAddress),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bmInfo),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bTerminalLink),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bStillCaptureMethod),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bTriggerSupport),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_input_header_short_form_t, bTriggerUsage),
+};
+
+static const _field_t _output_header[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bNumFormats),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bEndpointAddress),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bmInfo),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bTerminalLink),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bStillCaptureMethod),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bTriggerSupport),
+  USBDESCBLDR_FIELD(usbdescbldr_vs_if_output_header_short_form_t, bTriggerUsage),
+};
+
+static const _field_t _format_frame[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bFormatIndex),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bNumFrameDescriptors),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, guidFormat.dwData1),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, guidFormat.dwData2),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, guidFormat.dwData3),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, guidFormat.dwData4),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bBitsPerPixel),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bDefaultFrameIndex),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bAspectRatioX),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bAspectRatioY),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bmInterlaceFlags),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bCopyProtect),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_frame_based_short_form_t, bVariableSize),
+};
+
+static const _field_t _format_uncompressed[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bFormatIndex),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bNumFrameDescriptors),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, guidFormat.dwData1),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, guidFormat.dwData2),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, guidFormat.dwData3),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, guidFormat.dwData4),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bBitsPerPixel),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bDefaultFrameIndex),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bAspectRatioX),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bAspectRatioY),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bmInterlaceFlags),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_format_uncompressed_short_form_t, bCopyProtect),
+};
+
+static const _field_t _frame_frame[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, bFrameIndex),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, bmCapabilities),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, wWidth),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, wHeight),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, dwMinBitRate),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, dwMaxBitRate),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, dwDefaultFrameInterval),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, bFrameIntervalType),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_frame_based_short_form_t, dwBytesPerLine),
+};
+
+static const _field_t _frame_uncompressed[] = {
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, bFrameIndex),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, bmCapabilities),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, wWidth),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, wHeight),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, dwMinBitRate),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, dwMaxBitRate),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, dwMaxVideoFrameBufferSize),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, dwDefaultFrameInterval),
+  USBDESCBLDR_FIELD(usbdescbldr_uvc_vs_frame_uncompressed_short_form_t, bFrameIntervalType),
+};
+
+#define USBDESCBLDR_OP(fields, tail)   { fields, sizeof(fields) / sizeof(fields[0]), tail }
+
+static const _op_t _ops[USBDESCBLDR_KIND_COUNT] = {
+  [USBDESCBLDR_KIND_DEVICE]                 = USBDESCBLDR_OP(_device, _TAIL_NONE),
+  [USBDESCBLDR_KIND_DEVICE_QUALIFIER]       = USBDESCBLDR_OP(_qualifier, _TAIL_NONE),
+  [USBDESCBLDR_KIND_CONFIGURATION]          = USBDESCBLDR_OP(_configuration, _TAIL_NONE),
+  [USBDESCBLDR_KIND_LANGUAGES]              = { NULL, 0, _TAIL_U16 },
+  [USBDESCBLDR_KIND_STRING]                 = { NULL, 0, _TAIL_STRING },
+  [USBDESCBLDR_KIND_BOS]                    = USBDESCBLDR_OP(_bos, _TAIL_NONE),
+  [USBDESCBLDR_KIND_DEVICE_CAPABILITY]      = USBDESCBLDR_OP(_capability, _TAIL_U8),
+  [USBDESCBLDR_KIND_INTERFACE]              = USBDESCBLDR_OP(_interface, _TAIL_NONE),
+  [USBDESCBLDR_KIND_ENDPOINT]               = USBDESCBLDR_OP(_endpoint, _TAIL_NONE),
+  [USBDESCBLDR_KIND_SS_EP_COMPANION]        = USBDESCBLDR_OP(_companion, _TAIL_NONE),
+  [USBDESCBLDR_KIND_INTERFACE_ASSOCIATION]  = USBDESCBLDR_OP(_iad, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VC_HEADER]              = USBDESCBLDR_OP(_vc_header, _TAIL_U8),
+  [USBDESCBLDR_KIND_VC_CAMERA_TERMINAL]     = USBDESCBLDR_OP(_camera, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VC_OUTPUT_TERMINAL]     = USBDESCBLDR_OP(_output_terminal, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VC_SELECTOR_UNIT]       = USBDESCBLDR_OP(_selector, _TAIL_U8),
+  [USBDESCBLDR_KIND_VC_PROCESSING_UNIT]     = USBDESCBLDR_OP(_processor, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VC_EXTENSION_UNIT]      = USBDESCBLDR_OP(_extension, _TAIL_U8),
+  [USBDESCBLDR_KIND_VC_INTERRUPT_EP]        = USBDESCBLDR_OP(_interrupt_ep, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VS_INPUT_HEADER]        = USBDESCBLDR_OP(_input_header, _TAIL_U8),
+  [USBDESCBLDR_KIND_VS_OUTPUT_HEADER]       = USBDESCBLDR_OP(_output_header, _TAIL_U8),
+  [USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED]  = USBDESCBLDR_OP(_format_frame, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED] = USBDESCBLDR_OP(_format_uncompressed, _TAIL_NONE),
+  [USBDESCBLDR_KIND_VS_FRAME_FRAME_BASED]   = USBDESCBLDR_OP(_frame_frame, _TAIL_U32),
+  [USBDESCBLDR_KIND_VS_FRAME_UNCOMPRESSED]  = USBDESCBLDR_OP(_frame_uncompressed, _TAIL_U32),
+};
+
+
+// Room for any one form, and any one list, on replay. The longest lists
+// are those that fill a descriptor (whose bLength is a byte).
+typedef union {
+  usbdescbldr_device_descriptor_short_form_t          device;
+  usbdescbldr_device_qualifier_short_form_t           qualifier;
+  usbdescbldr_device_configuration_short_form_t       configuration;
+  usbdescbldr_standard_interface_short_form_t         interface;
+  usbdescbldr_endpoint_short_form_t                   endpoint;
+  usbdescbldr_ss_ep_companion_short_form_t            companion;
+  usbdescbldr_iad_short_form_t                        iad;
+  usbdescbldr_camera_terminal_short_form_t            camera;
+  usbdescbldr_streaming_out_terminal_short_form_t     outputTerminal;
+  usbdescbldr_vc_processor_unit_short_form            processor;
+  usbdescbldr_vc_extension_unit_short_form_t          extension;
+  usbdescbldr_vs_if_input_header_short_form_t         inputHeader;
+  usbdescbldr_vs_if_output_header_short_form_t        outputHeader;
+  usbdescbldr_uvc_vs_format_frame_based_short_form_t  formatFrame;
+  usbdescbldr_uvc_vs_format_uncompressed_short_form_t formatUncompressed;
+  usbdescbldr_uvc_vs_frame_frame_based_short_form_t   frameFrame;
+  usbdescbldr_uvc_vs_frame_uncompressed_short_form_t  frameUncompressed;
+  _bos_form_t                                         bos;
+  _capability_form_t                                  capability;
+  _vc_header_form_t                                   vcHeader;
+  _selector_form_t                                    selector;
+  _interrupt_ep_form_t                                interruptEp;
+} _form_t;
+
+typedef union {
+  uint16_t  u16[0xff / sizeof(uint16_t)];
+  uint32_t  u32[0xff / sizeof(uint32_t)];
+  char      string[0xff + 1];
+} _list_t;
+
+
+static uint32_t
+_field_get(const void *form, const _field_t *field)
+{
+  const uint8_t *src = (const uint8_t *) form + field->offset;
+  uint16_t       u16;
+  uint32_t       u32;
+
+  switch(field->width) {
+  case 1:
+    return *src;
+  case 2:
+    memcpy(&u16, src, sizeof(u16));
+    return u16;
+  default:
+    memcpy(&u32, src, sizeof(u32));
+    return u32;
+  }
+}
+
+
+static void
+_field_set(void *form, const _field_t *field, uint32_t value)
+{
+  uint8_t *dest = (uint8_t *) form + field->offset;
+  uint16_t u16 = (uint16_t) value;
+
+  switch(field->width) {
+  case 1:
+    *dest = (uint8_t) value;
+    break;
+  case 2:
+    memcpy(dest, &u16, sizeof(u16));
+    break;
+  default:
+    memcpy(dest, &value, sizeof(value));
+    break;
+  }
+}
+
+
+// A repeat's fields are kept, for the next, where they lie in the form.
+typedef char _form_fits[sizeof(_form_t) <= USBDESCBLDR_RECIPE_FORM_SIZE ? 1 : -1];
+
+
+// Differences, wrapped to 32 bits, go as zigzag varints: small either way
+// is short.
+static uint32_t
+_zigzag(uint32_t value, uint32_t before)
+{
+  uint32_t d = value - before;
+
+  return (d << 1) ^ (0 - (d >> 31));
+}
+
+
+static uint32_t
+_unzigzag(uint32_t z, uint32_t before)
+{
+  return before + ((z >> 1) ^ (0 - (z & 1)));
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// Recording
+
+static void
+_put(usbdescbldr_recorder_t *rec, uint8_t byte)
+{
+  if(rec->buffer != NULL && rec->length < rec->bufferSize)
+    rec->buffer[rec->length] = byte;
+  rec->length++;
+}
+
+
+static void
+_put_varint(usbdescbldr_recorder_t *rec, uint32_t value)
+{
+  while(value >= 0x80) {
+    _put(rec, (uint8_t) (value | 0x80));
+    value >>= 7;
+  }
+  _put(rec, (uint8_t) value);
+}
+
+
+static void
+_put_bytes(usbdescbldr_recorder_t *rec, const uint8_t *bytes, size_t count)
+{
+  size_t b;
+
+  for(b = 0; b < count; b++)
+    _put(rec, bytes != NULL ? bytes[b] : 0);
+}
+
+
+// A list's elements, from the first'th on: bytes as they are, wider values
+// as varints (in a repeat, as differences from the item before's, as far
+// as they are kept). They are kept in turn, for the next.
+static void
+_put_list(usbdescbldr_recorder_t *rec, uint8_t tail, const void *list, size_t listLength,
+          size_t first)
+{
+  size_t   l, at;
+  uint32_t value;
+
+  for(l = 0; l < listLength; l++) {
+    if(tail == _TAIL_U8) {
+      _put(rec, list != NULL ? ((const uint8_t *) list)[l] : 0);
+      continue;
+    }
+
+    value = tail == _TAIL_U16 ? ((const uint16_t *) list)[l] : ((const uint32_t *) list)[l];
+    at = first + l;
+    if(at >= USBDESCBLDR_RECIPE_HISTORY) {
+      _put_varint(rec, value);
+      continue;
+    }
+
+    if(rec->repeat)
+      _put_varint(rec, _zigzag(value, at < rec->lastListLength ? rec->lastList[at] : 0));
+    else
+      _put_varint(rec, value);
+    rec->lastList[at] = value;
+  }
+}
+
+
+// An item's number: how many items were made before it. The newest
+// item is at the head of the session's list.
+static size_t
+_serial(const usbdescbldr_recorder_t *rec, const usbdescbldr_item_t *item)
+{
+  const usbdescbldr_item_t *ip;
+  size_t                    back = 0;
+
+  for(ip = rec->ctx->made; ip != NULL; ip = ip->made, back++) {
+    if(ip == item)
+      return rec->items - 1 - back;
+  }
+
+  return (size_t) -1;
+}
+
+
+// Links are run together: children linked, one after another, to the same
+// parent share one operation.
+static void
+_record_link(usbdescbldr_recorder_t *rec, const usbdescbldr_item_t *child,
+             const usbdescbldr_item_t *parent)
+{
+  size_t p = _serial(rec, parent);
+  size_t c = _serial(rec, child);
+
+  if(p == (size_t) -1 || c == (size_t) -1) {
+    rec->status = USBDESCBLDR_INVALID;
+    return;
+  }
+
+  if(rec->link != 0 && rec->linkParent == p && rec->linkCount < 0xff) {
+    rec->linkCount++;
+    if(rec->buffer != NULL && rec->link < rec->bufferSize)
+      rec->buffer[rec->link] = (uint8_t) rec->linkCount;
+  } else if(rec->link == 0 && rec->linkCount != 0 && rec->linkParent == p && c + 1 == rec->items) {
+    // An item linked as soon as it is made, where the one before went.
+    _put(rec, USBDESCBLDR_RECIPE_LINK_NEWEST);
+    return;
+  } else {
+    _put(rec, USBDESCBLDR_RECORD_LINK);
+    _put_varint(rec, (uint32_t) p);
+    rec->link = rec->length;
+    rec->linkParent = p;
+    rec->linkCount = 1;
+    _put(rec, 1);
+  }
+  _put_varint(rec, (uint32_t) c);
+}
+
+
+// The rest of a list, which follows on from the last item's.
+static void
+_record_more(usbdescbldr_recorder_t *rec, const void *list, size_t listLength)
+{
+  if(rec->list == 0 || listLength > 0xff - rec->listCount) {
+    rec->status = USBDESCBLDR_INVALID;
+    return;
+  }
+
+  if(rec->buffer != NULL && rec->list < rec->bufferSize)
+    rec->buffer[rec->list] = (uint8_t) (rec->listCount + listLength);
+
+  _put_list(rec, rec->listTail, list, listLength, rec->listCount);
+  rec->listCount += listLength;
+}
+
+
+static void
+_record(void *recorder, uint8_t op, const usbdescbldr_item_t *item,
+        const void *form, const void *list, size_t listLength)
+{
+  usbdescbldr_recorder_t *rec = (usbdescbldr_recorder_t *) recorder;
+  const _op_t *           ops;
+  const _field_t *        field;
+  const usbdescbldr_vc_extension_unit_short_form_t *extension;
+  uint8_t                 utf16le[0xff];
+  uint32_t                mask;
+  size_t                  f, l;
+
+  if(op == USBDESCBLDR_RECORD_LINK) {
+    rec->list = 0;
+    _record_link(rec, item, (const usbdescbldr_item_t *) form);
+    return;
+  }
+
+  if(op == USBDESCBLDR_RECORD_MORE) {
+    _record_more(rec, list, listLength);
+    return;
+  }
+
+  rec->items++;
+  rec->link = 0;
+  rec->list = 0;
+
+  // What the item before's list was, for a repeat of it
+  rec->lastListLength = rec->listCount;
+  rec->listCount = 0;
+
+  // A string whose UTF-8 is too long for its length byte goes in UTF-16LE.
+  if(op == USBDESCBLDR_KIND_STRING && form != NULL && strlen((const char *) form) > 0xff) {
+    if(usbdescbldr_utf8_to_utf16le(utf16le, sizeof(utf16le), (const char *) form,
+                                   strlen((const char *) form), &listLength) != USBDESCBLDR_OK) {
+      rec->status = USBDESCBLDR_INVALID;
+      return;
+    }
+    op = USBDESCBLDR_RECORD_UTF16LE;
+    list = utf16le;
+  }
+
+  if(op == USBDESCBLDR_RECORD_UTF16LE) {
+    rec->lastOp = USBDESCBLDR_KIND_NONE;
+    _put(rec, op);
+    _put(rec, (uint8_t) listLength);
+    _put_bytes(rec, (const uint8_t *) list, listLength);
+    return;
+  }
+
+  if(op >= USBDESCBLDR_KIND_COUNT || (op != USBDESCBLDR_KIND_LANGUAGES && form == NULL)) {
+    rec->status = USBDESCBLDR_INVALID;
+    return;
+  }
+
+  ops = &_ops[op];
+  rec->repeat = ops->fieldCount != 0 && op == rec->lastOp;
+
+  if(rec->repeat) {
+    // Only the fields which differ from the item before's
+    for(f = 0, mask = 0; f < ops->fieldCount; f++) {
+      field = &ops->fields[f];
+      if(memcmp((const uint8_t *) form + field->offset, rec->lastForm + field->offset, field->width) != 0)
+        mask |= 1u << f;
+    }
+
+    _put(rec, USBDESCBLDR_RECIPE_REPEAT);
+    _put_varint(rec, mask);
+
+    for(f = 0; f < ops->fieldCount; f++) {
+      field = &ops->fields[f];
+      if(!(mask & (1u << f)))
+        continue;
+      if(field->width <= 4)
+        _put_varint(rec, _zigzag(_field_get(form, field), _field_get(rec->lastForm, field)));
+      else
+        _put_bytes(rec, (const uint8_t *) form + field->offset, field->width);
+    }
+  } else {
+    _put(rec, op);
+
+    for(f = 0; f < ops->fieldCount; f++) {
+      field = &ops->fields[f];
+      if(field->width == 1)
+        _put(rec, (uint8_t) _field_get(form, field));
+      else if(field->width <= 4)
+        _put_varint(rec, _field_get(form, field));
+      else
+        _put_bytes(rec, (const uint8_t *) form + field->offset, field->width);
+    }
+  }
+
+  rec->lastOp = op;
+  for(f = 0; f < ops->fieldCount; f++) {
+    field = &ops->fields[f];
+    memcpy(rec->lastForm + field->offset, (const uint8_t *) form + field->offset, field->width);
+  }
+
+  if(op == USBDESCBLDR_KIND_VC_EXTENSION_UNIT) {
+    extension = (const usbdescbldr_vc_extension_unit_short_form_t *) form;
+    _put_bytes(rec, extension->bmControls, extension->bControlSize);
+  }
+
+  switch(ops->tail) {
+  case _TAIL_U8:
+  case _TAIL_U16:
+  case _TAIL_U32:
+    rec->list = rec->length;
+    rec->listTail = ops->tail;
+    rec->listCount = listLength;
+    _put(rec, (uint8_t) listLength);
+    _put_list(rec, ops->tail, list, listLength, 0);
+    break;
+  case _TAIL_STRING:
+    l = strlen((const char *) form);
+    _put(rec, (uint8_t) l);
+    _put_bytes(rec, (const uint8_t *) form, l);
+    break;
+  default:
+    break;
+  }
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// Replay
+
+typedef struct {
+  const uint8_t * next;
+  const uint8_t * end;
+  int             bad;        // Ran off the end, or found nonsense
+} _reader_t;
+
+
+static uint8_t
+_get(_reader_t *rd)
+{
+  if(rd->next >= rd->end) {
+    rd->bad = 1;
+    return 0;
+  }
+  return *rd->next++;
+}
+
+
+static uint32_t
+_get_varint(_reader_t *rd)
+{
+  uint32_t value = 0;
+  unsigned shift;
+  uint8_t  byte;
+
+  for(shift = 0; shift < 35; shift += 7) {
+    byte = _get(rd);
+    value |= (uint32_t) (byte & 0x7f) << shift;
+    if(!(byte & 0x80))
+      return value;
+  }
+
+  rd->bad = 1;
+  return 0;
+}
+
+
+static const uint8_t *
+_get_bytes(_reader_t *rd, size_t count)
+{
+  const uint8_t *bytes = rd->next;
+
+  if(count > (size_t) (rd->end - rd->next)) {
+    rd->bad = 1;
+    return NULL;
+  }
+  rd->next += count;
+  return bytes;
+}
+
+
+// Apply the caller's overrides for one item to its form (or string).
+static usbdescbldr_status_t
+_override(const _op_t *ops, size_t serial, _form_t *form, const char **string,
+          const usbdescbldr_recipe_override_t *overrides, size_t overrideCount)
+{
+  const usbdescbldr_recipe_override_t *ov;
+  const _field_t *                     field;
+  size_t                               o, f;
+
+  for(o = 0; o < overrideCount; o++) {
+    ov = &overrides[o];
+    if(ov->item != serial)
+      continue;
+
+    if(ops->tail == _TAIL_STRING) {
+      if(ov->string == NULL || ov->field != 0)
+        return USBDESCBLDR_INVALID;
+      *string = ov->string;
+      continue;
+    }
+
+    for(f = 0; f < ops->fieldCount && ops->fields[f].offset != ov->field; f++)
+      ;
+    if(f == ops->fieldCount || ov->string != NULL)
+      return USBDESCBLDR_INVALID;
+
+    field = &ops->fields[f];
+    if(field->width > 4)
+      return USBDESCBLDR_INVALID;
+    if(field->width < 4 && (ov->value >> (8 * field->width)) != 0)
+      return USBDESCBLDR_OVERSIZED;
+    _field_set(form, field, ov->value);
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Make one item from its decoded form and list.
+static usbdescbldr_status_t
+_make(usbdescbldr_ctx_t *ctx, uint8_t op, usbdescbldr_item_t *item, const _form_t *form,
+      const void *list, size_t listLength, const char *string)
+{
+  switch(op) {
+  case USBDESCBLDR_KIND_DEVICE:
+    return usbdescbldr_make_device_descriptor(ctx, item, &form->device);
+  case USBDESCBLDR_KIND_DEVICE_QUALIFIER:
+    return usbdescbldr_make_device_qualifier_descriptor(ctx, item, &form->qualifier);
+  case USBDESCBLDR_KIND_CONFIGURATION:
+    return usbdescbldr_make_device_configuration_descriptor(ctx, item, &form->configuration);
+  case USBDESCBLDR_KIND_LANGUAGES:
+    return usbdescbldr_make_languageIDs_fixed(ctx, item, (const uint16_t *) list, listLength);
+  case USBDESCBLDR_KIND_STRING:
+    return usbdescbldr_make_string_descriptor(ctx, item, NULL, string);
+  case USBDESCBLDR_KIND_BOS:
+    return usbdescbldr_make_bos_descriptor(ctx, item, form->bos.capabilities);
+  case USBDESCBLDR_KIND_DEVICE_CAPABILITY:
+    return usbdescbldr_make_device_capability_descriptor(ctx, item, form->capability.bDevCapabilityType,
+                                                         (const uint8_t *) list, listLength);
+  case USBDESCBLDR_KIND_INTERFACE:
+    return usbdescbldr_make_standard_interface_descriptor(ctx, item, &form->interface);
+  case USBDESCBLDR_KIND_ENDPOINT:
+    return usbdescbldr_make_endpoint_descriptor(ctx, item, &form->endpoint);
+  case USBDESCBLDR_KIND_SS_EP_COMPANION:
+    return usbdescbldr_make_ss_ep_companion_descriptor(ctx, item, &form->companion);
+  case USBDESCBLDR_KIND_INTERFACE_ASSOCIATION:
+    return usbdescbldr_make_interface_association_descriptor(ctx, item, &form->iad);
+  case USBDESCBLDR_KIND_VC_HEADER:
+    return usbdescbldr_make_vc_interface_header_fixed(ctx, item, form->vcHeader.dwClockFrequency,
+                                                      (const uint8_t *) list, listLength);
+  case USBDESCBLDR_KIND_VC_CAMERA_TERMINAL:
+    return usbdescbldr_make_camera_terminal_descriptor(ctx, item, &form->camera);
+  case USBDESCBLDR_KIND_VC_OUTPUT_TERMINAL:
+    return usbdescbldr_make_streaming_out_terminal_descriptor(ctx, item, &form->outputTerminal);
+  case USBDESCBLDR_KIND_VC_SELECTOR_UNIT:
+    return usbdescbldr_make_vc_selector_unit_fixed(ctx, item, form->selector.iSelector, form->selector.bUnitID,
+                                                   (const uint8_t *) list, listLength);
+  case USBDESCBLDR_KIND_VC_PROCESSING_UNIT:
+    return usbdescbldr_make_vc_processor_unit(ctx, item, &form->processor);
+  case USBDESCBLDR_KIND_VC_EXTENSION_UNIT:
+    return usbdescbldr_make_extension_unit_descriptor_fixed(ctx, item, &form->extension,
+                                                            (const uint8_t *) list, listLength);
+  case USBDESCBLDR_KIND_VC_INTERRUPT_EP:
+    return usbdescbldr_make_vc_interrupt_ep(ctx, item, form->interruptEp.wMaxTransferSize);
+  case USBDESCBLDR_KIND_VS_INPUT_HEADER:
+    return usbdescbldr_make_vs_interface_header_fixed(ctx, item, &form->inputHeader,
+                                                      (const uint8_t *) list, listLength);
+  case USBDESCBLDR_KIND_VS_OUTPUT_HEADER:
+    return usbdescbldr_make_uvc_vs_if_output_header_fixed(ctx, item, &form->outputHeader,
+                                                          (const uint8_t *) list, listLength);
+  case USBDESCBLDR_KIND_VS_FORMAT_FRAME_BASED:
+    return usbdescbldr_make_uvc_vs_format_frame(ctx, item, &form->formatFrame);
+  case USBDESCBLDR_KIND_VS_FORMAT_UNCOMPRESSED:
+    return usbdescbldr_make_uvc_vs_format_uncompressed(ctx, item, &form->formatUncompressed);
+  case USBDESCBLDR_KIND_VS_FRAME_FRAME_BASED:
+    return usbdescbldr_make_uvc_vs_frame_frame_fixed(ctx, item, &form->frameFrame,
+                                                     (const uint32_t *) list, listLength);
+  case USBDESCBLDR_KIND_VS_FRAME_UNCOMPRESSED:
+    return usbdescbldr_make_uvc_vs_frame_uncompressed_fixed(ctx, item, &form->frameUncompressed,
+                                                            (const uint32_t *) list, listLength);
+  default:
+    return USBDESCBLDR_INVALID;
+  }
+}
+
+
+// The item made last, as recorded (before any overrides), for a repeat of it.
+typedef struct {
+  uint8_t  op;
+  _form_t  form;
+  uint32_t list[USBDESCBLDR_RECIPE_HISTORY];
+  size_t   listLength;
+} _last_t;
+
+
+// A list element of 16 or 32 bits: in a repeat, its difference from the
+// item before's, as far as those are kept.
+static uint32_t
+_get_element(_reader_t *rd, _last_t *last, int repeat, size_t at)
+{
+  uint32_t value = _get_varint(rd);
+
+  if(at >= USBDESCBLDR_RECIPE_HISTORY)
+    return value;
+
+  if(repeat)
+    value = _unzigzag(value, at < last->listLength ? last->list[at] : 0);
+  last->list[at] = value;
+  return value;
+}
+
+
+// Decode and make one item.
+static usbdescbldr_status_t
+_replay_make(usbdescbldr_ctx_t *ctx, _reader_t *rd, uint8_t op, int repeat, _last_t *last,
+             usbdescbldr_item_t *item, size_t serial,
+             const usbdescbldr_recipe_override_t *overrides, size_t overrideCount)
+{
+  const _op_t *        ops = &_ops[op];
+  const _field_t *     field;
+  _form_t              form;
+  _list_t              decoded;
+  const void *         list = NULL;
+  const char *         string = decoded.string;
+  size_t               count = 0, f, l;
+  uint32_t             mask;
+  usbdescbldr_status_t rc;
+
+  if(repeat) {
+    form = last->form;
+    mask = _get_varint(rd);
+    if(mask >> ops->fieldCount)
+      return USBDESCBLDR_INVALID;
+
+    for(f = 0; f < ops->fieldCount; f++) {
+      field = &ops->fields[f];
+      if(!(mask & (1u << f)))
+        continue;
+      if(field->width <= 4)
+        _field_set(&form, field, _unzigzag(_get_varint(rd), _field_get(&form, field)));
+      else if((list = _get_bytes(rd, field->width)) != NULL)
+        memcpy((uint8_t *) &form + field->offset, list, field->width);
+    }
+  } else {
+    memset(&form, 0, sizeof(form));
+
+    for(f = 0; f < ops->fieldCount; f++) {
+      field = &ops->fields[f];
+      if(field->width == 1)
+        _field_set(&form, field, _get(rd));
+      else if(field->width <= 4)
+        _field_set(&form, field, _get_varint(rd));
+      else if((list = _get_bytes(rd, field->width)) != NULL)
+        memcpy((uint8_t *) &form + field->offset, list, field->width);
+    }
+  }
+
+  // The extension's controls stay in the recipe.
+  if(op == USBDESCBLDR_KIND_VC_EXTENSION_UNIT)
+    form.extension.bmControls = (uint8_t *) _get_bytes(rd, form.extension.bControlSize);
+
+  if(ops->tail != _TAIL_NONE)
+    count = _get(rd);
+
+  switch(ops->tail) {
+  case _TAIL_U8:
+    list = _get_bytes(rd, count);
+    break;
+  case _TAIL_U16:
+    if(count > sizeof(decoded.u16) / sizeof(decoded.u16[0]))
+      return USBDESCBLDR_INVALID;
+    for(l = 0; l < count; l++)
+      decoded.u16[l] = (uint16_t) _get_element(rd, last, repeat, l);
+    list = decoded.u16;
+    break;
+  case _TAIL_U32:
+    if(count > sizeof(decoded.u32) / sizeof(decoded.u32[0]))
+      return USBDESCBLDR_INVALID;
+    for(l = 0; l < count; l++)
+      decoded.u32[l] = _get_element(rd, last, repeat, l);
+    list = decoded.u32;
+    break;
+  case _TAIL_STRING:
+    if(count >= sizeof(decoded.string) || (list = _get_bytes(rd, count)) == NULL)
+      return USBDESCBLDR_INVALID;
+    memcpy(decoded.string, list, count);
+    decoded.string[count] = '\0';
+    list = NULL;
+    count = 0;
+    break;
+  default:
+    list = NULL;
+    break;
+  }
+
+  if(rd->bad)
+    return USBDESCBLDR_INVALID;
+
+  last->op = op;
+  last->form = form;
+  last->listLength = count;
+
+  f = form.extension.bControlSize;
+  rc = _override(ops, serial, &form, &string, overrides, overrideCount);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  // .. and so their number can't change.
+  if(op == USBDESCBLDR_KIND_VC_EXTENSION_UNIT && form.extension.bControlSize != f)
+    return USBDESCBLDR_INVALID;
+
+  return _make(ctx, op, item, &form, list, count, string);
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_recipe_record(usbdescbldr_ctx_t *      ctx,
+                          usbdescbldr_recorder_t * recorder,
+                          uint8_t *                buffer,
+                          size_t                   bufferSize)
+{
+  if(ctx == NULL || recorder == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  // A recipe starts with the session.
+  if(ctx->made != NULL || ctx->record != NULL)
+    return USBDESCBLDR_INVALID;
+
+  memset(recorder, 0, sizeof(*recorder));
+  recorder->ctx = ctx;
+  recorder->buffer = buffer;
+  recorder->bufferSize = buffer != NULL ? bufferSize : 0;
+  recorder->status = USBDESCBLDR_OK;
+
+  _put(recorder, USBDESCBLDR_RECIPE_VERSION);
+
+  ctx->record = _record;
+  ctx->recorder = recorder;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_recipe_finish(usbdescbldr_recorder_t * recorder,
+                          size_t *                 length)
+{
+  if(recorder == NULL || length == NULL || recorder->ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(recorder->ctx->recorder == recorder) {
+    recorder->ctx->record = NULL;
+    recorder->ctx->recorder = NULL;
+  }
+
+  _put(recorder, USBDESCBLDR_RECIPE_END);
+  recorder->link = 0;
+  recorder->list = 0;
+  *length = recorder->length;
+
+  if(recorder->status != USBDESCBLDR_OK)
+    return recorder->status;
+
+  if(recorder->buffer != NULL && recorder->length > recorder->bufferSize)
+    return USBDESCBLDR_NO_SPACE;
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Make a string recorded in UTF-16LE. Its characters are used where they
+// lie in the recipe; an override replaces them with a string, as for
+// usbdescbldr_make_string_descriptor().
+static usbdescbldr_status_t
+_replay_utf16le(usbdescbldr_ctx_t *ctx, _reader_t *rd, usbdescbldr_item_t *item, size_t serial,
+                const usbdescbldr_recipe_override_t *overrides, size_t overrideCount)
+{
+  const uint8_t *utf16le;
+  const char *   string = NULL;
+  size_t         length, o;
+
+  length = _get(rd);
+  utf16le = _get_bytes(rd, length);
+  if(rd->bad)
+    return USBDESCBLDR_INVALID;
+
+  for(o = 0; o < overrideCount; o++) {
+    if(overrides[o].item != serial)
+      continue;
+    if(overrides[o].string == NULL || overrides[o].field != 0)
+      return USBDESCBLDR_INVALID;
+    string = overrides[o].string;
+  }
+
+  if(string != NULL)
+    return usbdescbldr_make_string_descriptor(ctx, item, NULL, string);
+
+  return usbdescbldr_make_string_descriptor_utf16le(ctx, item, NULL, utf16le, length);
+}
+
+
+// One pass over the bytecode; each operation is decoded into a form on
+// the stack and handed to its maker, so nothing is kept between them.
+
+usbdescbldr_status_t
+usbdescbldr_recipe_replay(usbdescbldr_ctx_t *                   ctx,
+                          const uint8_t *                       recipe,
+                          size_t                                length,
+                          usbdescbldr_item_t *                  items,
+                          size_t                                itemCount,
+                          const usbdescbldr_recipe_override_t * overrides,
+                          size_t                                overrideCount)
+{
+  _reader_t            rd;
+  usbdescbldr_status_t rc;
+  size_t               made = 0, parent, child, count;
+  size_t               at, linked = (size_t) -1;
+  uint8_t              op;
+  int                  repeat;
+  _last_t              last;
+
+  if(ctx == NULL || recipe == NULL || (items == NULL && itemCount != 0) ||
+     (overrides == NULL && overrideCount != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  rd.next = recipe;
+  rd.end = recipe + length;
+  rd.bad = 0;
+
+  op = _get(&rd);
+  if(op == 0 || op > USBDESCBLDR_RECIPE_VERSION)
+    return USBDESCBLDR_UNSUPPORTED;
+
+  last.op = USBDESCBLDR_KIND_NONE;
+  last.listLength = 0;
+
+  for(;;) {
+    // A flushing window session keeps no hierarchy, and makes each item
+    // over the first (see usbdescbldr_set_window_flush()).
+    at = ctx->windowFlush != NULL ? 0 : made;
+
+    op = _get(&rd);
+    if(rd.bad)
+      return USBDESCBLDR_INVALID;
+
+    if(op == USBDESCBLDR_RECIPE_END)
+      return USBDESCBLDR_OK;
+
+    if(op == USBDESCBLDR_RECORD_LINK) {
+      parent = _get_varint(&rd);
+      count = _get(&rd);
+      if(rd.bad || parent >= made)
+        return USBDESCBLDR_INVALID;
+      linked = parent;
+      while(count--) {
+        child = _get_varint(&rd);
+        if(rd.bad || child >= made)
+          return USBDESCBLDR_INVALID;
+        if(ctx->windowFlush != NULL)
+          continue;
+        rc = usbdescbldr_add_children(ctx, &items[parent], &items[child], NULL);
+        if(rc != USBDESCBLDR_OK)
+          return rc;
+      }
+      continue;
+    }
+
+    if(op == USBDESCBLDR_RECIPE_LINK_NEWEST) {
+      if(linked == (size_t) -1 || made == 0 || linked >= made - 1)
+        return USBDESCBLDR_INVALID;
+      if(ctx->windowFlush != NULL)
+        continue;
+      rc = usbdescbldr_add_children(ctx, &items[linked], &items[made - 1], NULL);
+      if(rc != USBDESCBLDR_OK)
+        return rc;
+      continue;
+    }
+
+    if(op == USBDESCBLDR_RECORD_UTF16LE) {
+      if(at >= itemCount)
+        return USBDESCBLDR_TOO_MANY;
+      last.op = USBDESCBLDR_KIND_NONE;
+      rc = _replay_utf16le(ctx, &rd, &items[at], made, overrides, overrideCount);
+      if(rc != USBDESCBLDR_OK)
+        return rc;
+      made++;
+      continue;
+    }
+
+    repeat = op == USBDESCBLDR_RECIPE_REPEAT;
+    if(repeat) {
+      op = last.op;
+      if(op == USBDESCBLDR_KIND_NONE || _ops[op].fieldCount == 0)
+        return USBDESCBLDR_INVALID;
+    }
+
+    if(op >= USBDESCBLDR_KIND_COUNT || (_ops[op].fields == NULL && _ops[op].tail == _TAIL_NONE))
+      return USBDESCBLDR_INVALID;
+    if(at >= itemCount)
+      return USBDESCBLDR_TOO_MANY;
+
+    rc = _replay_make(ctx, &rd, op, repeat, &last, &items[at], made, overrides, overrideCount);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+    made++;
+  }
+}
@@ -0,0 +1,137 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Recipes
+  //
+  // A recipe is the maker calls and links of a session, recorded as they
+  // are made, in a compact bytecode. A device can keep the recipe (in
+  // flash, say) rather than the descriptors, and replay it at boot, with
+  // any fields it likes overridden on the way. Most of the saving is in
+  // runs of like items -- the frames of a format, say -- each of which is
+  // recorded as what changed from the one before: a ladder of frames
+  // takes about 20 bytes a frame, where its descriptor takes 38.
+  //
+  // The bytecode is a version byte, then operations, then an end (0):
+  //   kind (a usbdescbldr_kind_t): the short form's fields in order, then any list
+  //   USBDESCBLDR_RECIPE_REPEAT: an item of the same kind as the one made
+  //     before: a mask of the fields which differ (bit n for field n), the
+  //     differences of those, then any list, each element as its difference
+  //     from the same element of the item before
+  //   USBDESCBLDR_RECORD_LINK: parent, count, then count children
+  //   USBDESCBLDR_RECIPE_LINK_NEWEST: link the item made last to the parent
+  //     of the last link
+  //   USBDESCBLDR_RECORD_UTF16LE: a length byte, then the string's bytes
+  // Items are numbered in the order they were made. Bytes are stored as
+  // they are; wider fields, item numbers and masks as LEB128 varints;
+  // differences as zigzag varints; lists as a count byte and their
+  // elements; strings as a length byte and their characters, in UTF-8 (or,
+  // past 255 bytes, in UTF-16LE). Nothing in it depends on the host. A
+  // string recorded in UTF-16LE is made, on replay, from the bytes in the
+  // recipe; under usbdescbldr_set_segments() they are referenced there, so
+  // the recipe must then last as long as the descriptors.
+  //
+  // Items made by the vc and vs interface makers are recorded as the
+  // standard interfaces they are.
+
+  /// The version of the bytecode written by a recorder. Replay reads
+  /// version 1 (which has no repeats) as well.
+#define USBDESCBLDR_RECIPE_VERSION   2
+
+#define USBDESCBLDR_RECIPE_REPEAT       0x83
+#define USBDESCBLDR_RECIPE_LINK_NEWEST  0x84
+
+  /// Room for the fields of any one short form, and for the start of any
+  /// one list, which a repeat is recorded against.
+#define USBDESCBLDR_RECIPE_FORM_SIZE    64
+#define USBDESCBLDR_RECIPE_HISTORY      16
+
+  /// A recorder. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_ctx_t *   ctx;
+    uint8_t *             buffer;
+    size_t                bufferSize;
+    size_t                length;     ///< Bytes of bytecode (counted, even past bufferSize)
+    size_t                items;      ///< Items made so far
+    size_t                link;       ///< Where the count of the last link is, if it was the last thing written
+    size_t                linkParent; ///< .. whose children it counts
+    size_t                linkCount;  ///< .. and how many
+    size_t                list;       ///< Where the count of the last item's list is, while more of it may come
+    size_t                listCount;  ///< .. and how many
+    uint8_t               listTail;   ///< .. of what
+    uint8_t               repeat;     ///< .. and whether it is a repeat's
+    uint8_t               lastOp;     ///< The kind of the last item made, if one may repeat it
+    uint8_t               lastForm[USBDESCBLDR_RECIPE_FORM_SIZE];   ///< .. its fields
+    uint32_t              lastList[USBDESCBLDR_RECIPE_HISTORY];     ///< .. the start of its list
+    size_t                lastListLength;                           ///< .. and the length of that
+    usbdescbldr_status_t  status;
+  } usbdescbldr_recorder_t;
+
+  /// Replace one field of one item's short form, on replay.
+  typedef struct {
+    uint16_t              item;       ///< The item, by number (in order of making, from 0)
+    uint16_t              field;      ///< offsetof() the field in the short form (0 for a string)
+    uint32_t              value;      ///< For a field
+    const char *          string;     ///< For a string descriptor, in either form (and then value is unused)
+  } usbdescbldr_recipe_override_t;
+
+  /// Start recording a session. Call this after usbdescbldr_init(),
+  /// before the maker calls.
+  ///\param [in] ctx The session.
+  ///\param [out] recorder The recorder; it must last until usbdescbldr_recipe_finish().
+  ///\param [out] buffer Where to write the recipe; NULL just to count its size.
+  ///\param [in] bufferSize The size of the buffer.
+  usbdescbldr_status_t
+    usbdescbldr_recipe_record(usbdescbldr_ctx_t *      ctx,
+                              usbdescbldr_recorder_t * recorder,
+                              uint8_t *                buffer,
+                              size_t                   bufferSize);
+
+  /// Stop recording, and end the recipe. Returns USBDESCBLDR_NO_SPACE if
+  /// the buffer was too small; length is then the size needed.
+  ///\param [in] recorder The recorder.
+  ///\param [out] length The bytes of recipe.
+  usbdescbldr_status_t
+    usbdescbldr_recipe_finish(usbdescbldr_recorder_t * recorder,
+                              size_t *                 length);
+
+  /// Make a session's descriptors from a recipe, as the recorded calls did.
+  /// The session is not closed; close it as usual afterwards.
+  ///\param [in] ctx The session, initialized, with nothing made yet.
+  ///\param [in] recipe The recipe.
+  ///\param [in] length Its length.
+  ///\param [out] items The items to make, one for each recorded (for a
+  /// flushing window session, just one).
+  ///\param [in] itemCount The number of items.
+  ///\param [in] overrides Fields to replace (optional).
+  ///\param [in] overrideCount The number of them.
+  usbdescbldr_status_t
+    usbdescbldr_recipe_replay(usbdescbldr_ctx_t *                   ctx,
+                              const uint8_t *                       recipe,
+                              size_t                                length,
+                              usbdescbldr_item_t *                  items,
+                              size_t                                itemCount,
+                              const usbdescbldr_recipe_override_t * overrides,
+                              size_t                                overrideCount);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,400 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescresponder.h"
+#include "usbdescendian.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+static void
+_span_set(usbdescbldr_span_t *span, size_t offset, size_t length)
+{
+  span->offset = (uint32_t) offset;
+  span->length = (uint16_t) length;
+}
+
+
+// The bytes at an offset, up to 'size' of them: where they lie in a
+// buffer, or gathered from segments into the scratch.
+static const uint8_t *
+_peek(const usbdescbldr_responder_t *resp, size_t offset, uint8_t *scratch, size_t size)
+{
+  size_t s, at = 0, take;
+
+  if(resp->buffer != NULL)
+    return resp->buffer + offset;
+
+  for(s = 0; s < resp->segmentCount && at < size; s++) {
+    if(offset >= resp->segments[s].length) {
+      offset -= resp->segments[s].length;
+      continue;
+    }
+
+    take = resp->segments[s].length - offset;
+    if(take > size - at)
+      take = size - at;
+    memcpy(scratch + at, resp->segments[s].data + offset, take);
+    at += take;
+    offset = 0;
+  }
+
+  return scratch;
+}
+
+
+// Walk the descriptors once. Top-level descriptors are indexed by type; configuration
+// and BOS descriptors are indexed along with all of their subordinates (which
+// are skipped over, by way of wTotalLength). Strings are assigned their indices
+// in the order they appear, just as the builder assigned them.
+static usbdescbldr_status_t
+_index(usbdescbldr_responder_t *resp)
+{
+  size_t         bufferSize = resp->bufferSize;
+  size_t         offset;
+  size_t         length;
+  unsigned int   configs = 0;
+  unsigned int   strings = 0;
+  const uint8_t *desc;
+  unsigned int   l;
+  uint8_t        scratch[2 + 2 * USBDESCBLDR_RESPONDER_MAX_LANGS];
+
+  for(offset = 0; offset < bufferSize; offset += length) {
+    // Every descriptor must at least hold its header, and fit.
+    if(bufferSize - offset < sizeof(USB_DESCRIPTOR_HEADER))
+      return USBDESCBLDR_INVALID;
+
+    desc = _peek(resp, offset, scratch,
+                 bufferSize - offset < sizeof(scratch) ? bufferSize - offset : sizeof(scratch));
+
+    length = desc[0];
+    if(length < sizeof(USB_DESCRIPTOR_HEADER) || length > bufferSize - offset)
+      return USBDESCBLDR_INVALID;
+
+    switch(desc[1]) {
+    case USB_DESCRIPTOR_TYPE_DEVICE:
+      _span_set(&resp->device, offset, length);
+      break;
+
+    case USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER:
+      _span_set(&resp->qualifier, offset, length);
+      break;
+
+    case USB_DESCRIPTOR_TYPE_CONFIGURATION:
+    case USB_DESCRIPTOR_TYPE_BOS:
+      // These carry their subordinates along with them.
+      if(desc[1] == USB_DESCRIPTOR_TYPE_BOS && length < sizeof(USB_BOS_DESCRIPTOR))
+        return USBDESCBLDR_INVALID;
+      if(desc[1] == USB_DESCRIPTOR_TYPE_CONFIGURATION && length < sizeof(USB_CONFIGURATION_DESCRIPTOR))
+        return USBDESCBLDR_INVALID;
+      length = usbdescbldr_get_le16(desc + 2);   // wTotalLength
+      if(length < desc[0] || length > bufferSize - offset)
+        return USBDESCBLDR_INVALID;
+
+      if(desc[1] == USB_DESCRIPTOR_TYPE_BOS) {
+        _span_set(&resp->bos, offset, length);
+      } else {
+        if(configs >= USBDESCBLDR_RESPONDER_MAX_CONFIGS)
+          return USBDESCBLDR_TOO_MANY;
+        _span_set(&resp->config[configs++], offset, length);
+      }
+      break;
+
+    case USB_DESCRIPTOR_TYPE_STRING:
+      if(strings >= USBDESCBLDR_RESPONDER_MAX_STRINGS)
+        return USBDESCBLDR_TOO_MANY;
+
+      // String zero is the list of languages
+      if(strings == 0) {
+        for(l = 0; l < (length - 2) / 2 && l < USBDESCBLDR_RESPONDER_MAX_LANGS; l++)
+          resp->langID[l] = usbdescbldr_get_le16(desc + 2 + 2 * l);
+        resp->langs = l;
+      }
+      _span_set(&resp->string[strings++], offset, length);
+      break;
+
+    default:
+      // Not something the host asks for by itself; step over it.
+      break;
+    }
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// The reply to a GET_DESCRIPTOR: a run of the descriptors, or (for a
+// localized string) bytes of a string table.
+typedef struct {
+  const uint8_t *data;          // The bytes, if not in the descriptors
+  size_t         offset;        // .. otherwise, where they are in them
+  size_t         length;
+} _reply_t;
+
+
+// Which descriptor a GET_DESCRIPTOR asks for, if any.
+static usbdescbldr_status_t
+_lookup(const usbdescbldr_responder_t * resp,
+        const usbdescbldr_setup_t *     setup,
+        _reply_t *                      reply)
+{
+  const usbdescbldr_span_t *span = NULL;
+  uint8_t                   type, index;
+  unsigned int              l;
+
+  if(BMREQUEST_GET_DIR(setup->bmRequestType) != BMREQUEST_DIR_DEVICE_TO_HOST ||
+     BMREQUEST_GET_TYPE(setup->bmRequestType) != BMREQUEST_TYPE_STANDARD ||
+     BMREQUEST_GET_RECIPIENT(setup->bmRequestType) != BMREQUEST_RECIPIENT_DEVICE ||
+     setup->bRequest != USB_REQUEST_GET_DESCRIPTOR)
+    return USBDESCBLDR_UNSUPPORTED;
+
+  type = (uint8_t) (setup->wValue >> 8);
+  index = (uint8_t) (setup->wValue & 0xff);
+
+  switch(type) {
+  case USB_DESCRIPTOR_TYPE_DEVICE:
+    span = &resp->device;
+    break;
+
+  case USB_DESCRIPTOR_TYPE_DEVICE_QUALIFIER:
+    span = &resp->qualifier;
+    break;
+
+  case USB_DESCRIPTOR_TYPE_BOS:
+    span = &resp->bos;
+    break;
+
+  case USB_DESCRIPTOR_TYPE_CONFIGURATION:
+    if(index < USBDESCBLDR_RESPONDER_MAX_CONFIGS)
+      span = &resp->config[index];
+    break;
+
+  case USB_DESCRIPTOR_TYPE_STRING:
+    if(index >= USBDESCBLDR_RESPONDER_MAX_STRINGS)
+      break;
+
+    // Beyond string zero, the language must be one we declared (if we declared any).
+    if(index != 0 && resp->langs != 0) {
+      for(l = 0; l < resp->langs; l++)
+        if(resp->langID[l] == setup->wIndex)
+          break;
+      if(l == resp->langs)
+        break;
+
+      // The first language is the buffer's; the others, for a localized
+      // string, are its table's.
+      if(l != 0 && resp->strings != NULL &&
+         usbdescbldr_strings_variant(resp->strings, index, l, &reply->data, &reply->length) == USBDESCBLDR_OK) {
+        reply->offset = 0;
+        return USBDESCBLDR_OK;
+      }
+    }
+    span = &resp->string[index];
+    break;
+
+  default:
+    break;
+  }
+
+  if(span == NULL || span->length == 0)
+    return USBDESCBLDR_NOT_FOUND;
+
+  reply->data = NULL;
+  reply->offset = span->offset;
+  reply->length = span->length;
+  return USBDESCBLDR_OK;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_responder_init(usbdescbldr_responder_t * resp,
+                           const usbdescbldr_ctx_t * ctx)
+{
+  if(resp == NULL || ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  // Nothing to answer with in a dry run
+  if(ctx->buffer == NULL)
+    return USBDESCBLDR_DRY_RUN;
+
+  if(ctx->segments != NULL)
+    return usbdescbldr_responder_init_segments(resp, ctx->segments, ctx->segmentCount);
+
+  return usbdescbldr_responder_init_buffer(resp, ctx->buffer, ctx->length);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_responder_init_buffer(usbdescbldr_responder_t * resp,
+                                  const uint8_t *           buffer,
+                                  size_t                    bufferSize)
+{
+  if(resp == NULL || buffer == NULL)
+    return USBDESCBLDR_INVALID;
+
+  memset(resp, 0, sizeof(*resp));
+  resp->buffer = buffer;
+  resp->bufferSize = bufferSize;
+
+  return _index(resp);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_responder_init_segments(usbdescbldr_responder_t *     resp,
+                                    const usbdescbldr_segment_t * segments,
+                                    size_t                        count)
+{
+  size_t s;
+
+  if(resp == NULL || (segments == NULL && count != 0))
+    return USBDESCBLDR_INVALID;
+
+  memset(resp, 0, sizeof(*resp));
+  resp->segments = segments;
+  resp->segmentCount = count;
+  for(s = 0; s < count; s++)
+    resp->bufferSize += segments[s].length;
+
+  return _index(resp);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_responder_set_strings(usbdescbldr_responder_t *     resp,
+                                  const usbdescbldr_strings_t * tab)
+{
+  if(resp == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(tab != NULL && (tab->langs != resp->langs ||
+                     memcmp(tab->langID, resp->langID, tab->langs * sizeof(tab->langID[0])) != 0))
+    return USBDESCBLDR_INVALID;
+
+  resp->strings = tab;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_responder_find(const usbdescbldr_responder_t * resp,
+                           const usbdescbldr_setup_t *     setup,
+                           size_t *                        offset,
+                           size_t *                        length)
+{
+  _reply_t             reply;
+  usbdescbldr_status_t rc;
+
+  if(resp == NULL || setup == NULL || offset == NULL || length == NULL)
+    return USBDESCBLDR_INVALID;
+
+  rc = _lookup(resp, setup, &reply);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  if(reply.data != NULL)
+    return USBDESCBLDR_UNSUPPORTED;
+
+  *offset = reply.offset;
+  *length = reply.length < setup->wLength ? reply.length : setup->wLength;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_responder_get_descriptor(const usbdescbldr_responder_t * resp,
+                                     const usbdescbldr_setup_t *     setup,
+                                     const uint8_t **                data,
+                                     size_t *                        length)
+{
+  _reply_t              reply;
+  usbdescbldr_segment_t slice;
+  size_t                count;
+  usbdescbldr_status_t  rc;
+
+  if(resp == NULL || setup == NULL || data == NULL || length == NULL)
+    return USBDESCBLDR_INVALID;
+
+  rc = _lookup(resp, setup, &reply);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  *length = reply.length < setup->wLength ? reply.length : setup->wLength;
+
+  if(reply.data != NULL) {
+    *data = reply.data;
+    return USBDESCBLDR_OK;
+  }
+
+  if(resp->buffer != NULL) {
+    *data = resp->buffer + reply.offset;
+    return USBDESCBLDR_OK;
+  }
+
+  rc = usbdescbldr_slice_segments(resp->segments, resp->segmentCount, reply.offset, *length,
+                                  &slice, 1, &count);
+  if(rc != USBDESCBLDR_OK)
+    return rc == USBDESCBLDR_NO_SPACE ? USBDESCBLDR_UNSUPPORTED : rc;
+
+  *data = count != 0 ? slice.data : NULL;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_responder_get_segments(const usbdescbldr_responder_t * resp,
+                                   const usbdescbldr_setup_t *     setup,
+                                   usbdescbldr_segment_t *         slice,
+                                   size_t                          sliceCapacity,
+                                   size_t *                        sliceCount)
+{
+  _reply_t              reply;
+  usbdescbldr_segment_t whole;
+  size_t                length;
+  usbdescbldr_status_t  rc;
+
+  if(resp == NULL || setup == NULL || sliceCount == NULL ||
+     (slice == NULL && sliceCapacity != 0))
+    return USBDESCBLDR_INVALID;
+
+  rc = _lookup(resp, setup, &reply);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  length = reply.length < setup->wLength ? reply.length : setup->wLength;
+
+  // A localized string, or a buffer, is one piece.
+  if(reply.data != NULL) {
+    whole.data = reply.data;
+    whole.length = reply.length;
+    return usbdescbldr_slice_segments(&whole, 1, 0, length, slice, sliceCapacity, sliceCount);
+  }
+
+  if(resp->buffer != NULL) {
+    whole.data = resp->buffer;
+    whole.length = resp->bufferSize;
+    return usbdescbldr_slice_segments(&whole, 1, reply.offset, length,
+                                      slice, sliceCapacity, sliceCount);
+  }
+
+  return usbdescbldr_slice_segments(resp->segments, resp->segmentCount, reply.offset, length,
+                                    slice, sliceCapacity, sliceCount);
+}
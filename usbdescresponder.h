@@ -0,0 +1,172 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+#include "usbdescstrings.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Responder
+  //
+  // Once a descriptor set has been built (and closed), the host will ask
+  // for pieces of it over and over during enumeration. The responder
+  // indexes the finished buffer a single time, so that each GET_DESCRIPTOR
+  // is answered with a table lookup rather than a walk of the buffer.
+  // Answers point into the built buffer; nothing is copied. Descriptors
+  // built with a segment list (see usbdescbldr_set_segments()) are
+  // answered with the pieces of each reply, for a DMA engine to gather.
+  //
+  // Strings are answered in the one language the buffer holds them in,
+  // whichever of string zero's LANGIDs is asked for; a string table's
+  // localized strings (see usbdescbldr_responder_set_strings()) in the
+  // language asked for.
+  //
+  // Like the builder context, the responder is provided by the caller and
+  // the API does not allocate.
+
+  /// Number of configuration descriptors the responder can index.
+#define USBDESCBLDR_RESPONDER_MAX_CONFIGS   4
+
+  /// Number of string indices (including index 0, the LANGIDs) the responder can index.
+#define USBDESCBLDR_RESPONDER_MAX_STRINGS   64
+
+  /// Number of LANGIDs from string index 0 the responder will honor.
+#define USBDESCBLDR_RESPONDER_MAX_LANGS     8
+
+  /// A SETUP packet, with the multi-byte fields already in host order.
+  typedef struct {
+    uint8_t  bmRequestType;
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+  } usbdescbldr_setup_t;
+
+  /// Where one descriptor (with any subordinates) lives in the buffer.
+  /// A length of zero marks an absent descriptor.
+  typedef struct {
+    uint32_t offset;
+    uint16_t length;
+  } usbdescbldr_span_t;
+
+  /// The responder. Callers should treat this as 'read only'.
+  typedef struct {
+    const uint8_t *    buffer;
+    size_t             bufferSize;                               ///< (With segments, the bytes in all of them)
+    const usbdescbldr_segment_t * segments;
+    size_t             segmentCount;
+
+    usbdescbldr_span_t device;
+    usbdescbldr_span_t qualifier;
+    usbdescbldr_span_t bos;
+    usbdescbldr_span_t config[USBDESCBLDR_RESPONDER_MAX_CONFIGS];
+    usbdescbldr_span_t string[USBDESCBLDR_RESPONDER_MAX_STRINGS];
+
+    unsigned int       langs;                                    ///< Number of LANGIDs found in string index 0
+    uint16_t           langID[USBDESCBLDR_RESPONDER_MAX_LANGS];
+
+    const usbdescbldr_strings_t * strings;                       ///< Localized strings, if set
+  } usbdescbldr_responder_t;
+
+  /// Index the descriptors built by a context. Call this once, after
+  /// usbdescbldr_close(). The context's buffer must not be changed
+  /// afterwards for as long as the responder is in use.
+  ///\param [out] resp The responder to be initialized.
+  ///\param [in] ctx A closed context with a (non dry-run) buffer.
+  usbdescbldr_status_t
+    usbdescbldr_responder_init(usbdescbldr_responder_t *  resp,
+                               const usbdescbldr_ctx_t *  ctx);
+
+  /// Index a flat buffer of descriptors, as produced by the builder.
+  ///\param [out] resp The responder to be initialized.
+  ///\param [in] buffer The descriptors.
+  ///\param [in] bufferSize The number of bytes of descriptors in the buffer.
+  usbdescbldr_status_t
+    usbdescbldr_responder_init_buffer(usbdescbldr_responder_t * resp,
+                                      const uint8_t *           buffer,
+                                      size_t                    bufferSize);
+
+  /// Index descriptors in pieces, as listed by usbdescbldr_get_segments().
+  /// The list, and what it points at, must not change afterwards for as
+  /// long as the responder is in use.
+  ///\param [out] resp The responder to be initialized.
+  ///\param [in] segments The pieces of the descriptors.
+  ///\param [in] count The number of pieces.
+  usbdescbldr_status_t
+    usbdescbldr_responder_init_segments(usbdescbldr_responder_t *     resp,
+                                        const usbdescbldr_segment_t * segments,
+                                        size_t                        count);
+
+  /// Answer for the localized strings of a string table. Its languages must
+  /// be string zero's, in the same order (USBDESCBLDR_INVALID otherwise).
+  /// The table must not change for as long as the responder is in use.
+  ///\param [in] resp The responder.
+  ///\param [in] tab The string table, or NULL to answer from the buffer alone.
+  usbdescbldr_status_t
+    usbdescbldr_responder_set_strings(usbdescbldr_responder_t *     resp,
+                                      const usbdescbldr_strings_t * tab);
+
+  /// Answer a standard GET_DESCRIPTOR request. On success, data and length
+  /// describe the bytes to return in the data stage (already truncated to wLength).
+  /// Requests which are not a standard, device-to-host GET_DESCRIPTOR to the device
+  /// yield USBDESCBLDR_UNSUPPORTED; descriptors which do not exist yield
+  /// USBDESCBLDR_NOT_FOUND. Either should be answered with a STALL.
+  ///\param [in] resp The responder.
+  ///\param [in] setup The SETUP packet from the host.
+  ///\param [out] data Start of the descriptor bytes to send.
+  ///\param [out] length The number of bytes to send.
+  /// A responder of segments answers here only when the reply lies in one
+  /// piece; otherwise, with USBDESCBLDR_UNSUPPORTED.
+  usbdescbldr_status_t
+    usbdescbldr_responder_get_descriptor(const usbdescbldr_responder_t * resp,
+                                         const usbdescbldr_setup_t *     setup,
+                                         const uint8_t **                data,
+                                         size_t *                        length);
+
+  /// Find the reply to a standard GET_DESCRIPTOR request, as
+  /// usbdescbldr_responder_get_descriptor() does, as a run of the descriptors.
+  /// A localized string lies in its table, not the descriptors, and yields
+  /// USBDESCBLDR_UNSUPPORTED.
+  ///\param [in] resp The responder.
+  ///\param [in] setup The SETUP packet from the host.
+  ///\param [out] offset Where the reply starts, in the descriptors.
+  ///\param [out] length The number of bytes to send.
+  usbdescbldr_status_t
+    usbdescbldr_responder_find(const usbdescbldr_responder_t * resp,
+                               const usbdescbldr_setup_t *     setup,
+                               size_t *                        offset,
+                               size_t *                        length);
+
+  /// Answer a standard GET_DESCRIPTOR request, as usbdescbldr_responder_get_descriptor()
+  /// does, with the pieces of the data stage: a gather list for the
+  /// endpoint's DMA. Any responder can answer this way.
+  ///\param [in] resp The responder.
+  ///\param [in] setup The SETUP packet from the host.
+  ///\param [out] slice The pieces to send, in order.
+  ///\param [in] sliceCapacity The number of pieces there is room for.
+  ///\param [out] sliceCount The number of pieces to send.
+  usbdescbldr_status_t
+    usbdescbldr_responder_get_segments(const usbdescbldr_responder_t * resp,
+                                       const usbdescbldr_setup_t *     setup,
+                                       usbdescbldr_segment_t *         slice,
+                                       size_t                          sliceCapacity,
+                                       size_t *                        sliceCount);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,241 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "usbdescstream.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// One pass: where it is in the table of fixups, and where its windows go.
+typedef struct {
+  const usbdescbldr_stream_t * stream;
+  size_t                       fixup;   // The first which may fall in the window
+  usbdescbldr_stream_send_t    send;    // NULL to keep the one window
+  void *                       user;
+} _pass_t;
+
+
+static usbdescbldr_status_t
+_replay(usbdescbldr_ctx_t *ctx, void *user)
+{
+  usbdescbldr_stream_t *stream = (usbdescbldr_stream_t *) user;
+
+  return usbdescbldr_recipe_replay(ctx, stream->recipe, stream->recipeLength,
+                                   stream->items, stream->itemCount,
+                                   stream->overrides, stream->overrideCount);
+}
+
+
+// Put the totals and counts in a window, and hand it on. Windows come in
+// order, so the table is gone through once a pass.
+static int
+_flush(void *user, unsigned char *window, size_t offset, size_t length)
+{
+  _pass_t *                   pass = (_pass_t *) user;
+  const usbdescbldr_fixup_t * fp;
+  size_t                      f, b;
+
+  for(f = pass->fixup; f < pass->stream->fixupCount; f++) {
+    fp = &pass->stream->fixups[f];
+    if(fp->offset >= offset + length)
+      break;
+    if(fp->offset + fp->size <= offset) {
+      pass->fixup = f + 1;
+      continue;
+    }
+
+    // (A field may lie across two windows.)
+    for(b = 0; b < fp->size; b++) {
+      if(fp->offset + b >= offset && fp->offset + b < offset + length)
+        window[fp->offset + b - offset] = (uint8_t) (fp->value >> (8 * b));
+    }
+  }
+
+  if(pass->send == NULL)
+    return USBDESCBLDR_OK;
+  return pass->send(pass->user, window, length);
+}
+
+
+// Make a run of the descriptors in one pass, a window at a time.
+static usbdescbldr_status_t
+_run(usbdescbldr_stream_t *stream, uint8_t *window, size_t windowLength,
+     size_t offset, size_t length, usbdescbldr_stream_send_t send, void *user)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+  _pass_t              pass;
+
+  pass.stream = stream;
+  pass.fixup = 0;
+  pass.send = send;
+  pass.user = user;
+
+  if((rc = usbdescbldr_init(&ctx, stream->scratch, sizeof(stream->scratch))) == USBDESCBLDR_OK &&
+     (rc = usbdescbldr_set_window(&ctx, window, offset, windowLength)) == USBDESCBLDR_OK &&
+     (rc = usbdescbldr_set_window_flush(&ctx, _flush, &pass, offset + length)) == USBDESCBLDR_OK &&
+     (rc = usbdescbldr_set_item_arena(&ctx, &stream->item, sizeof(stream->item))) == USBDESCBLDR_OK &&
+     (rc = stream->build(&ctx, stream->user)) == USBDESCBLDR_OK)
+    rc = usbdescbldr_close(&ctx);
+
+  // The same calls must make the same bytes every time.
+  if(rc == USBDESCBLDR_OK && ctx.length != stream->length)
+    rc = USBDESCBLDR_INVALID;
+
+  usbdescbldr_end(&ctx);
+  return rc;
+}
+
+
+// The dry run: the size of the descriptors, and their totals and counts,
+// in order of offset.
+static usbdescbldr_status_t
+_size(usbdescbldr_stream_t *stream, void *arena, size_t arenaSize,
+      usbdescbldr_fixup_t *fixups, size_t fixupCapacity)
+{
+  usbdescbldr_ctx_t    ctx;
+  usbdescbldr_status_t rc;
+  usbdescbldr_fixup_t  fixup;
+  size_t               f, g;
+
+  if((rc = usbdescbldr_init(&ctx, NULL, 0)) == USBDESCBLDR_OK &&
+     (rc = usbdescbldr_set_item_arena(&ctx, arena, arenaSize)) == USBDESCBLDR_OK &&
+     (rc = usbdescbldr_set_fixups(&ctx, fixups, fixupCapacity)) == USBDESCBLDR_OK &&
+     (rc = stream->build(&ctx, stream->user)) == USBDESCBLDR_OK)
+    rc = usbdescbldr_close(&ctx);
+
+  if(rc == USBDESCBLDR_OK) {
+    stream->length = ctx.length;
+    stream->fixups = fixups;
+    stream->fixupCount = ctx.fixupCount;
+  }
+  usbdescbldr_end(&ctx);
+
+  // Close works from the innermost out; the table is small, and nearly
+  // in order already.
+  for(f = 1; f < stream->fixupCount; f++) {
+    fixup = fixups[f];
+    for(g = f; g > 0 && fixups[g - 1].offset > fixup.offset; g--)
+      fixups[g] = fixups[g - 1];
+    fixups[g] = fixup;
+  }
+
+  return rc;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_stream_init(usbdescbldr_stream_t *     stream,
+                        usbdescbldr_stream_build_t build,
+                        void *                     user,
+                        void *                     arena,
+                        size_t                     arenaSize,
+                        usbdescbldr_fixup_t *      fixups,
+                        size_t                     fixupCapacity)
+{
+  if(stream == NULL || build == NULL || (fixups == NULL && fixupCapacity != 0))
+    return USBDESCBLDR_INVALID;
+
+  memset(stream, 0, sizeof(*stream));
+  stream->build = build;
+  stream->user = user;
+
+  return _size(stream, arena, arenaSize, fixups, fixupCapacity);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_stream_init_recipe(usbdescbldr_stream_t *                stream,
+                               const uint8_t *                       recipe,
+                               size_t                                recipeLength,
+                               usbdescbldr_item_t *                  items,
+                               size_t                                itemCount,
+                               const usbdescbldr_recipe_override_t * overrides,
+                               size_t                                overrideCount,
+                               usbdescbldr_fixup_t *                 fixups,
+                               size_t                                fixupCapacity)
+{
+  usbdescbldr_status_t rc;
+
+  if(stream == NULL || recipe == NULL || (items == NULL && itemCount != 0) ||
+     (overrides == NULL && overrideCount != 0) || (fixups == NULL && fixupCapacity != 0))
+    return USBDESCBLDR_INVALID;
+
+  memset(stream, 0, sizeof(*stream));
+  stream->build = _replay;
+  stream->user = stream;
+  stream->recipe = recipe;
+  stream->recipeLength = recipeLength;
+  stream->items = items;
+  stream->itemCount = itemCount;
+  stream->overrides = overrides;
+  stream->overrideCount = overrideCount;
+
+  rc = _size(stream, NULL, 0, fixups, fixupCapacity);
+
+  // Each pass makes its items over the stream's one.
+  stream->items = &stream->item;
+  stream->itemCount = 1;
+  return rc;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_stream_read(usbdescbldr_stream_t * stream,
+                        size_t                 offset,
+                        uint8_t *              dest,
+                        size_t                 length,
+                        size_t *               made)
+{
+  usbdescbldr_status_t rc;
+
+  if(stream == NULL || stream->build == NULL || dest == NULL || made == NULL)
+    return USBDESCBLDR_INVALID;
+
+  *made = 0;
+  if(offset >= stream->length || length == 0)
+    return USBDESCBLDR_OK;
+  if(length > stream->length - offset)
+    length = stream->length - offset;
+
+  rc = _run(stream, dest, length, offset, length, NULL, NULL);
+  if(rc == USBDESCBLDR_OK)
+    *made = length;
+
+  return rc;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_stream_send(usbdescbldr_stream_t *    stream,
+                        size_t                    offset,
+                        size_t                    length,
+                        uint8_t *                 packet,
+                        size_t                    packetSize,
+                        usbdescbldr_stream_send_t send,
+                        void *                    user)
+{
+  if(stream == NULL || stream->build == NULL || packet == NULL || packetSize == 0 || send == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(offset >= stream->length || length == 0)
+    return USBDESCBLDR_OK;
+  if(length > stream->length - offset)
+    length = stream->length - offset;
+
+  return _run(stream, packet, packetSize, offset, length, send, user);
+}
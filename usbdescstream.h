@@ -0,0 +1,152 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+#include "usbdescrecipe.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Streams
+  //
+  // For devices with no room for the descriptors themselves. A stream
+  // makes any run of them on demand -- a control transfer's worth, or
+  // just one packet -- by running the maker calls (or replaying a recipe)
+  // as a flushing window session (see usbdescbldr_set_window_flush()):
+  // one pass over the maker calls makes the whole run, a window at a time.
+  //
+  // The totals and counts in a container can depend on descriptors made
+  // after it, so they are worked out once, by a dry run when the stream
+  // begins, and kept in a table of fixups (one for each total or count;
+  // see usbdescbldr_set_fixups()); each pass puts them in as its windows
+  // fill. After that a stream needs only its table, one item, a scratch
+  // for one descriptor, and the window -- not the items of the whole.
+
+  /// A stream's maker calls: make and link the items, as for a session of
+  /// your own, taking each from usbdescbldr_item_alloc(); the stream opens
+  /// and closes the session. It is called once to learn the size and layout
+  /// of the descriptors, and once more for every run made; it must make the
+  /// same calls each time.
+  typedef usbdescbldr_status_t (*usbdescbldr_stream_build_t)(usbdescbldr_ctx_t *ctx, void *user);
+
+  /// Sends one packet of a transfer: the bytes are in the packet buffer
+  /// given to usbdescbldr_stream_send() (which may be the endpoint's FIFO).
+  typedef usbdescbldr_status_t (*usbdescbldr_stream_send_t)(void *user, const uint8_t *packet, size_t length);
+
+  /// The stream. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_stream_build_t            build;
+    void *                                user;
+
+    // For a stream of a recipe:
+    const uint8_t *                       recipe;
+    size_t                                recipeLength;
+    usbdescbldr_item_t *                  items;    ///< The caller's for the dry run, then the stream's one
+    size_t                                itemCount;
+    const usbdescbldr_recipe_override_t * overrides;
+    size_t                                overrideCount;
+
+    usbdescbldr_fixup_t *                 fixups;   ///< Totals and counts, by offset
+    size_t                                fixupCount;
+    size_t                                length;   ///< Bytes of descriptors, in all
+    usbdescbldr_item_t                    item;     ///< Made over by each pass
+    unsigned char                         scratch[USBDESCBLDR_FINGERPRINT_WINDOW];
+  } usbdescbldr_stream_t;
+
+  /// Begin a stream of the descriptors made by a function of the caller's.
+  /// The maker calls are run once, as a dry run, to work out the size of
+  /// the descriptors and the table of totals and counts.
+  ///\param [out] stream The stream.
+  ///\param [in] build The maker calls.
+  ///\param [in] user Passed to build.
+  ///\param [in] arena Storage for the items of the dry run (see
+  /// usbdescbldr_set_item_arena()); it is not needed once this returns.
+  ///\param [in] arenaSize The size in bytes of the arena.
+  ///\param [out] fixups Storage for the table; it must last as long as the stream.
+  ///\param [in] fixupCapacity The number of entries there is storage for (one
+  /// for each total and each count: two for each container will do).
+  usbdescbldr_status_t
+    usbdescbldr_stream_init(usbdescbldr_stream_t *     stream,
+                            usbdescbldr_stream_build_t build,
+                            void *                     user,
+                            void *                     arena,
+                            size_t                     arenaSize,
+                            usbdescbldr_fixup_t *      fixups,
+                            size_t                     fixupCapacity);
+
+  /// Begin a stream of the descriptors a recipe makes (see usbdescrecipe.h).
+  /// The recipe and overrides must last as long as the stream.
+  ///\param [out] stream The stream.
+  ///\param [in] recipe The recipe.
+  ///\param [in] recipeLength Its length.
+  ///\param [out] items The items, one for each recorded; for the dry run
+  /// only, so not needed once this returns.
+  ///\param [in] itemCount The number of items.
+  ///\param [in] overrides Fields to replace (optional).
+  ///\param [in] overrideCount The number of them.
+  ///\param [out] fixups Storage for the table; it must last as long as the stream.
+  ///\param [in] fixupCapacity The number of entries there is storage for.
+  usbdescbldr_status_t
+    usbdescbldr_stream_init_recipe(usbdescbldr_stream_t *                stream,
+                                   const uint8_t *                       recipe,
+                                   size_t                                recipeLength,
+                                   usbdescbldr_item_t *                  items,
+                                   size_t                                itemCount,
+                                   const usbdescbldr_recipe_override_t * overrides,
+                                   size_t                                overrideCount,
+                                   usbdescbldr_fixup_t *                 fixups,
+                                   size_t                                fixupCapacity);
+
+  /// Make one window of the descriptors, in one pass. A window reaching
+  /// past the end is cut short.
+  ///\param [in] stream The stream.
+  ///\param [in] offset The offset of the first byte wanted.
+  ///\param [out] dest Where to put the bytes.
+  ///\param [in] length The number of bytes wanted.
+  ///\param [out] made The number of bytes made.
+  usbdescbldr_status_t
+    usbdescbldr_stream_read(usbdescbldr_stream_t * stream,
+                            size_t                 offset,
+                            uint8_t *              dest,
+                            size_t                 length,
+                            size_t *               made);
+
+  /// Send a run of the descriptors (a reply to GET_DESCRIPTOR, say) a
+  /// packet at a time, in one pass: each packet is made into the packet
+  /// buffer, and sent as soon as it is full. A run which ends short of
+  /// wLength on a packet boundary should be followed by a zero-length
+  /// packet; that is the caller's to send.
+  ///\param [in] stream The stream.
+  ///\param [in] offset The offset of the first byte.
+  ///\param [in] length The number of bytes (past the end, cut short).
+  ///\param [out] packet The packet buffer.
+  ///\param [in] packetSize The size of a packet (wMaxPacketSize0).
+  ///\param [in] send Sends each packet; a status other than USBDESCBLDR_OK
+  /// stops the sending, and is returned.
+  ///\param [in] user Passed to send.
+  usbdescbldr_status_t
+    usbdescbldr_stream_send(usbdescbldr_stream_t *    stream,
+                            size_t                    offset,
+                            size_t                    length,
+                            uint8_t *                 packet,
+                            size_t                    packetSize,
+                            usbdescbldr_stream_send_t send,
+                            void *                    user);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,321 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdescstrings.h"
+#include "usbdescutf8.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// The most characters a string descriptor can hold
+#define USBDESCBLDR_STRING_MAX_CHARS   ((0xff - sizeof(USB_DESCRIPTOR_HEADER)) / sizeof(uint16_t))
+
+// Hashes are 32-bit FNV-1a, of the LANGID and then the characters (of
+// each language, with the NUL after each).
+#define USBDESCBLDR_FNV32_OFFSET  0x811c9dc5u
+#define USBDESCBLDR_FNV32_PRIME   0x01000193u
+
+static uint32_t
+_hash(uint16_t langID, const char * const *strings, size_t languages)
+{
+  uint32_t    hash = USBDESCBLDR_FNV32_OFFSET;
+  const char *c;
+  size_t      l;
+
+  hash = (hash ^ (langID & 0xff)) * USBDESCBLDR_FNV32_PRIME;
+  hash = (hash ^ (langID >> 8)) * USBDESCBLDR_FNV32_PRIME;
+  for(l = 0; l < languages; l++) {
+    for(c = strings[l]; *c; c++)
+      hash = (hash ^ (uint8_t) *c) * USBDESCBLDR_FNV32_PRIME;
+    hash *= USBDESCBLDR_FNV32_PRIME;
+  }
+
+  return hash;
+}
+
+
+// Whether an entry holds these strings.
+static int
+_same(const usbdescbldr_string_entry_t *entry, uint16_t langID,
+      const char * const *strings, size_t languages)
+{
+  const char *kept = entry->string;
+  size_t      l;
+
+  if(entry->langID != langID || entry->languages != languages)
+    return 0;
+
+  for(l = 0; l < languages; l++) {
+    if(strcmp(kept, strings[l]) != 0)
+      return 0;
+    kept += strlen(kept) + 1;
+  }
+
+  return 1;
+}
+
+
+// The slot holding a string, or the free slot where it would go. With the
+// table at most half full, there is always a free one.
+static uint8_t *
+_slot(usbdescbldr_strings_t *tab, uint32_t hash, uint16_t langID,
+      const char * const *strings, size_t languages)
+{
+  const usbdescbldr_string_entry_t *entry;
+  size_t                            s = hash & (USBDESCBLDR_STRINGS_SLOTS - 1);
+
+  for(;;) {
+    if(tab->slot[s] == 0)
+      return &tab->slot[s];
+
+    entry = &tab->entries[tab->slot[s] - 1];
+    if(entry->hash == hash && _same(entry, langID, strings, languages))
+      return &tab->slot[s];
+
+    s = (s + 1) & (USBDESCBLDR_STRINGS_SLOTS - 1);
+  }
+}
+
+
+// Intern a string in one language, or in each of the table's. The strings
+// have been checked; a localized string's descriptors are made here.
+static usbdescbldr_status_t
+_intern(usbdescbldr_strings_t *tab, uint16_t langID, const char * const *strings,
+        size_t languages, const size_t *units, uint8_t *index)
+{
+  usbdescbldr_string_entry_t *entry;
+  uint8_t *                   slot;
+  uint8_t *                   dest;
+  uint32_t                    hash;
+  size_t                      l, length, chars = 0, needs = 0, made;
+
+  tab->interned++;
+
+  hash = _hash(langID, strings, languages);
+  slot = _slot(tab, hash, langID, strings, languages);
+  if(*slot != 0) {
+    *index = tab->entries[*slot - 1].index;
+    return USBDESCBLDR_OK;
+  }
+
+  // A new string: it needs an entry, an index, and room in the pool (and
+  // for its descriptors, if localized).
+  for(l = 0; l < languages; l++) {
+    chars += strlen(strings[l]) + 1;
+    if(languages > 1)
+      needs += sizeof(USB_DESCRIPTOR_HEADER) + units[l] * sizeof(uint16_t);
+  }
+
+  if(tab->count >= tab->entryCapacity || tab->base + tab->count > 0xff)
+    return USBDESCBLDR_TOO_MANY;
+  if(chars > tab->poolSize - tab->poolLength || needs > tab->descriptorsSize - tab->descriptorsLength)
+    return USBDESCBLDR_NO_SPACE;
+
+  entry = &tab->entries[tab->count];
+  memset(entry, 0, sizeof(*entry));
+  entry->string = tab->pool + tab->poolLength;
+  entry->hash = hash;
+  entry->langID = langID;
+  entry->index = (uint8_t) (tab->base + tab->count);
+  entry->languages = (uint8_t) languages;
+
+  for(l = 0; l < languages; l++) {
+    length = strlen(strings[l]);
+    memcpy(tab->pool + tab->poolLength, strings[l], length + 1);
+    tab->poolLength += length + 1;
+
+    if(languages > 1) {
+      dest = tab->descriptors + tab->descriptorsLength;
+      dest[0] = (uint8_t) (sizeof(USB_DESCRIPTOR_HEADER) + units[l] * sizeof(uint16_t));
+      dest[1] = USB_DESCRIPTOR_TYPE_STRING;
+      usbdescbldr_utf8_to_utf16le(dest + sizeof(USB_DESCRIPTOR_HEADER), dest[0] - sizeof(USB_DESCRIPTOR_HEADER),
+                                  strings[l], length, &made);
+      entry->variant[l] = (uint32_t) tab->descriptorsLength;
+      tab->descriptorsLength += dest[0];
+    }
+  }
+
+  tab->count++;
+  *slot = (uint8_t) tab->count;
+
+  *index = entry->index;
+  return USBDESCBLDR_OK;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_strings_init(usbdescbldr_strings_t *      tab,
+                         usbdescbldr_ctx_t *          ctx,
+                         usbdescbldr_string_entry_t * entries,
+                         size_t                       entryCapacity,
+                         char *                       pool,
+                         size_t                       poolSize)
+{
+  if(tab == NULL || ctx == NULL || (entries == NULL && entryCapacity != 0) ||
+     (pool == NULL && poolSize != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  memset(tab, 0, sizeof(*tab));
+  tab->ctx = ctx;
+  tab->entries = entries;
+  tab->entryCapacity = entryCapacity;
+  tab->pool = pool;
+  tab->poolSize = poolSize;
+
+  // String zero is the LANGIDs, whether or not they have been made yet.
+  tab->base = ctx->i_string > 0 ? ctx->i_string : 1;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_strings_intern(usbdescbldr_strings_t * tab,
+                           uint16_t                langID,
+                           const char *            string,
+                           uint8_t *               index)
+{
+  size_t               units;
+  usbdescbldr_status_t rc;
+
+  if(tab == NULL || string == NULL || index == NULL)
+    return USBDESCBLDR_INVALID;
+
+  rc = usbdescbldr_utf8z_to_utf16le(NULL, 0, string, &units);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+  units /= sizeof(uint16_t);
+  if(units > USBDESCBLDR_STRING_MAX_CHARS)
+    return USBDESCBLDR_OVERSIZED;
+
+  return _intern(tab, langID, &string, 1, &units, index);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_strings_set_languages(usbdescbldr_strings_t * tab,
+                                  const uint16_t *        langIDs,
+                                  size_t                  count,
+                                  uint8_t *               descriptors,
+                                  size_t                  descriptorsSize)
+{
+  size_t s;
+
+  if(tab == NULL || (langIDs == NULL && count != 0) || (descriptors == NULL && descriptorsSize != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(count > USBDESCBLDR_STRINGS_MAX_LANGS)
+    return USBDESCBLDR_TOO_MANY;
+
+  // Not once localized strings have been interned in the old ones
+  for(s = 0; s < tab->count; s++)
+    if(tab->entries[s].languages > 1)
+      return USBDESCBLDR_INVALID;
+
+  tab->langs = (unsigned int) count;
+  if(count != 0)
+    memcpy(tab->langID, langIDs, count * sizeof(*langIDs));
+  tab->descriptors = descriptors;
+  tab->descriptorsSize = descriptorsSize;
+  tab->descriptorsLength = 0;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_strings_intern_localized(usbdescbldr_strings_t * tab,
+                                     const char * const *    strings,
+                                     uint8_t *               index)
+{
+  size_t               units[USBDESCBLDR_STRINGS_MAX_LANGS];
+  size_t               l;
+  usbdescbldr_status_t rc;
+
+  if(tab == NULL || strings == NULL || index == NULL)
+    return USBDESCBLDR_INVALID;
+
+  // With fewer than two languages, there is nothing to localize.
+  if(tab->langs < 2)
+    return USBDESCBLDR_INVALID;
+
+  for(l = 0; l < tab->langs; l++) {
+    if(strings[l] == NULL)
+      return USBDESCBLDR_INVALID;
+    rc = usbdescbldr_utf8z_to_utf16le(NULL, 0, strings[l], &units[l]);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+    units[l] /= sizeof(uint16_t);
+    if(units[l] > USBDESCBLDR_STRING_MAX_CHARS)
+      return USBDESCBLDR_OVERSIZED;
+  }
+
+  return _intern(tab, 0, strings, tab->langs, units, index);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_strings_variant(const usbdescbldr_strings_t * tab,
+                            unsigned int                  index,
+                            unsigned int                  lang,
+                            const uint8_t **              data,
+                            size_t *                      length)
+{
+  const usbdescbldr_string_entry_t *entry;
+
+  if(tab == NULL || data == NULL || length == NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(index < tab->base || index - tab->base >= tab->count)
+    return USBDESCBLDR_NOT_FOUND;
+
+  entry = &tab->entries[index - tab->base];
+  if(entry->languages < 2 || lang >= entry->languages)
+    return USBDESCBLDR_NOT_FOUND;
+
+  *data = tab->descriptors + entry->variant[lang];
+  *length = (*data)[0];
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_strings_make(usbdescbldr_strings_t * tab)
+{
+  usbdescbldr_string_entry_t *entry;
+  usbdescbldr_status_t        rc;
+
+  if(tab == NULL || tab->ctx == NULL)
+    return USBDESCBLDR_INVALID;
+
+  // The next string made must be the next one of ours.
+  if(tab->made < tab->count && tab->ctx->i_string != tab->base + tab->made)
+    return USBDESCBLDR_INVALID;
+
+  for(; tab->made < tab->count; tab->made++) {
+    entry = &tab->entries[tab->made];
+    rc = usbdescbldr_make_string_descriptor(tab->ctx, &entry->item, NULL, entry->string);
+    if(rc != USBDESCBLDR_OK)
+      return rc;
+  }
+
+  return USBDESCBLDR_OK;
+}
@@ -0,0 +1,167 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // String tables
+  //
+  // A composite device names the same interfaces, units and formats over
+  // and over. Each usbdescbldr_make_string_descriptor() is a new string,
+  // and a new index, of which there are only 255; the host reads every
+  // one of them as it enumerates.
+  //
+  // A string table hands out one index per distinct string (and LANGID):
+  // interning a string it has seen before gives the index it gave then.
+  // The strings are kept, in order, in a pool of the caller's, and are
+  // made only when usbdescbldr_strings_make() is called: one after
+  // another, in index order, wherever the session is then. So the maker
+  // calls that need an index (device, configuration, interface ..) can
+  // come first, and the strings, together, after them.
+  //
+  // The table takes over string indices from the point it is set up: the
+  // LANGIDs (string zero) and any strings made directly must be made
+  // before then. Like the rest of the builder, it does not allocate.
+  //
+  // A table can also hold strings in several languages. Given the LANGIDs
+  // (as made in string zero) and room for descriptors, each string
+  // interned with usbdescbldr_strings_intern_localized() takes one index
+  // and has its descriptor in every language made at once, the languages
+  // packed together, in order. The session gets the first language's, as
+  // for any other string; the responder answers the rest from the table
+  // (see usbdescbldr_responder_set_strings()), found by index and language
+  // without a search.
+
+  /// Slots in a table's hash; enough to keep it at most half full.
+#define USBDESCBLDR_STRINGS_SLOTS   512
+
+  /// Languages a table can hold strings in.
+#define USBDESCBLDR_STRINGS_MAX_LANGS   8
+
+  /// One string. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_item_t    item;       ///< The string descriptor, once made
+    const char *          string;     ///< The string, in the pool (in each language, one after another)
+    uint32_t              hash;
+    uint16_t              langID;
+    uint8_t               index;
+    uint8_t               languages;  ///< Languages it is held in: 1, or all of the table's
+    uint32_t              variant[USBDESCBLDR_STRINGS_MAX_LANGS]; ///< Where each language's descriptor is, in the table's descriptors
+  } usbdescbldr_string_entry_t;
+
+  /// The table. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_ctx_t *          ctx;
+    usbdescbldr_string_entry_t * entries;       ///< In index order
+    size_t                       entryCapacity;
+    size_t                       count;         ///< Distinct strings interned
+    size_t                       made;          ///< .. of which this many have been made
+    char *                       pool;
+    size_t                       poolSize;
+    size_t                       poolLength;
+    unsigned int                 base;          ///< The index of the first string
+    size_t                       interned;      ///< Calls to usbdescbldr_strings_intern(), all told
+    unsigned int                 langs;         ///< Languages of usbdescbldr_strings_set_languages(), if any
+    uint16_t                     langID[USBDESCBLDR_STRINGS_MAX_LANGS];
+    uint8_t *                    descriptors;   ///< The localized strings' descriptors
+    size_t                       descriptorsSize;
+    size_t                       descriptorsLength;
+    uint8_t                      slot[USBDESCBLDR_STRINGS_SLOTS]; ///< Each an entry + 1, or 0 if free
+  } usbdescbldr_strings_t;
+
+  /// Set up a string table for a session, after usbdescbldr_make_languageIDs()
+  /// and any strings made directly.
+  ///\param [out] tab The table.
+  ///\param [in] ctx The session; it must last as long as the table.
+  ///\param [in] entries Room for the distinct strings; these hold the items made, and must last as long as the session.
+  ///\param [in] entryCapacity The number of entries.
+  ///\param [in] pool Room for the strings' characters (and a NUL after each).
+  ///\param [in] poolSize The size of the pool.
+  usbdescbldr_status_t
+    usbdescbldr_strings_init(usbdescbldr_strings_t *      tab,
+                             usbdescbldr_ctx_t *          ctx,
+                             usbdescbldr_string_entry_t * entries,
+                             size_t                       entryCapacity,
+                             char *                       pool,
+                             size_t                       poolSize);
+
+  /// Obtain the index of a string, giving it one if it has none yet. The
+  /// string is copied; the caller's need not last.
+  ///\param [in] tab The table.
+  ///\param [in] langID The language of the string (0 where there is just the one).
+  ///\param [in] string The string, in UTF-8.
+  ///\param [out] index The string's index.
+  usbdescbldr_status_t
+    usbdescbldr_strings_intern(usbdescbldr_strings_t * tab,
+                               uint16_t                langID,
+                               const char *            string,
+                               uint8_t *               index);
+
+  /// Give a table the languages of its localized strings: those of string
+  /// zero, in the same order. Call this before the first of them is interned.
+  ///\param [in] tab The table.
+  ///\param [in] langIDs The LANGIDs.
+  ///\param [in] count The number of LANGIDs (USBDESCBLDR_TOO_MANY past USBDESCBLDR_STRINGS_MAX_LANGS).
+  ///\param [in] descriptors Room for the localized strings' descriptors; it must last as long as the table.
+  ///\param [in] descriptorsSize The size of that room.
+  usbdescbldr_status_t
+    usbdescbldr_strings_set_languages(usbdescbldr_strings_t * tab,
+                                      const uint16_t *        langIDs,
+                                      size_t                  count,
+                                      uint8_t *               descriptors,
+                                      size_t                  descriptorsSize);
+
+  /// Obtain the index of a string in each of the table's languages, giving
+  /// it one (and making its descriptors) if it has none yet. The strings
+  /// are copied; the caller's need not last.
+  ///\param [in] tab The table.
+  ///\param [in] strings The string in each language, in UTF-8, in the order of usbdescbldr_strings_set_languages().
+  ///\param [out] index The string's index.
+  usbdescbldr_status_t
+    usbdescbldr_strings_intern_localized(usbdescbldr_strings_t * tab,
+                                         const char * const *    strings,
+                                         uint8_t *               index);
+
+  /// Find the descriptor of a localized string in one of the table's
+  /// languages. Strings held in one language yield USBDESCBLDR_NOT_FOUND;
+  /// theirs is the one the session has.
+  ///\param [in] tab The table.
+  ///\param [in] index The string's index.
+  ///\param [in] lang The language's place among the table's LANGIDs.
+  ///\param [out] data The descriptor.
+  ///\param [out] length Its length.
+  usbdescbldr_status_t
+    usbdescbldr_strings_variant(const usbdescbldr_strings_t * tab,
+                                unsigned int                  index,
+                                unsigned int                  lang,
+                                const uint8_t **              data,
+                                size_t *                      length);
+
+  /// Make the string descriptors for the strings interned since the last
+  /// call, together, in index order. Strings may go on being interned
+  /// after this, and made by a later call. No other string may have been
+  /// made in the meantime (USBDESCBLDR_INVALID), as indices follow the
+  /// order in which strings are made.
+  ///\param [in] tab The table.
+  usbdescbldr_status_t
+    usbdescbldr_strings_make(usbdescbldr_strings_t * tab);
+
+#ifdef __cplusplus
+}
+#endif
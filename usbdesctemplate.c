@@ -0,0 +1,269 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "USBBldr.h"
+#include "usbdesctemplate.h"
+#include "usbdescendian.h"
+#include "usbdescutf8.h"
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// The most characters a string descriptor can hold
+#define USBDESCBLDR_STRING_MAX_CHARS   ((0xff - sizeof(USB_DESCRIPTOR_HEADER)) / sizeof(uint16_t))
+
+
+static usbdescbldr_patch_t *
+_find(const usbdescbldr_template_t *tmpl, const char *name)
+{
+  size_t p;
+
+  for(p = 0; p < tmpl->patchCount; p++) {
+    if(strcmp(tmpl->patches[p].name, name) == 0)
+      return &tmpl->patches[p];
+  }
+
+  return NULL;
+}
+
+
+static usbdescbldr_status_t
+_add(usbdescbldr_template_t *tmpl, const char *name, usbdescbldr_item_t *item,
+     size_t field, size_t width, size_t capacity)
+{
+  usbdescbldr_patch_t *patch;
+
+  if(_find(tmpl, name) != NULL)
+    return USBDESCBLDR_INVALID;
+
+  if(tmpl->patchCount >= tmpl->patchCapacity)
+    return USBDESCBLDR_TOO_MANY;
+
+  patch = &tmpl->patches[tmpl->patchCount++];
+  patch->name = name;
+  patch->item = item;
+  patch->field = (uint8_t) field;
+  patch->width = (uint8_t) width;
+  patch->capacity = (uint8_t) capacity;
+
+  return USBDESCBLDR_OK;
+}
+
+
+static usbdescbldr_status_t
+_set_field(usbdescbldr_ctx_t *ctx, const usbdescbldr_patch_t *patch, uint32_t value)
+{
+  uint8_t *dest = ctx->buffer + patch->item->offset + patch->field;
+
+  if(patch->width < 4 && (value >> (8 * patch->width)) != 0)
+    return USBDESCBLDR_OVERSIZED;
+
+  switch(patch->width) {
+  case 1:
+    *dest = (uint8_t) value;
+    break;
+  case 2:
+    usbdescbldr_put_le16(dest, (uint16_t) value);
+    break;
+  case 3:
+    usbdescbldr_put_le24(dest, value);
+    break;
+  default:
+    usbdescbldr_put_le32(dest, value);
+    break;
+  }
+
+  return USBDESCBLDR_OK;
+}
+
+
+// Rewrite a string slot. A change of length moves everything after it,
+// and every item there.
+static usbdescbldr_status_t
+_set_string(usbdescbldr_ctx_t *ctx, const usbdescbldr_patch_t *patch,
+            const char *string, int *moved)
+{
+  usbdescbldr_item_t * item = patch->item;
+  usbdescbldr_item_t * ip;
+  uint8_t              chars[USBDESCBLDR_STRING_MAX_CHARS * sizeof(uint16_t)];
+  size_t               units, needs, tail, made;
+  uint8_t *            dest;
+  usbdescbldr_status_t rc;
+
+  // Widened once, checking and counting as it goes, to one side: where
+  // it goes depends on how long it turns out to be.
+  rc = usbdescbldr_utf8z_to_utf16le(chars, patch->capacity * sizeof(uint16_t), string, &made);
+  if(rc == USBDESCBLDR_NO_SPACE) {
+    // Over capacity, unless it is malformed further on
+    rc = usbdescbldr_utf8_units(string, strlen(string), &units);
+    return rc != USBDESCBLDR_OK ? rc : USBDESCBLDR_OVERSIZED;
+  }
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  needs = sizeof(USB_DESCRIPTOR_HEADER) + made;
+  if(needs > item->size && needs - item->size > ctx->bufferSize - ctx->length)
+    return USBDESCBLDR_NO_SPACE;
+
+  dest = ctx->buffer + item->offset;
+
+  if(needs != item->size) {
+    tail = item->offset + item->size;
+    memmove(dest + needs, dest + item->size, ctx->length - tail);
+
+    for(ip = ctx->made; ip != NULL; ip = ip->made) {
+      if(ip == item || ip->offset < tail)
+        continue;
+      ip->offset = (uint32_t) (ip->offset + needs - item->size);
+      if(ip->address != NULL)
+        ip->address = ctx->buffer + ip->offset;
+    }
+
+    ctx->length = ctx->length + needs - item->size;
+    ctx->append = ctx->buffer + ctx->length;
+    item->size = (uint16_t) needs;
+    *moved = 1;
+  }
+
+  dest[0] = (uint8_t) needs;
+  dest[1] = USB_DESCRIPTOR_TYPE_STRING;
+  memcpy(dest + sizeof(USB_DESCRIPTOR_HEADER), chars, made);
+  return USBDESCBLDR_OK;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_template_init(usbdescbldr_template_t * tmpl,
+                          usbdescbldr_ctx_t *      ctx,
+                          usbdescbldr_patch_t *    patches,
+                          size_t                   patchCapacity)
+{
+  if(tmpl == NULL || ctx == NULL || (patches == NULL && patchCapacity != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(!ctx->initialized)
+    return USBDESCBLDR_UNINITIALIZED;
+
+  memset(tmpl, 0, sizeof(*tmpl));
+  tmpl->ctx = ctx;
+  tmpl->patches = patches;
+  tmpl->patchCapacity = patchCapacity;
+
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_template_mark(usbdescbldr_template_t * tmpl,
+                          const char *             name,
+                          usbdescbldr_item_t *     item,
+                          size_t                   field,
+                          size_t                   width)
+{
+  if(tmpl == NULL || name == NULL || item == NULL)
+    return USBDESCBLDR_INVALID;
+
+  // The field must lie within a descriptor that has been made
+  if(item->kind == USBDESCBLDR_KIND_NONE || width == 0 || width > 4 ||
+     field > item->size || width > item->size - field)
+    return USBDESCBLDR_INVALID;
+
+  return _add(tmpl, name, item, field, width, 0);
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_template_make_string_slot(usbdescbldr_template_t * tmpl,
+                                      const char *             name,
+                                      usbdescbldr_item_t *     item,
+                                      uint8_t *                index,
+                                      const char *             string,
+                                      size_t                   capacity)
+{
+  usbdescbldr_status_t rc;
+  size_t               chars;
+
+  if(tmpl == NULL || name == NULL || item == NULL || string == NULL)
+    return USBDESCBLDR_INVALID;
+
+  rc = usbdescbldr_utf8z_to_utf16le(NULL, 0, string, &chars);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+  chars /= sizeof(uint16_t);
+  if(capacity > USBDESCBLDR_STRING_MAX_CHARS)
+    return USBDESCBLDR_OVERSIZED;
+  if(chars > capacity)
+    return USBDESCBLDR_INVALID;
+
+  if(_find(tmpl, name) != NULL)
+    return USBDESCBLDR_INVALID;
+  if(tmpl->patchCount >= tmpl->patchCapacity)
+    return USBDESCBLDR_TOO_MANY;
+
+  rc = usbdescbldr_make_string_descriptor(tmpl->ctx, item, index, string);
+  if(rc != USBDESCBLDR_OK)
+    return rc;
+
+  tmpl->slack += (capacity - chars) * sizeof(uint16_t);
+  return _add(tmpl, name, item, 0, 0, capacity);
+}
+
+
+// Fields are written where they lie. Should any string change length,
+// the session is closed once more, at the end, to bring the totals along.
+
+usbdescbldr_status_t
+usbdescbldr_template_specialize(usbdescbldr_template_t *          tmpl,
+                                const usbdescbldr_patch_value_t * values,
+                                size_t                            count)
+{
+  const usbdescbldr_patch_t *patch;
+  usbdescbldr_status_t       rc = USBDESCBLDR_OK, closed;
+  int                        moved = 0;
+  size_t                     v;
+
+  if(tmpl == NULL || tmpl->ctx == NULL || (values == NULL && count != 0))
+    return USBDESCBLDR_INVALID;
+
+  if(tmpl->ctx->buffer == NULL)
+    return USBDESCBLDR_DRY_RUN;
+
+  // Nothing is kept to patch.
+  if((tmpl->ctx->options & USBDESCBLDR_OPTION_FINGERPRINT) || tmpl->ctx->window != NULL ||
+     tmpl->ctx->segments != NULL)
+    return USBDESCBLDR_INVALID;
+
+  for(v = 0; v < count && rc == USBDESCBLDR_OK; v++) {
+    if(values[v].name == NULL || (patch = _find(tmpl, values[v].name)) == NULL) {
+      rc = USBDESCBLDR_NOT_FOUND;
+    } else if(patch->width == 0) {
+      rc = values[v].string != NULL ? _set_string(tmpl->ctx, patch, values[v].string, &moved)
+                                    : USBDESCBLDR_INVALID;
+    } else {
+      rc = values[v].string == NULL ? _set_field(tmpl->ctx, patch, values[v].value)
+                                    : USBDESCBLDR_INVALID;
+    }
+  }
+
+  if(moved) {
+    closed = usbdescbldr_close(tmpl->ctx);
+    if(rc == USBDESCBLDR_OK)
+      rc = closed;
+  }
+
+  return rc;
+}
@@ -0,0 +1,122 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // Templates
+  //
+  // Most run-time changes touch only a few fields: idProduct, a serial
+  // number, frame sizes that depend on the sensor, bMaxPower. A template
+  // is a session built once, as a skeleton, with named patch points
+  // recorded as the maker calls are made. Specializing it rewrites just
+  // those bytes, in place; the makers are not run again.
+  //
+  // Patch points are fields of 1 to 4 bytes, or string slots. A string
+  // slot may be given a string of any length up to the capacity it was
+  // made with; the descriptors after it move to suit (into slack left at
+  // the end of the buffer, see usbdescbldr_template_t.slack), and the
+  // session is closed again, so that every wTotalLength agrees.
+  //
+  // The template works on the session (and its items) in place; both must
+  // last as long as it does. Anything which has recorded offsets into the
+  // buffer (a responder, an index) should be prepared again after a string
+  // changes length.
+
+  /// A named patch point. Callers should treat this as 'read only'.
+  typedef struct {
+    const char *          name;       ///< The caller's; it must last as long as the template
+    usbdescbldr_item_t *  item;       ///< The descriptor holding the field
+    uint8_t               field;      ///< Byte offset of the field within the descriptor
+    uint8_t               width;      ///< Bytes in the field; 0 for a string slot
+    uint8_t               capacity;   ///< Characters a string slot may hold
+  } usbdescbldr_patch_t;
+
+  /// The template. Callers should treat this as 'read only'.
+  typedef struct {
+    usbdescbldr_ctx_t *   ctx;
+    usbdescbldr_patch_t * patches;
+    size_t                patchCapacity;
+    size_t                patchCount;
+    size_t                slack;      ///< Bytes the string slots may grow by, together
+  } usbdescbldr_template_t;
+
+  /// One value for usbdescbldr_template_specialize().
+  typedef struct {
+    const char *          name;
+    uint32_t              value;      ///< For a field
+    const char *          string;     ///< For a string slot (and then value is unused)
+  } usbdescbldr_patch_value_t;
+
+  /// Begin a template over a session. Call this after usbdescbldr_init(),
+  /// before the maker calls. For a session sized by a dry run, make the
+  /// dry run with a template too, and add its slack to the size.
+  ///\param [out] tmpl The template.
+  ///\param [in] ctx The session.
+  ///\param [in] patches Storage for patch points.
+  ///\param [in] patchCapacity The number of patch points there is storage for.
+  usbdescbldr_status_t
+    usbdescbldr_template_init(usbdescbldr_template_t * tmpl,
+                              usbdescbldr_ctx_t *      ctx,
+                              usbdescbldr_patch_t *    patches,
+                              size_t                   patchCapacity);
+
+  /// Name a field of a descriptor just made, as a patch point.
+  ///\param [in] tmpl The template.
+  ///\param [in] name The patch point's name.
+  ///\param [in] item The item the field belongs to.
+  ///\param [in] field Byte offset of the field within the descriptor (offsetof()).
+  ///\param [in] width Bytes in the field: 1 to 4, stored little-endian.
+  usbdescbldr_status_t
+    usbdescbldr_template_mark(usbdescbldr_template_t * tmpl,
+                              const char *             name,
+                              usbdescbldr_item_t *     item,
+                              size_t                   field,
+                              size_t                   width);
+
+  /// Make a string descriptor as a named string slot, able to hold up to
+  /// capacity characters when specialized. Characters are counted as
+  /// UTF-16 code units: one past U+FFFF counts twice.
+  ///\param [in] tmpl The template.
+  ///\param [in] name The patch point's name.
+  ///\param [in] item The item to receive the result.
+  ///\param [out] index The string index assigned (optional).
+  ///\param [in] string The string to begin with.
+  ///\param [in] capacity The most characters the slot may hold.
+  usbdescbldr_status_t
+    usbdescbldr_template_make_string_slot(usbdescbldr_template_t * tmpl,
+                                          const char *             name,
+                                          usbdescbldr_item_t *     item,
+                                          uint8_t *                index,
+                                          const char *             string,
+                                          size_t                   capacity);
+
+  /// Rewrite patch points in the (closed) session's buffer. Values are
+  /// applied in order; should one fail, those before it remain applied.
+  ///\param [in] tmpl The template.
+  ///\param [in] values The values, by patch point name.
+  ///\param [in] count The number of values.
+  usbdescbldr_status_t
+    usbdescbldr_template_specialize(usbdescbldr_template_t *          tmpl,
+                                    const usbdescbldr_patch_value_t * values,
+                                    size_t                            count);
+
+#ifdef __cplusplus
+}
+#endif
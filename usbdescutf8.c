@@ -0,0 +1,330 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#include <string.h>
+
+#include "usbdescutf8.h"
+#include "usbdescendian.h"
+
+#if !defined(USBDESCBLDR_NO_SIMD)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define USBDESCBLDR_UTF8_SSE2
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define USBDESCBLDR_UTF8_NEON
+#  endif
+#endif
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// Internals
+
+// How many bytes at the start of a string are ASCII.
+static size_t
+_ascii_run(const uint8_t *s, size_t length)
+{
+  size_t   n = 0;
+  uint64_t word;
+
+#if defined(USBDESCBLDR_UTF8_SSE2)
+  for(; n + 16 <= length; n += 16) {
+    if(_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (s + n))) != 0)
+      break;
+  }
+
+  // The last few, as the block that ends the string (some already seen)
+  if(n + 16 > length && length >= 16 &&
+     _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (s + length - 16))) == 0)
+    return length;
+#elif defined(USBDESCBLDR_UTF8_NEON)
+  uint8x16_t v;
+
+  for(; n + 16 <= length; n += 16) {
+    v = vld1q_u8(s + n);
+    if((vget_lane_u64(vreinterpret_u64_u8(vorr_u8(vget_low_u8(v), vget_high_u8(v))), 0) &
+        0x8080808080808080ULL) != 0)
+      break;
+  }
+
+  // The last few, as the block that ends the string (some already seen)
+  if(n + 16 > length && length >= 16) {
+    v = vld1q_u8(s + length - 16);
+    if((vget_lane_u64(vreinterpret_u64_u8(vorr_u8(vget_low_u8(v), vget_high_u8(v))), 0) &
+        0x8080808080808080ULL) == 0)
+      return length;
+  }
+#endif
+
+  // .. 8 at a time, without SIMD (or for what it left)
+  for(; n + 8 <= length; n += 8) {
+    memcpy(&word, s + n, sizeof(word));
+    if((word & 0x8080808080808080ULL) != 0)
+      break;
+  }
+
+  // The last few, as the word that ends the string (some already seen)
+  if(n + 8 > length && length >= 8) {
+    memcpy(&word, s + length - 8, sizeof(word));
+    if((word & 0x8080808080808080ULL) == 0)
+      return length;
+  }
+
+  while(n < length && s[n] < 0x80)
+    n++;
+
+  return n;
+}
+
+
+// Widen the ASCII at the start of a string to UTF-16LE, each byte then a
+// zero, checking and putting each block in one go; at most n bytes are
+// read. The number widened.
+static size_t
+_ascii_widen(uint8_t *dest, const uint8_t *s, size_t n)
+{
+  size_t   c = 0, k;
+  uint64_t word;
+
+#if defined(USBDESCBLDR_UTF8_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i       v;
+
+  for(; c + 16 <= n; c += 16) {
+    v = _mm_loadu_si128((const __m128i *) (s + c));
+    if(_mm_movemask_epi8(v) != 0)
+      break;
+    _mm_storeu_si128((__m128i *) (dest + 2 * c), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128((__m128i *) (dest + 2 * c + 16), _mm_unpackhi_epi8(v, zero));
+  }
+
+  // The last few, as the block that ends the string (some already put)
+  if(c + 16 > n && n >= 16) {
+    v = _mm_loadu_si128((const __m128i *) (s + n - 16));
+    if(_mm_movemask_epi8(v) == 0) {
+      _mm_storeu_si128((__m128i *) (dest + 2 * n - 32), _mm_unpacklo_epi8(v, zero));
+      _mm_storeu_si128((__m128i *) (dest + 2 * n - 16), _mm_unpackhi_epi8(v, zero));
+      return n;
+    }
+  }
+#elif defined(USBDESCBLDR_UTF8_NEON)
+  uint8x16x2_t pair;
+
+  pair.val[1] = vdupq_n_u8(0);
+  for(; c + 16 <= n; c += 16) {
+    pair.val[0] = vld1q_u8(s + c);
+    if((vget_lane_u64(vreinterpret_u64_u8(vorr_u8(vget_low_u8(pair.val[0]), vget_high_u8(pair.val[0]))), 0) &
+        0x8080808080808080ULL) != 0)
+      break;
+    vst2q_u8(dest + 2 * c, pair);
+  }
+
+  // The last few, as the block that ends the string (some already put)
+  if(c + 16 > n && n >= 16) {
+    pair.val[0] = vld1q_u8(s + n - 16);
+    if((vget_lane_u64(vreinterpret_u64_u8(vorr_u8(vget_low_u8(pair.val[0]), vget_high_u8(pair.val[0]))), 0) &
+        0x8080808080808080ULL) == 0) {
+      vst2q_u8(dest + 2 * n - 32, pair);
+      return n;
+    }
+  }
+#endif
+
+  // .. 8 at a time, without SIMD (or for what it left)
+  for(; c + 8 <= n; c += 8) {
+    memcpy(&word, s + c, sizeof(word));
+    if((word & 0x8080808080808080ULL) != 0)
+      break;
+    for(k = c; k < c + 8; k++) {
+      dest[2 * k] = s[k];
+      dest[2 * k + 1] = 0;
+    }
+  }
+
+  // The last few, as the word that ends the string (some already put)
+  if(c + 8 > n && n >= 8) {
+    memcpy(&word, s + n - 8, sizeof(word));
+    if((word & 0x8080808080808080ULL) == 0) {
+      for(k = n - 8; k < n; k++) {
+        dest[2 * k] = s[k];
+        dest[2 * k + 1] = 0;
+      }
+      return n;
+    }
+  }
+
+  for(; c < n && s[c] < 0x80; c++) {
+    dest[2 * c] = s[c];
+    dest[2 * c + 1] = 0;
+  }
+
+  return c;
+}
+
+
+// Decode the (non-ASCII) character at the start of a string: the number
+// of bytes it takes, or 0 if it is malformed.
+static size_t
+_decode(const uint8_t *s, size_t length, uint32_t *cp)
+{
+  uint32_t c = s[0], least;
+  size_t   n, i;
+
+  if((c & 0xe0) == 0xc0) {
+    n = 2; c &= 0x1f; least = 0x80;
+  } else if((c & 0xf0) == 0xe0) {
+    n = 3; c &= 0x0f; least = 0x800;
+  } else if((c & 0xf8) == 0xf0) {
+    n = 4; c &= 0x07; least = 0x10000;
+  } else {
+    return 0;
+  }
+
+  if(n > length)
+    return 0;
+
+  for(i = 1; i < n; i++) {
+    if((s[i] & 0xc0) != 0x80)
+      return 0;
+    c = (c << 6) | (s[i] & 0x3f);
+  }
+
+  // Overlong, past Unicode, or a surrogate
+  if(c < least || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+    return 0;
+
+  *cp = c;
+  return n;
+}
+
+
+// The UTF-16 code units a code point takes.
+static size_t
+_units(uint32_t cp)
+{
+  return cp > 0xffff ? 2 : 1;
+}
+
+
+// Put a code point as UTF-16LE (a surrogate pair past U+FFFF): the bytes put.
+static size_t
+_put(uint8_t *dest, uint32_t cp)
+{
+  if(cp <= 0xffff) {
+    usbdescbldr_put_le16(dest, (uint16_t) cp);
+    return 2;
+  }
+
+  cp -= 0x10000;
+  usbdescbldr_put_le16(dest, (uint16_t) (0xd800 + (cp >> 10)));
+  usbdescbldr_put_le16(dest + 2, (uint16_t) (0xdc00 + (cp & 0x3ff)));
+  return 4;
+}
+
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// API
+
+usbdescbldr_status_t
+usbdescbldr_utf8_units(const char * utf8,
+                       size_t       length,
+                       size_t *     units)
+{
+  const uint8_t *s = (const uint8_t *) utf8;
+  size_t         at = 0, count = 0, run, n;
+  uint32_t       cp;
+
+  if((utf8 == NULL && length != 0) || units == NULL)
+    return USBDESCBLDR_INVALID;
+
+  for(;;) {
+    run = _ascii_run(s + at, length - at);
+    at += run;
+    count += run;
+    if(at == length)
+      break;
+
+    n = _decode(s + at, length - at, &cp);
+    if(n == 0)
+      return USBDESCBLDR_INVALID;
+    at += n;
+    count += _units(cp);
+  }
+
+  *units = count;
+  return USBDESCBLDR_OK;
+}
+
+
+usbdescbldr_status_t
+usbdescbldr_utf8_to_utf16le(uint8_t *    dest,
+                            size_t       destSize,
+                            const char * utf8,
+                            size_t       length,
+                            size_t *     made)
+{
+  const uint8_t *s = (const uint8_t *) utf8;
+  size_t         at = 0, put = 0, run, n;
+  uint32_t       cp;
+
+  if((dest == NULL && destSize != 0) || (utf8 == NULL && length != 0) || made == NULL)
+    return USBDESCBLDR_INVALID;
+
+  for(;;) {
+    // As much ASCII as there is room for; any more is out of room
+    run = (destSize - put) / 2;
+    run = _ascii_widen(dest + put, s + at, run < length - at ? run : length - at);
+    at += run;
+    put += 2 * run;
+    if(at == length)
+      break;
+    if(s[at] < 0x80)
+      return USBDESCBLDR_NO_SPACE;
+
+    n = _decode(s + at, length - at, &cp);
+    if(n == 0)
+      return USBDESCBLDR_INVALID;
+    at += n;
+
+    if(destSize - put < _units(cp) * sizeof(uint16_t))
+      return USBDESCBLDR_NO_SPACE;
+    put += _put(dest + put, cp);
+  }
+
+  *made = put;
+  return USBDESCBLDR_OK;
+}
+
+
+// The length first, so that nothing past the NUL is read; then one pass,
+// in which each run of ASCII is widened as it is checked.
+
+usbdescbldr_status_t
+usbdescbldr_utf8z_to_utf16le(uint8_t *    dest,
+                             size_t       destSize,
+                             const char * utf8,
+                             size_t *     made)
+{
+  usbdescbldr_status_t rc;
+  size_t               length, units;
+
+  if(utf8 == NULL || made == NULL)
+    return USBDESCBLDR_INVALID;
+
+  length = strlen(utf8);
+  if(dest != NULL)
+    return usbdescbldr_utf8_to_utf16le(dest, destSize, utf8, length, made);
+
+  rc = usbdescbldr_utf8_units(utf8, length, &units);
+  if(rc == USBDESCBLDR_OK)
+    *made = units * sizeof(uint16_t);
+  return rc;
+}
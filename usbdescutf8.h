@@ -0,0 +1,76 @@
+/* Copyright (c) 2014 LEAP Motion. All rights reserved.
+ *
+ * The intellectual and technical concepts contained herein are proprietary and
+ * confidential to Leap Motion, and are protected by trade secret or copyright
+ * law. Dissemination of this information or reproduction of this material is
+ * strictly forbidden unless prior written permission is obtained from LEAP
+ * Motion.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usbdescbuilder.h"
+
+  // //////////////////////////////////////////////////////////////////
+  // //////////////////////////////////////////////////////////////////
+  // UTF-8
+  //
+  // String descriptors hold UTF-16LE; strings are passed to the builder
+  // in UTF-8. Characters past U+FFFF become surrogate pairs, and so take
+  // two code units. Malformed UTF-8 (overlong forms, encoded surrogates,
+  // code points past U+10FFFF, stray or missing continuation bytes) is
+  // refused with USBDESCBLDR_INVALID.
+  //
+  // Most strings are plain ASCII, which is checked and widened 16 bytes at
+  // a time with SSE2 or NEON, where the compiler targets either. Define
+  // USBDESCBLDR_NO_SIMD (CMake option of the same name) to do without.
+
+  /// Count the UTF-16 code units a UTF-8 string encodes to, checking that
+  /// it is well formed.
+  ///\param [in] utf8 The string.
+  ///\param [in] length Its length in bytes.
+  ///\param [out] units The number of code units.
+  usbdescbldr_status_t
+    usbdescbldr_utf8_units(const char * utf8,
+                           size_t       length,
+                           size_t *     units);
+
+  /// Encode a UTF-8 string as UTF-16LE, checking it as it goes. Nothing
+  /// is read past length, nor written past destSize; when dest is short,
+  /// what fits of the string may have been put in it.
+  ///\param [out] dest Where to put the code units.
+  ///\param [in] destSize Its size in bytes (USBDESCBLDR_NO_SPACE if short).
+  ///\param [in] utf8 The string.
+  ///\param [in] length Its length in bytes.
+  ///\param [out] made The number of bytes put in dest.
+  usbdescbldr_status_t
+    usbdescbldr_utf8_to_utf16le(uint8_t *    dest,
+                                size_t       destSize,
+                                const char * utf8,
+                                size_t       length,
+                                size_t *     made);
+
+  /// Encode a NUL-terminated UTF-8 string as UTF-16LE: strlen(), then
+  /// usbdescbldr_utf8_to_utf16le(), which checks and counts the string as
+  /// it encodes it (where usbdescbldr_utf8_units() would take a pass of
+  /// its own). Nothing past the NUL is read.
+  ///\param [out] dest Where to put the code units; NULL to only count (and check) them.
+  ///\param [in] destSize Its size in bytes (USBDESCBLDR_NO_SPACE if short).
+  ///\param [in] utf8 The string.
+  ///\param [out] made The number of bytes put in dest (or that would be).
+  usbdescbldr_status_t
+    usbdescbldr_utf8z_to_utf16le(uint8_t *    dest,
+                                 size_t       destSize,
+                                 const char * utf8,
+                                 size_t *     made);
+
+#ifdef __cplusplus
+}
+#endif